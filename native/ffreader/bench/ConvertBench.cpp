@@ -0,0 +1,120 @@
+/**
+ * Microbenchmark for the YUV to RGBA kernels in src/YuvToRgba.cpp against
+ * the single-threaded swscale conversion they replace. Build and run with
+ * scripts/bench-convert.sh.
+ */
+#include "../src/YuvToRgba.hpp"
+
+extern "C"
+{
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+static AVFrame *makeFrame(AVPixelFormat format, int width, int height)
+{
+  AVFrame *frame = av_frame_alloc();
+  frame->format = format;
+  frame->width = width;
+  frame->height = height;
+  if (av_frame_get_buffer(frame, 64) < 0)
+  {
+    av_frame_free(&frame);
+    return nullptr;
+  }
+  // Smooth gradients with some noise so neither path sees constant input.
+  uint32_t seed = 1;
+  for (int plane = 0; plane < 3 && frame->data[plane]; plane++)
+  {
+    const int rows = plane == 0 || format == AV_PIX_FMT_YUV422P ||
+                             format == AV_PIX_FMT_YUVJ422P
+                         ? height
+                         : height / 2;
+    for (int row = 0; row < rows; row++)
+    {
+      uint8_t *line = frame->data[plane] + (size_t)row * frame->linesize[plane];
+      for (int col = 0; col < frame->linesize[plane]; col++)
+      {
+        seed = seed * 1664525 + 1013904223;
+        line[col] = (uint8_t)((row + col * 3 + (seed >> 28)) & 0xff);
+      }
+    }
+  }
+  return frame;
+}
+
+template <typename Fn>
+static double millisPerFrame(int iterations, Fn fn)
+{
+  fn(); // warm caches and lazily created contexts
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+  {
+    fn();
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+static void run(AVPixelFormat format, int width, int height, int iterations)
+{
+  AVFrame *frame = makeFrame(format, width, height);
+  if (!frame)
+  {
+    std::fprintf(stderr, "Could not allocate %dx%d frame\n", width, height);
+    return;
+  }
+  const int stride = width * 4;
+  std::vector<uint8_t> simd((size_t)stride * height);
+  std::vector<uint8_t> sws((size_t)stride * height);
+
+  SwsContext *context =
+      sws_getContext(width, height, format, width, height, AV_PIX_FMT_RGBA,
+                     SWS_BILINEAR, nullptr, nullptr, nullptr);
+  uint8_t *swsPlanes[4] = {sws.data(), nullptr, nullptr, nullptr};
+  int swsStrides[4] = {stride, 0, 0, 0};
+
+  const double kernelMs = millisPerFrame(iterations, [&]()
+                                         { yuvToRGBA(frame, 0, 0, width, height,
+                                                     simd.data(), stride); });
+  const double swsMs = millisPerFrame(iterations, [&]()
+                                      { sws_scale(context, frame->data, frame->linesize,
+                                                  0, height, swsPlanes, swsStrides); });
+
+  int maxDiff = 0;
+  for (size_t i = 0; i < simd.size(); i++)
+  {
+    maxDiff = std::max(maxDiff, std::abs(simd[i] - sws[i]));
+  }
+
+  std::printf("%-10s %4dx%-4d  %-6s %7.2f ms   swscale %7.2f ms   %5.2fx   max diff %d\n",
+              av_get_pix_fmt_name(format), width, height, yuvToRGBAKernelName(),
+              kernelMs, swsMs, swsMs / kernelMs, maxDiff);
+
+  sws_freeContext(context);
+  av_frame_free(&frame);
+}
+
+int main(int argc, char **argv)
+{
+  const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+  const AVPixelFormat formats[] = {AV_PIX_FMT_YUV420P, AV_PIX_FMT_YUVJ420P,
+                                   AV_PIX_FMT_NV12, AV_PIX_FMT_YUVJ422P};
+  const int sizes[][2] = {{1920, 1080}, {3840, 2160}};
+  for (const auto &size : sizes)
+  {
+    for (const auto format : formats)
+    {
+      run(format, size[0], size[1], iterations);
+    }
+  }
+  return 0;
+}
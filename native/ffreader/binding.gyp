@@ -2,7 +2,7 @@
   "targets": [
     {
       "target_name": "crewtimer_video_reader",
-      "sources": [ "src/FFReaderAPI.cpp", "src/FFReader.cpp", "src/sendMulticast.cpp", "src/FrameUtils.cpp"],
+      "sources": [ "src/FFReaderAPI.cpp", "src/FFReader.cpp", "src/FrameConverter.cpp", "src/YuvToRgba.cpp", "src/FrameStore.cpp", "src/ScrubDecoder.cpp", "src/ThumbnailAtlas.cpp", "src/TimestampTable.cpp", "src/VideoIndex.cpp", "src/VideoTimeline.cpp", "src/VideoIndexCache.cpp", "src/MappedFile.cpp", "src/FileSource.cpp", "src/ReaderPool.cpp", "src/RangeDecoder.cpp", "src/sendMulticast.cpp", "src/FrameUtils.cpp", "src/WorkerPool.cpp"],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
       ],
@@ -10,12 +10,30 @@ declare module 'crewtimer_video_reader' {
   interface OpenFileMessage extends MessageBase {
     op: 'openFile';
     file: string;
+    /**
+     * Read the file extent from the frame index instead of decoding the
+     * last frames. Frame 1 is only decoded when the UTC anchor comes from
+     * its pixels.
+     */
+    fast?: boolean;
+    /**
+     * How the file is read: FFmpeg's own file access (default), large reads
+     * with access hints, or a memory mapping.
+     */
+    io?: 'default' | 'readahead' | 'mmap';
+    /** Size of each read with io 'readahead', default 4. */
+    readAheadMB?: number;
   }
 
   interface GrabFrameMessage extends MessageBase {
     op: 'grabFrameAt';
     frameNum: number;
     file: string;
+    /**
+     * Id of an open timeline. frameNum and tsMilli then span all of its
+     * segments and file is ignored; see GrabFrameMessageResponse.timelineFirstFrame.
+     */
+    timeline?: string;
     zoom?: { x: number; y: number; width: number; height: number };
     blend?: boolean;
     saveAs?: string; // optional filename in which to save a png image of the frame
@@ -26,6 +44,144 @@ declare module 'crewtimer_video_reader' {
     prune?: { side: 'top' | 'bottom'; percentage: number };
     /** RIFE-only: path to the rife_v4.6.onnx model file. */
     modelFile?: string;
+    /**
+     * Region of the frame to return, in source pixels. When set, only this
+     * region is converted and prune is ignored.
+     */
+    sourceRect?: { x: number; y: number; width: number; height: number };
+    /** Size to scale sourceRect to. Defaults to the sourceRect size. */
+    outputSize?: { width: number; height: number };
+    /**
+     * Pixel layout of the returned data. Defaults to 'rgba'. Planar output
+     * is only produced for decoded full frames without saveAs; otherwise
+     * the response falls back to 'rgba', so check the response format.
+     */
+    outputFormat?: 'rgba' | 'i420' | 'nv12';
+    /**
+     * Return the keyframe at or before frameNum from a separate keyframe-only
+     * decoder, for fast previews while dragging. The response frameNum is the
+     * keyframe's. Other options except maxWidth are ignored.
+     */
+    scrub?: boolean;
+    /** Scrub-only: scale the preview down to at most this width. */
+    maxWidth?: number;
+    /**
+     * nativeVideoExecutorAsync only: a newer request with the same view
+     * replaces this one, which then rejects with 'Superseded'.
+     */
+    view?: string;
+  }
+
+  /**
+   * Fetches the frame at one UTC time from several open files, e.g. the
+   * cameras of a finish line, decoding each file on its own thread.
+   */
+  interface GrabFramesAtTimeMessage extends MessageBase {
+    op: 'grabFramesAtTime';
+    files: string[];
+    tsMilli: number;
+    /**
+     * 'nearest' (default) returns the frame closest to tsMilli; 'bracket'
+     * returns the frame at or before it with the following frame in next.
+     */
+    mode?: 'nearest' | 'bracket';
+  }
+
+  /** One plane of planar grabFrameAt output, located within data. */
+  interface FramePlane {
+    offset: number;
+    stride: number;
+    /** Samples per row; for NV12's UV plane, U/V pairs per row. */
+    width: number;
+    height: number;
+  }
+
+  interface ConfigureReaderMessage extends MessageBase {
+    op: 'configureReader';
+    file: string;
+    /** Decode ahead in the direction of recent frame requests. */
+    prefetch?: boolean;
+    /** Memory the prefetch worker may use for decoded frames. Defaults to 64. */
+    prefetchMB?: number;
+    /**
+     * Memory for the GOP-reverse buffer used when stepping or playing
+     * backward. Defaults to 256; should hold about two GOPs.
+     */
+    reverseMB?: number;
+    /** Memory for recently decoded frames. Defaults to 256. */
+    frameStoreMB?: number;
+    /** Seconds of video the decoded-frame store aims to hold. Defaults to 1. */
+    historySec?: number;
+    /**
+     * Decoders kept per file, each parked at the position it last read, so
+     * flipping between distant frames stays cheap. Includes the file's own
+     * reader; 1, the default, disables. Cursors share the file's prefetch
+     * settings.
+     */
+    cursors?: number;
+    /** Memory for the decoded-frame store of each extra cursor. Defaults to 64. */
+    cursorFrameStoreMB?: number;
+  }
+
+  /** Throws 'File busy' while an async request is using the file. */
+  interface ReaderStatsMessage extends MessageBase {
+    op: 'readerStats';
+    file: string;
+  }
+
+  /**
+   * Filmstrip thumbnails packed into one RGBA atlas. The first call for a
+   * file starts a background keyframe-only build and returns
+   * state 'building'; poll until 'ready'. The atlas is stored next to the
+   * video as a .ctthumb file and mapped on later opens.
+   */
+  interface GetThumbnailsMessage extends MessageBase {
+    op: 'getThumbnails';
+    file: string;
+    /** Number of evenly spaced thumbnails. Defaults to 100. */
+    count?: number;
+    /** Width of each thumbnail in pixels. Defaults to 160. */
+    width?: number;
+  }
+
+  /**
+   * Joins consecutive segment files into one frame and UTC space. Segments
+   * are opened on demand by grabFrameAt requests with this timeline; near a
+   * boundary the neighbouring segment is opened and the frame across it
+   * decoded ahead. Opening an existing id replaces its segments.
+   */
+  interface OpenTimelineMessage extends MessageBase {
+    op: 'openTimeline';
+    timeline: string;
+    /** Segment files in playback order. */
+    files: string[];
+    /** Frames from a boundary at which the neighbour is opened. Defaults to 30. */
+    preloadFrames?: number;
+    /** Prefetch budget for segments the timeline opens; 0 disables. Defaults to 64. */
+    prefetchMB?: number;
+  }
+
+  /** Closes a timeline and the segment files it opened. */
+  interface CloseTimelineMessage extends MessageBase {
+    op: 'closeTimeline';
+    timeline: string;
+  }
+
+  /**
+   * Indexes frames appended to an open file that is still being written
+   * and returns the new extent.
+   */
+  interface RefreshFileMessage extends MessageBase {
+    op: 'refreshFile';
+    file: string;
+  }
+
+  /** Opens and probes many files at once, without keeping them open. */
+  interface ProbeFilesMessage extends MessageBase {
+    op: 'probeFiles';
+    files: string[];
+    /** Files opened at the same time. Defaults to 4. */
+    concurrency?: number;
   }
 
   interface CloseFileMessage extends MessageBase {
@@ -87,6 +243,139 @@ declare module 'crewtimer_video_reader' {
     fileStartTime: number;
     fileEndTime: number;
     motion: { x: number; y: number; dt: number; valid: boolean };
+    /** Region actually returned, clipped to the frame, when sourceRect was requested. */
+    sourceRect?: { x: number; y: number; width: number; height: number };
+    /** Full frame size when sourceRect was requested. */
+    frameWidth?: number;
+    frameHeight?: number;
+    /** Layout of data: packed RGBA, or Y, U, V (i420) / Y, UV (nv12) planes. */
+    format: 'rgba' | 'i420' | 'nv12';
+    /** Planar formats only. */
+    planes?: FramePlane[];
+    colorMatrix?: 'bt601' | 'bt709';
+    colorRange?: 'limited' | 'full';
+    /**
+     * Timeline requests only: timeline frame of the serving segment's frame
+     * 1, so the timeline frame is frameNum + timelineFirstFrame - 1.
+     */
+    timelineFirstFrame?: number;
+    timelineNumFrames?: number;
+  }
+
+  /** A file of grabFramesAtTime; status is 'OK' or why it has no frame. */
+  interface TimeFrameResult extends Partial<GrabFrameMessageResponse> {
+    status: string;
+    file: string;
+    /** Bracket mode: the frame after this one. */
+    next?: Partial<GrabFrameMessageResponse>;
+    /** Bracket mode: position of tsMilli between this frame (0) and next (1). */
+    fraction?: number;
+  }
+
+  interface GrabFramesAtTimeMessageResponse extends MessageResponseBase {
+    /** In the order of the requested files. */
+    frames: TimeFrameResult[];
+  }
+
+  interface OpenFileMessageResponse extends MessageResponseBase {
+    /** Last readable frame number (1-based). */
+    numFrames: number;
+    /** UTC ms of the first and last frames. */
+    firstTimestamp: number;
+    lastTimestamp: number;
+    /** UTC us of the first and last frames, 0 if unknown. */
+    firstTsMicro: number;
+    lastTsMicro: number;
+  }
+
+  interface TimelineSegmentInfo {
+    file: string;
+    /** Timeline frame number of the segment's frame 1. */
+    firstFrame: number;
+    numFrames: number;
+    firstTimestamp: number;
+    lastTimestamp: number;
+  }
+
+  interface OpenTimelineMessageResponse extends OpenFileMessageResponse {
+    segments: TimelineSegmentInfo[];
+  }
+
+  interface RefreshFileMessageResponse extends OpenFileMessageResponse {
+    /** True when new frames were found. */
+    grown: boolean;
+    /**
+     * Synchronous calls only: true when an async request was using the file,
+     * so the extent was returned unchanged. Poll again later.
+     */
+    busy: boolean;
+  }
+
+  interface FileProbeResult {
+    file: string;
+    /** 'OK' or the reason the file could not be probed. */
+    status: string;
+    fps?: number;
+    width?: number;
+    height?: number;
+    /** False when the extent is estimated because the file has no frame index. */
+    exact?: boolean;
+    numFrames?: number;
+    firstTimestamp?: number;
+    lastTimestamp?: number;
+    firstTsMicro?: number;
+    lastTsMicro?: number;
+  }
+
+  interface ProbeFilesMessageResponse extends MessageResponseBase {
+    /** One result per requested file, in request order. */
+    files: FileProbeResult[];
+  }
+
+  interface ReaderStatsMessageResponse extends MessageResponseBase {
+    /** Frames held in the decoded-frame store. */
+    frames: number;
+    bytes: number;
+    budgetBytes: number;
+    maxFrames: number;
+    hits: number;
+    misses: number;
+    evictions: number;
+    /** Frames held in the GOP-reverse buffer. */
+    reverseFrames: number;
+    /**
+     * Frames in the timestamp table used for tsMilli lookups; 0 until its
+     * background pass has finished.
+     */
+    timestampFrames: number;
+    /** I/O layer of the file, see OpenFileMessage.io. */
+    ioMode: 'default' | 'readahead' | 'mmap';
+    /** Bytes, reads and seeks since open; 0 with ioMode 'default'. */
+    ioBytes: number;
+    ioReads: number;
+    ioSeeks: number;
+    /** Decoders open for the file, including its own reader. */
+    cursors: number;
+    /** Every frame is a keyframe; frames are read directly from their packets. */
+    intraOnly: boolean;
+  }
+
+  interface GetThumbnailsMessageResponse extends MessageResponseBase {
+    state: 'building' | 'ready' | 'failed';
+    count: number;
+    /** Thumbnails decoded so far. */
+    progress: number;
+    /** The rest are only set when state is 'ready'. RGBA atlas pixels. */
+    data?: Buffer;
+    width?: number;
+    height?: number;
+    thumbWidth?: number;
+    thumbHeight?: number;
+    /** Thumbnail i is at column i % columns, row i / columns. */
+    columns?: number;
+    rows?: number;
+    /** The keyframe shown by each thumbnail, 0 if it failed to decode. */
+    frameNumbers?: number[];
   }
 
   interface DetectBowMessageResponse extends MessageResponseBase {
@@ -100,10 +389,15 @@ declare module 'crewtimer_video_reader' {
     timestamp: number;
   }
 
+  export function nativeVideoExecutor(
+    message: OpenFileMessage,
+  ): OpenFileMessageResponse;
+
   export function nativeVideoExecutor(
     message:
-      | OpenFileMessage
       | CloseFileMessage
+      | CloseTimelineMessage
+      | ConfigureReaderMessage
       | SendMulticastMessage
       | DebugMessage,
   ): MessageResponseBase;
@@ -112,7 +406,75 @@ declare module 'crewtimer_video_reader' {
     message: GrabFrameMessage,
   ): GrabFrameMessageResponse;
 
+  export function nativeVideoExecutor(
+    message: GrabFramesAtTimeMessage,
+  ): GrabFramesAtTimeMessageResponse;
+
   export function nativeVideoExecutor(
     message: DetectBowMessage,
   ): DetectBowMessageResponse;
+
+  export function nativeVideoExecutor(
+    message: ReaderStatsMessage,
+  ): ReaderStatsMessageResponse;
+
+  export function nativeVideoExecutor(
+    message: GetThumbnailsMessage,
+  ): GetThumbnailsMessageResponse;
+
+  export function nativeVideoExecutor(
+    message: ProbeFilesMessage,
+  ): ProbeFilesMessageResponse;
+
+  export function nativeVideoExecutor(
+    message: RefreshFileMessage,
+  ): RefreshFileMessageResponse;
+
+  export function nativeVideoExecutor(
+    message: OpenTimelineMessage,
+  ): OpenTimelineMessageResponse;
+
+  /**
+   * Like nativeVideoExecutor, but returns a Promise. openFile, grabFrameAt,
+   * detectBowAtFrame, refreshFile, configureReader, probeFiles,
+   * openTimeline and grabFramesAtTime run on a worker thread: requests for
+   * one file run in order, requests for different files run concurrently.
+   * An async grabFramesAtTime waits for requests on its files rather than
+   * reporting them busy. Errors reject the Promise. Other ops run
+   * synchronously and settle at once.
+   *
+   * Synchronous configureReader, readerStats and grabFramesAtTime never wait
+   * for an async request on the same file; they report 'File busy' instead.
+   */
+  export function nativeVideoExecutorAsync(
+    message: OpenFileMessage,
+  ): Promise<OpenFileMessageResponse>;
+
+  export function nativeVideoExecutorAsync(
+    message: GrabFrameMessage,
+  ): Promise<GrabFrameMessageResponse>;
+
+  export function nativeVideoExecutorAsync(
+    message: DetectBowMessage,
+  ): Promise<DetectBowMessageResponse>;
+
+  export function nativeVideoExecutorAsync(
+    message: RefreshFileMessage,
+  ): Promise<RefreshFileMessageResponse>;
+
+  export function nativeVideoExecutorAsync(
+    message: ConfigureReaderMessage,
+  ): Promise<MessageResponseBase>;
+
+  export function nativeVideoExecutorAsync(
+    message: ProbeFilesMessage,
+  ): Promise<ProbeFilesMessageResponse>;
+
+  export function nativeVideoExecutorAsync(
+    message: OpenTimelineMessage,
+  ): Promise<OpenTimelineMessageResponse>;
+
+  export function nativeVideoExecutorAsync(
+    message: GrabFramesAtTimeMessage,
+  ): Promise<GrabFramesAtTimeMessageResponse>;
 }
@@ -1,4 +1,5 @@
 const addon = require('bindings')('crewtimer_video_reader');
 
-module.exports = {nativeVideoExecutor: addon.nativeVideoExecutor
+module.exports = {nativeVideoExecutor: addon.nativeVideoExecutor,
+  nativeVideoExecutorAsync: addon.nativeVideoExecutorAsync
 };
\ No newline at end of file
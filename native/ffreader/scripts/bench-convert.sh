@@ -0,0 +1,25 @@
+#!/bin/bash
+set -e
+
+# Builds and runs the YUV to RGBA conversion benchmark against the static
+# ffmpeg in lib-build (see build-ffmpeg.sh). Optional argument: iterations.
+
+cd "$(dirname "$0")/.."
+
+if [[ "$OSTYPE" == "darwin"* ]]; then
+  FFMPEG_DIR="lib-build/ffmpeg-static-mac"
+  EXTRA_LIBS="-framework CoreFoundation -framework CoreVideo -framework CoreMedia -framework VideoToolbox"
+else
+  FFMPEG_DIR="lib-build/ffmpeg-static-linux"
+  EXTRA_LIBS="-lpthread -lm"
+fi
+
+OUT_DIR="build/bench"
+mkdir -p "${OUT_DIR}"
+
+c++ -std=c++20 -O2 -I"${FFMPEG_DIR}/include" \
+  bench/ConvertBench.cpp src/YuvToRgba.cpp \
+  "${FFMPEG_DIR}/lib/libswscale.a" "${FFMPEG_DIR}/lib/libavutil.a" \
+  ${EXTRA_LIBS} -o "${OUT_DIR}/convert-bench"
+
+"${OUT_DIR}/convert-bench" "$@"
@@ -1,4 +1,7 @@
 #include "FFReader.hpp"
+#include "FrameConverter.hpp"
+#include "MappedFile.hpp"
+#include "WorkerPool.hpp"
 
 extern "C"
 {
@@ -11,6 +14,8 @@ extern "C"
 }
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
 
 #if defined(__APPLE__)
@@ -30,14 +35,66 @@ extern "C"
 constexpr static size_t max_read_attempts = 4096;
 constexpr static size_t max_decode_attempts = 64;
 constexpr static double eps_zero = 0.000025;
+// Distance within which decoding forward beats a seek; also the least number
+// of frames the frame store keeps for short backward steps.
+constexpr static size_t short_seek_frames = 32;
+// Largest step between requests still treated as stepping or playback.
+constexpr static int64_t prefetch_max_step = 4;
+// Cost of a seek and decoder flush, in frames of decoding.
+constexpr static int64_t seek_cost_frames = 4;
 
 static double inline r2d(AVRational r)
 {
   return r.num == 0 || r.den == 0 ? 0. : (double)r.num / (double)r.den;
 }
 
+/** Flag of the innermost DecodeCancelScope on this thread, if any. */
+static thread_local const std::atomic<bool> *decodeCancelFlag = nullptr;
+
+DecodeCancelScope::DecodeCancelScope(const std::atomic<bool> *flag)
+    : previous(decodeCancelFlag)
+{
+  decodeCancelFlag = flag;
+}
+
+DecodeCancelScope::~DecodeCancelScope() { decodeCancelFlag = previous; }
+
+bool DecodeCancelScope::cancelled()
+{
+  return decodeCancelFlag && decodeCancelFlag->load(std::memory_order_relaxed);
+}
+
+FFVideoReader::ForegroundLock::ForegroundLock(FFVideoReader &reader)
+    : reader(reader)
+{
+  // Counted before blocking so the worker stops picking up new work while we
+  // wait for the frame it is decoding.
+  reader.foregroundWaiting++;
+  lock = std::unique_lock<std::recursive_mutex>(reader.readerMutex);
+}
+
+FFVideoReader::ForegroundLock::~ForegroundLock()
+{
+  lock.unlock();
+  {
+    std::lock_guard<std::mutex> signalLock(reader.prefetchSignalMutex);
+    reader.foregroundWaiting--;
+  }
+  reader.prefetchSignal.notify_all();
+}
+
 FFVideoReader::FFVideoReader()
 {
+  foregroundWaiting = 0;
+  prefetchStop = false;
+  prefetchEnabled = false;
+  prefetchGeneration = 0;
+  prefetchBudgetBytes = 0;
+  reverseBudgetBytes = 0;
+  frameStoreBudgetBytes = 256 * 1024 * 1024;
+  frameStoreHistorySec = 1.0;
+  prefetchDirection = PrefetchDirection::None;
+  lastRequestedFrame = -1;
   formatContext = nullptr;
   codecContext = nullptr;
   hwDeviceContext = nullptr;
@@ -45,7 +102,9 @@ FFVideoReader::FFVideoReader()
   hwDecodeActive = false;
   hwDecodeStatusLogged = false;
   hwFrameTransferLogged = false;
-  swsContext = nullptr;
+  hardwareDecodeAllowed = true;
+  ioMode = FileIOMode::Default;
+  ioReadAheadBytes = 4 * 1024 * 1024;
   packet = nullptr;
   frame = nullptr;
   rgbaFrame = nullptr;
@@ -57,13 +116,36 @@ FFVideoReader::~FFVideoReader() { closeFile(); }
 
 void FFVideoReader::closeFile(void)
 {
-  while (recentFrames.size())
+  stopPrefetch();
+  ForegroundLock lock(*this);
   {
-    auto oldest = recentFrames.front();
-    av_frame_free(&oldest.second);
-    recentFrames.pop_front();
+    std::lock_guard<std::mutex> signalLock(prefetchSignalMutex);
+    prefetchDirection = PrefetchDirection::None;
+    lastRequestedFrame = -1;
   }
-
+  prefetchFillFrom = -1;
+  prefetchFillTo = -1;
+  prefetchLastFillTo = -1;
+  decodingIntoReverse = false;
+  decoderFrameNumber = -1;
+  clearReverseFrames();
+
+  frameStore.clear();
+  scrubDecoder.close();
+  for (auto *decoder : intraDecoders)
+  {
+    avcodec_free_context(&decoder);
+  }
+  intraDecoders.clear();
+  intraOnly = false;
+
+  frameIndex.clear();
+  indexPtsOffset = 0;
+  tailFrameCount = 0;
+  tailFileSize = 0;
+  videoFilename.clear();
+  cachedSummary = VideoIndexSummary();
+  hasCachedSummary = false;
   picture_pts = AV_NOPTS_VALUE_;
   currentFrameNumber = -1;
   firstFrameNumber = -1;
@@ -80,15 +162,13 @@ void FFVideoReader::closeFile(void)
     avformat_close_input(&formatContext);
     avformat_free_context(formatContext);
   }
+  // After the demuxer, which reads through it until closed.
+  fileSource.reset();
   if (codecContext)
   {
     avcodec_close(codecContext);
     avcodec_free_context(&codecContext);
   }
-  if (swsContext)
-  {
-    sws_freeContext(swsContext);
-  }
   if (rgbaFrame)
   {
     av_frame_free(&rgbaFrame);
@@ -101,7 +181,6 @@ void FFVideoReader::closeFile(void)
   hwDecodeActive = false;
   hwDecodeStatusLogged = false;
   hwFrameTransferLogged = false;
-  swsContext = nullptr;
   packet = nullptr;
   frame = nullptr;
   rgbaFrame = nullptr;
@@ -128,18 +207,34 @@ double FFVideoReader::dts_to_sec(int64_t dts) const
          r2d(formatContext->streams[videoStreamIndex]->time_base);
 }
 
+int64_t FFVideoReader::indexOffset() const
+{
+  if (firstFrameNumber >= 0 || frameIndex.framePts.empty())
+  {
+    return indexPtsOffset;
+  }
+  const int64_t startTime = formatContext->streams[videoStreamIndex]->start_time;
+  return startTime != AV_NOPTS_VALUE_ ? startTime - frameIndex.framePts.front() : 0;
+}
+
 /**
- * @brief Converts a given DTS to a frame number based on the current FPS.
+ * @brief Converts a given DTS to a frame number.
  *
- * This function first converts the DTS to seconds using dts_to_sec(),
- * then multiplies by getFps() to get the frame index. The 0.5 added before
- * casting ensures proper rounding to the nearest integer frame.
+ * With a frame index the result is the position of the nearest indexed
+ * frame, so numbering follows the actual presented frames even when the
+ * frame rate varies. Without one, the DTS is converted to seconds using
+ * dts_to_sec() and multiplied by getFps(); the 0.5 added before casting
+ * rounds to the nearest integer frame.
  *
  * @param dts The Decoding Timestamp to be converted.
- * @return The estimated frame number corresponding to the given DTS.
+ * @return The frame number corresponding to the given DTS.
  */
 int64_t FFVideoReader::dts_to_frame_number(int64_t dts) const
 {
+  if (!frameIndex.framePts.empty())
+  {
+    return frameIndex.nearestFrame(dts - indexOffset());
+  }
   // For VFR files, r_frame_rate can disagree with nb_frames/duration by ~1%,
   // so prefer stream ticks (avg frame duration = stream->duration/nb_frames)
   // when both are known. Falls back to fps*sec otherwise.
@@ -153,6 +248,38 @@ int64_t FFVideoReader::dts_to_frame_number(int64_t dts) const
   return (int64_t)(getFps() * sec + 0.5);
 }
 
+/**
+ * @brief Converts a frame number to the stream timestamp it should appear at.
+ *
+ * The inverse of dts_to_frame_number(): the indexed timestamp of the frame,
+ * clamped to the indexed range, or without an index an estimate from the
+ * average frame duration (stream->duration/nb_frames) when known, otherwise
+ * 1/getFps().
+ *
+ * @param frameNumber The zero-based frame index.
+ * @return The timestamp in stream time_base units.
+ */
+int64_t FFVideoReader::frame_number_to_ts(int64_t frameNumber) const
+{
+  if (!frameIndex.framePts.empty())
+  {
+    const int64_t position = std::min(std::max(frameNumber, (int64_t)0), frameIndex.size() - 1);
+    return frameIndex.framePts[position] + indexOffset();
+  }
+  const auto *st = formatContext->streams[videoStreamIndex];
+  int64_t ts = st->start_time;
+  if (st->duration > 0 && st->nb_frames > 0)
+  {
+    ts += frameNumber * st->duration / st->nb_frames;
+  }
+  else
+  {
+    double sec = static_cast<double>(frameNumber) / std::max(getFps(), 1e-6);
+    ts += static_cast<int64_t>(sec / r2d(st->time_base) + 0.5);
+  }
+  return ts;
+}
+
 /**
  * @brief Retrieves the duration of the video in seconds.
  *
@@ -179,22 +306,26 @@ double FFVideoReader::getDurationSec() const
 /**
  * @brief Estimates or retrieves the total number of frames in the video.
  *
- * This function first checks nb_frames in the video stream. If nb_frames
- * is zero (which is common for certain codecs or container formats), the
- * method approximates total frames by multiplying getDurationSec() and
- * getFps().
+ * With a frame index this is the number of indexed frames. Otherwise this
+ * function checks nb_frames in the video stream. If nb_frames is zero
+ * (which is common for certain codecs or container formats), the method
+ * approximates total frames by multiplying getDurationSec() and getFps().
  *
  * @return The estimated or reported total number of frames in the video.
  */
 int64_t FFVideoReader::getTotalFrames() const
 {
+  if (!frameIndex.framePts.empty())
+  {
+    return frameIndex.size();
+  }
   int64_t nbf = formatContext->streams[videoStreamIndex]->nb_frames;
 
   if (nbf == 0)
   {
     nbf = (int64_t)floor(getDurationSec() * getFps() + 0.5);
   }
-  return nbf;
+  return std::max(nbf, tailFrameCount);
 }
 
 /**
@@ -372,20 +503,39 @@ AVFrame *FFVideoReader::ensureSoftwareFrame(AVFrame *decodedFrame)
  *         find stream information, locate a video stream, or properly
  *         decode the first frame).
  */
-int FFVideoReader::openFile(const std::string filename)
+int FFVideoReader::openFile(const std::string filename, bool decodeFirstFrame,
+                            const VideoIndex *sharedIndex)
 {
   // av_log_set_level(AV_LOG_DEBUG);
+  stopPrefetch();
+  ForegroundLock lock(*this);
   closeFile();
   first_utc_us = 0;
   packet = av_packet_alloc();
   frame = av_frame_alloc();
   formatContext = avformat_alloc_context();
+  if (ioMode != FileIOMode::Default)
+  {
+    fileSource = std::make_unique<FileSource>();
+    if (fileSource->open(filename, ioMode, ioReadAheadBytes))
+    {
+      formatContext->pb = fileSource->context();
+      formatContext->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
+    else
+    {
+      std::cerr << "Custom I/O unavailable for " << filename
+                << ", using default file access" << std::endl;
+      fileSource.reset();
+    }
+  }
   int ret =
       avformat_open_input(&formatContext, filename.c_str(), nullptr, nullptr);
   if (ret != 0)
   {
     avformat_free_context(formatContext);
     formatContext = nullptr;
+    fileSource.reset();
     char err[160];
     av_strerror(ret, err, 160);
     std::cerr << "Error: Couldn't open video file " << filename << " " << err
@@ -458,7 +608,7 @@ int FFVideoReader::openFile(const std::string filename)
     return -1;
   }
 
-  bool hardwareDecodeConfigured = initHardwareDecode();
+  bool hardwareDecodeConfigured = hardwareDecodeAllowed && initHardwareDecode();
   codecRet = avcodec_open2(codecContext, codec, nullptr);
   if (codecRet < 0 && hardwareDecodeConfigured)
   {
@@ -496,9 +646,37 @@ int FFVideoReader::openFile(const std::string filename)
   // std::cout << "Width: " << codecContext->width << std::endl;
   // std::cout << "Height: " << codecContext->height << std::endl;
 
-  auto firstFrame = seekToFrame(0);
+  videoFilename = filename;
+  configureFrameStore();
+  if (sharedIndex)
+  {
+    // Another reader of the same file already scanned it.
+    frameIndex = *sharedIndex;
+  }
+  else
+  {
+    hasCachedSummary = loadVideoIndexCache(
+        filename, formatContext->streams[videoStreamIndex]->time_base, frameIndex,
+        cachedSummary);
+    if (!hasCachedSummary && !frameIndex.build(formatContext, videoStreamIndex))
+    {
+      std::cerr << "Frame index unavailable for " << filename
+                << "; seeking by timestamp estimate" << std::endl;
+    }
+  }
+
+  // MJPEG, ProRes and all-intra captures: any frame decodes from its own packet.
+  intraOnly = !frameIndex.empty() && frameIndex.keyframes.size() == frameIndex.framePts.size();
 
-  if (!hwDecodeStatusLogged)
+  int64_t mtime;
+  if (!getFileStamp(filename, tailFileSize, mtime))
+  {
+    tailFileSize = 0;
+  }
+
+  auto firstFrame = decodeFirstFrame ? seekToFrame(0) : nullptr;
+
+  if (decodeFirstFrame && !hwDecodeStatusLogged)
   {
     if (hwFrameTransferLogged || hwDecodeActive)
     {
@@ -518,7 +696,88 @@ int FFVideoReader::openFile(const std::string filename)
     hwDecodeStatusLogged = true;
   }
 
-  return firstFrame ? 0 : -1;
+  if (decodeFirstFrame && !firstFrame)
+  {
+    return -1;
+  }
+  startPrefetch();
+  return 0;
+}
+
+bool FFVideoReader::refreshTail()
+{
+  ForegroundLock lock(*this);
+  uint64_t size;
+  int64_t mtime;
+  if (!formatContext || frameIndex.empty() ||
+      !getFileStamp(videoFilename, size, mtime) || size == tailFileSize)
+  {
+    return false;
+  }
+  tailFileSize = size;
+  const int64_t added = frameIndex.extend(formatContext, videoStreamIndex);
+
+  // The demuxer has moved to EOF, so the next request has to seek.
+  avcodec_flush_buffers(codecContext);
+  currentFrameNumber = -1;
+  decoderFrameNumber = -1;
+  picture_pts = AV_NOPTS_VALUE_;
+  if (added == 0)
+  {
+    return false;
+  }
+
+  // The cached summary describes the shorter file.
+  hasCachedSummary = false;
+  int64_t lastFrameNumber;
+  int64_t firstPts;
+  int64_t lastPts;
+  if (getIndexedExtent(lastFrameNumber, firstPts, lastPts))
+  {
+    tailFrameCount = lastFrameNumber;
+  }
+  return true;
+}
+
+bool FFVideoReader::getIndexedExtent(int64_t &lastFrameNumber, int64_t &firstPts,
+                                     int64_t &lastPts)
+{
+  ForegroundLock lock(*this);
+  if (!formatContext || frameIndex.empty())
+  {
+    return false;
+  }
+  const int64_t offset = indexOffset();
+  firstPts = frameIndex.framePts.front() + offset;
+  lastPts = frameIndex.framePts.back() + offset;
+  const int64_t anchor =
+      firstFrameNumber >= 0 ? firstFrameNumber : dts_to_frame_number(firstPts);
+  lastFrameNumber = dts_to_frame_number(lastPts) - anchor + 1;
+  return true;
+}
+
+/**
+ * @brief Persists the frame index together with file-level facts.
+ *
+ * The cache is keyed on the video's size and mtime, so it is ignored
+ * automatically if the file is replaced or modified.
+ *
+ * @param summary First/last frame facts determined by the caller.
+ * @return true if the cache was written.
+ */
+bool FFVideoReader::saveIndexCache(const VideoIndexSummary &summary)
+{
+  ForegroundLock lock(*this);
+  if (!formatContext || videoFilename.empty() ||
+      !saveVideoIndexCache(videoFilename,
+                           formatContext->streams[videoStreamIndex]->time_base,
+                           frameIndex, summary))
+  {
+    return false;
+  }
+  cachedSummary = summary;
+  hasCachedSummary = true;
+  return true;
 }
 
 /**
@@ -533,12 +792,14 @@ int FFVideoReader::openFile(const std::string filename)
  * method computes the frame index with dts_to_frame_number() and stores it in currentFrameNumber.
  * On the very first decoded frame, firstFrameNumber is set as the zero-point for the frame index.
  *
- * In addition, this method deep-copies the newly decoded frame and adds it to a ring buffer
- * (recentFrames), which can hold up to 32 frames. This buffer allows short backward seeks
- * without needing to re-read or re-decode from an earlier keyframe.
+ * In addition, this method references the newly decoded frame into frameStore, which holds
+ * as many frames as its byte budget allows. This allows short backward seeks without
+ * needing to re-read or re-decode from an earlier keyframe. While the prefetch worker runs
+ * a backward fill, frames go to reverseFrames instead.
  *
- * @note If no valid frame is found or decoding fails, the method returns @c nullptr.
- * @note The ring buffer logic is optional and is primarily used to facilitate short backward seeks.
+ * @note If no valid frame is found, decoding fails or the calling thread's
+ *       DecodeCancelScope is cancelled, the method returns @c nullptr.
+ * @note The frame store is primarily used to facilitate short backward seeks.
  *
  * @return A pointer to the newly decoded AVFrame if successful, or @c nullptr if decoding fails.
  */
@@ -547,6 +808,15 @@ AVFrame *FFVideoReader::grabFrame()
   size_t cur_read_attempts = 0;
   size_t cur_decode_attempts = 0;
 
+  // A superseded request stops between frames. The caller may have just
+  // seeked, so the position is marked stale as on a decode failure.
+  if (DecodeCancelScope::cancelled())
+  {
+    currentFrameNumber = -1;
+    decoderFrameNumber = -1;
+    return nullptr;
+  }
+
   // First, check if the decoder already has a frame in its buffer
   if (avcodec_receive_frame(codecContext, frame) != 0)
   {
@@ -614,13 +884,28 @@ AVFrame *FFVideoReader::grabFrame()
     if (!valid)
     {
       currentFrameNumber = -1; // mark as stale
+      decoderFrameNumber = -1;
       return nullptr;
     }
   }
+  return acceptFrame();
+}
 
+/**
+ * @brief Numbers the frame just received into @p frame and stores it.
+ *
+ * Shared by grabFrame() and readIntraFrame(): transfers hardware frames,
+ * fixes up the pts, anchors the numbering on the first frame and adds the
+ * frame to the frame store (or the reverse buffer during a backward fill).
+ *
+ * @return @p frame, or nullptr if it could not be made CPU-readable.
+ */
+AVFrame *FFVideoReader::acceptFrame()
+{
   if (!ensureSoftwareFrame(frame))
   {
     currentFrameNumber = -1;
+    decoderFrameNumber = -1;
     return nullptr;
   }
 
@@ -643,24 +928,32 @@ AVFrame *FFVideoReader::grabFrame()
   // Set the anchor if this is our first valid frame
   if (firstFrameNumber < 0)
   {
-    firstFrameNumber = dts_to_frame_number(picture_pts);
+    // The offset is measured first: with a frame index, numbering depends
+    // on it, and the first presented frame is then position 0.
+    indexPtsOffset =
+        frameIndex.empty() ? 0 : picture_pts - frameIndex.framePts.front();
+    firstFrameNumber = frameIndex.empty() ? dts_to_frame_number(picture_pts) : 0;
   }
 
   currentFrameNumber = dts_to_frame_number(picture_pts) - firstFrameNumber;
+  decoderFrameNumber = currentFrameNumber;
 
-  // Deep-copy the newly decoded frame into our ring buffer
-  AVFrame *copy = av_frame_alloc();
-  av_frame_ref(copy, frame);
-  recentFrames.emplace_back(currentFrameNumber, copy);
-
-  // Keep the ring buffer at a maximum of 32 frames
-  while (recentFrames.size() > 32)
+  if (decodingIntoReverse)
   {
-    auto oldest = recentFrames.front();
-    av_frame_free(&oldest.second);
-    recentFrames.pop_front();
+    // Backward fill: keep the frames of the window, skip the keyframe lead-in
+    if (currentFrameNumber >= prefetchFillFrom && currentFrameNumber < prefetchFillTo &&
+        !reverseFrames.count(currentFrameNumber))
+    {
+      AVFrame *copy = av_frame_alloc();
+      av_frame_ref(copy, frame);
+      reverseFrames.emplace(currentFrameNumber, copy);
+    }
+    return frame;
   }
 
+  // Reference the newly decoded frame into the store; it evicts to its budget
+  frameStore.put(currentFrameNumber, frame);
+
   // std::cout << "DEBUG: Grabbed frame =>\n"
   //           << "  packet->pts  = " << packet->pts << "\n"
   //           << "  packet->dts  = " << packet->dts << "\n"
@@ -686,6 +979,232 @@ AVFrame *FFVideoReader::grabFrame()
   return frame;
 }
 
+/** @brief Seeks to the indexed packet of a frame and reads it into packet. */
+bool FFVideoReader::readPacketAt(int64_t frameNumber)
+{
+  if (frameNumber < 0 || frameNumber >= frameIndex.size() ||
+      av_seek_frame(formatContext, videoStreamIndex, frameIndex.framePts[frameNumber],
+                    AVSEEK_FLAG_BACKWARD) < 0)
+  {
+    return false;
+  }
+  for (size_t attempts = 0; attempts < max_read_attempts; attempts++)
+  {
+    av_packet_unref(packet);
+    const int ret = av_read_frame(formatContext, packet);
+    if (ret == AVERROR(EAGAIN))
+    {
+      continue;
+    }
+    if (ret < 0)
+    {
+      return false;
+    }
+    if (packet->stream_index == videoStreamIndex)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** @brief Decodes an intra-only frame from its own packet, draining the decoder. */
+AVFrame *FFVideoReader::readIntraFrame(int64_t frameNumber)
+{
+  avcodec_flush_buffers(codecContext);
+  bool decoded = readPacketAt(frameNumber) && avcodec_send_packet(codecContext, packet) >= 0;
+  av_packet_unref(packet);
+  if (decoded)
+  {
+    // Drain so the frame comes out now rather than once the decoder's frame
+    // threads are full, then flush so the next packet can be sent.
+    avcodec_send_packet(codecContext, nullptr);
+    decoded = avcodec_receive_frame(codecContext, frame) >= 0;
+    avcodec_flush_buffers(codecContext);
+  }
+  if (!decoded || !acceptFrame())
+  {
+    currentFrameNumber = -1;
+    decoderFrameNumber = -1;
+    return nullptr;
+  }
+  return currentFrameNumber == frameNumber ? frame : nullptr;
+}
+
+AVCodecContext *FFVideoReader::openIntraDecoder() const
+{
+  const AVCodecParameters *par = formatContext->streams[videoStreamIndex]->codecpar;
+  const AVCodec *codec = avcodec_find_decoder(par->codec_id);
+  AVCodecContext *decoder = codec ? avcodec_alloc_context3(codec) : nullptr;
+  if (!decoder || avcodec_parameters_to_context(decoder, par) < 0)
+  {
+    avcodec_free_context(&decoder);
+    return nullptr;
+  }
+  // The batch is spread over the lanes; each decoder works alone.
+  decoder->thread_count = 1;
+  if (avcodec_open2(decoder, codec, nullptr) < 0)
+  {
+    avcodec_free_context(&decoder);
+    return nullptr;
+  }
+  return decoder;
+}
+
+std::vector<std::shared_ptr<AVFrame>>
+FFVideoReader::getIntraFrames(const std::vector<int64_t> &frameNumbers)
+{
+  ForegroundLock lock(*this);
+  std::vector<std::shared_ptr<AVFrame>> frames(frameNumbers.size());
+  if (!formatContext || !intraOnly)
+  {
+    return frames;
+  }
+
+  // Frames held already need no decode; the rest are read in file order.
+  std::vector<size_t> order;
+  for (size_t i = 0; i < frameNumbers.size(); i++)
+  {
+    const int64_t position = frameNumbers[i] - 1;
+    if (position < 0 || position >= frameIndex.size())
+    {
+      continue;
+    }
+    AVFrame *recent = position == currentFrameNumber ? frame : findRecentFrame(position);
+    if (recent)
+    {
+      frames[i] = shareFrame(recent);
+    }
+    else
+    {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b)
+            { return frameNumbers[a] < frameNumbers[b]; });
+
+  std::vector<AVPacket *> packets(order.size(), nullptr);
+  for (size_t k = 0; k < order.size(); k++)
+  {
+    if (readPacketAt(frameNumbers[order[k]] - 1))
+    {
+      packets[k] = av_packet_clone(packet);
+    }
+    av_packet_unref(packet);
+  }
+  // The demuxer has moved; the next sequential request has to seek.
+  avcodec_flush_buffers(codecContext);
+  currentFrameNumber = -1;
+  decoderFrameNumber = -1;
+
+  auto &pool = WorkerPool::shared();
+  int lanes = (int)std::min(order.size(), pool.concurrency());
+  while ((int)intraDecoders.size() < lanes)
+  {
+    AVCodecContext *decoder = openIntraDecoder();
+    if (!decoder)
+    {
+      break;
+    }
+    intraDecoders.push_back(decoder);
+  }
+  lanes = std::min(lanes, (int)intraDecoders.size());
+  const AVRational timeBase = formatContext->streams[videoStreamIndex]->time_base;
+  auto decodeLane = [&](int lane)
+  {
+    AVCodecContext *decoder = intraDecoders[lane];
+    AVFrame *decoded = av_frame_alloc();
+    for (size_t k = lane; decoded && k < packets.size(); k += lanes)
+    {
+      if (packets[k] && avcodec_send_packet(decoder, packets[k]) >= 0)
+      {
+        avcodec_send_packet(decoder, nullptr);
+        if (avcodec_receive_frame(decoder, decoded) >= 0)
+        {
+          if (decoded->pts == AV_NOPTS_VALUE_)
+          {
+            decoded->pts = decoded->pkt_dts;
+          }
+          decoded->time_base = timeBase;
+          frames[order[k]] = shareFrame(decoded);
+          av_frame_unref(decoded);
+        }
+      }
+      avcodec_flush_buffers(decoder);
+    }
+    av_frame_free(&decoded);
+  };
+  if (lanes > 0)
+  {
+    pool.parallelFor(lanes, decodeLane);
+  }
+
+  for (size_t k = 0; k < order.size(); k++)
+  {
+    av_packet_free(&packets[k]);
+    if (frames[order[k]])
+    {
+      frameStore.put(frameNumbers[order[k]] - 1, frames[order[k]].get());
+    }
+  }
+  return frames;
+}
+
+/**
+ * @brief Positions the decoder on a frame using the frame index.
+ *
+ * The keyframe that starts the target's GOP is looked up in frameIndex and,
+ * unless the decoder already sits inside that GOP before the target, the
+ * demuxer is sent there with a single av_seek_frame(). Index and keyframe
+ * positions are both in presentation order, so the backward seek lands on
+ * that keyframe, or for reordered streams at worst an earlier one, and never
+ * past the target.
+ *
+ * @param frameNumber The zero-based frame index to reach.
+ * @return The decoded frame, or nullptr if the index disagrees with the
+ *         decoded timestamps (the caller then falls back to searching).
+ */
+AVFrame *FFVideoReader::seekWithIndex(int64_t frameNumber)
+{
+  const int64_t keyframe = frameIndex.keyframeForFrame(frameNumber);
+  if (keyframe < 0)
+  {
+    return nullptr;
+  }
+
+  bool seek = true;
+  if (currentFrameNumber >= 0 && picture_pts != AV_NOPTS_VALUE_ &&
+      dts_to_frame_number(picture_pts) - firstFrameNumber < frameNumber)
+  {
+    // The decoder is behind the target; skip the seek if it is already past
+    // the keyframe we would seek to.
+    seek = frameIndex.frameAtOrBefore(picture_pts - indexOffset()) < keyframe;
+  }
+
+  if (seek)
+  {
+    if (av_seek_frame(formatContext, videoStreamIndex,
+                      frameIndex.framePts[keyframe], AVSEEK_FLAG_BACKWARD) < 0)
+    {
+      return nullptr;
+    }
+    avcodec_flush_buffers(codecContext);
+    if (!grabFrame())
+    {
+      return nullptr;
+    }
+  }
+
+  while (currentFrameNumber >= 0 && currentFrameNumber < frameNumber)
+  {
+    if (!grabFrame())
+    {
+      return nullptr;
+    }
+  }
+  return currentFrameNumber == frameNumber ? frame : nullptr;
+}
+
 /**
  * @brief Seeks to a specific frame number in the video stream.
  *
@@ -695,6 +1214,11 @@ AVFrame *FFVideoReader::grabFrame()
  * variable to seek slightly earlier than the desired frame and then decode forward
  * until the requested frame is reached.
  *
+ * When a frame index is available the exact keyframe is known up front and
+ * seekWithIndex() reaches the frame with a single seek; for intra-only
+ * streams readIntraFrame() decodes just the frame's own packet. The
+ * estimate-based paths below remain as a fallback for files without an index.
+ *
  * The method adaptively increases `delta` (the number of frames to seek backward)
  * if the initially guessed seek position is not close enough to decode to the
  * desired frame. This makes seeking more robust, especially for formats like H.264
@@ -712,6 +1236,7 @@ AVFrame *FFVideoReader::grabFrame()
  */
 AVFrame *FFVideoReader::seekToFrame(int64_t frameNumber, bool closeTo)
 {
+  ForegroundLock lock(*this);
   frameNumber = std::min(frameNumber, getTotalFrames() - 1);
   // if we have not grabbed a single frame before first seek, let's read the
   // first frame and get some valuable information during the process
@@ -730,26 +1255,36 @@ AVFrame *FFVideoReader::seekToFrame(int64_t frameNumber, bool closeTo)
     return frame;
   }
 
-  auto fps = getFps(); // needed below
+  // Every frame is a keyframe: one packet read and one decode, except for
+  // the next frame, where sequential decoding keeps the frame threads busy.
+  if (intraOnly && frameNumber != currentFrameNumber + 1 && !findRecentFrame(frameNumber) &&
+      readIntraFrame(frameNumber))
+  {
+    return frame;
+  }
 
   if (!closeTo)
   {
 
-    // Check our ring buffer
-    for (auto it = recentFrames.rbegin(); it != recentFrames.rend(); ++it)
+    // Check the frame store and the GOP-reverse buffer
+    AVFrame *recent = frameStore.get(frameNumber);
+    if (!recent)
     {
-      if (it->first == frameNumber)
-      {
-        // Found it in buffer – set currentFrameNumber & copy the frame
-        av_frame_ref(frame, it->second);
-        currentFrameNumber = frameNumber;
-        return frame;
-      }
+      auto reverse = reverseFrames.find(frameNumber);
+      recent = reverse != reverseFrames.end() ? reverse->second : nullptr;
+    }
+    if (recent)
+    {
+      // Found it in buffer – set currentFrameNumber & copy the frame
+      av_frame_unref(frame);
+      av_frame_ref(frame, recent);
+      currentFrameNumber = frameNumber;
+      return frame;
     }
 
     // If we're close to the correct position, seek forward frame by frame
     int64_t seekDelta = frameNumber - currentFrameNumber;
-    if (seekDelta > 0 && seekDelta < 32)
+    if (seekDelta > 0 && seekDelta < (int64_t)short_seek_frames)
     {
       while (currentFrameNumber < frameNumber)
       {
@@ -764,10 +1299,16 @@ AVFrame *FFVideoReader::seekToFrame(int64_t frameNumber, bool closeTo)
       }
     }
 
+    // One seek to the keyframe starting the target's GOP, then decode forward.
+    if (!frameIndex.empty() && seekWithIndex(frameNumber))
+    {
+      return frame;
+    }
+
     // --------------------------------------------------------------------------
     // Fast path: small *backward* jump (|seekDelta| < 32) not found in ring buffer
     // --------------------------------------------------------------------------
-    if (seekDelta < 0 && -seekDelta < 32)
+    if (seekDelta < 0 && -seekDelta < (int64_t)short_seek_frames)
     {
       /* -------------------------------------------------------------
        * Strategy:
@@ -778,19 +1319,7 @@ AVFrame *FFVideoReader::seekToFrame(int64_t frameNumber, bool closeTo)
        *      (= at most 31 calls, so still cheap).
        * ------------------------------------------------------------- */
 
-      auto *st = formatContext->streams[videoStreamIndex];
-      int64_t start_pts = st->start_time;
-      int64_t ts;
-      if (st->duration > 0 && st->nb_frames > 0)
-      {
-        ts = start_pts + frameNumber * st->duration / st->nb_frames;
-      }
-      else
-      {
-        double tb = r2d(st->time_base);
-        double sec = static_cast<double>(frameNumber) / std::max(fps, 1e-6);
-        ts = start_pts + static_cast<int64_t>(sec / tb + 0.5);
-      }
+      int64_t ts = frame_number_to_ts(frameNumber);
 
       if (av_seek_frame(formatContext, videoStreamIndex, ts, AVSEEK_FLAG_BACKWARD) < 0)
         return nullptr; // seek failed (corrupt file?)
@@ -809,24 +1338,13 @@ AVFrame *FFVideoReader::seekToFrame(int64_t frameNumber, bool closeTo)
     }
   }
   //
-  // Not found in ring buffer or seek from last position. Fall back to av_seek_frame search.
+  // Not found in frame store or seek from last position. Fall back to av_seek_frame search.
   //
   int delta = closeTo ? 0 : 16;
   for (;;)
   {
     int64_t _frame_number_temp = std::max(frameNumber - delta, (int64_t)0);
-    auto *st = formatContext->streams[videoStreamIndex];
-    int64_t time_stamp = st->start_time;
-    if (st->duration > 0 && st->nb_frames > 0)
-    {
-      time_stamp += _frame_number_temp * st->duration / st->nb_frames;
-    }
-    else
-    {
-      double sec = (double)_frame_number_temp / fps;
-      double time_base = r2d(st->time_base);
-      time_stamp += (int64_t)(sec / time_base + 0.5);
-    }
+    int64_t time_stamp = frame_number_to_ts(_frame_number_temp);
 
     if (getTotalFrames() > 1)
     {
@@ -876,11 +1394,10 @@ AVFrame *FFVideoReader::seekToFrame(int64_t frameNumber, bool closeTo)
 /**
  * @brief Converts a decoded frame to an RGBA-formatted AVFrame.
  *
- * This method uses an swsContext (created on demand) to convert the input
- * frame from its native format (e.g., YUV) into RGBA. If swsContext is not
- * yet initialized, it is allocated for the dimensions and pixel formats
- * of the current frame. The output frame (rgbaFrame) is also allocated
- * if necessary, ensuring it matches the dimensions of the source.
+ * This method uses the calling thread's FrameConverter to convert the input
+ * frame from its native format (e.g., YUV) into RGBA, in parallel bands for
+ * large frames. The output frame (rgbaFrame) is allocated if necessary,
+ * ensuring it matches the dimensions of the source.
  *
  * @param frame A pointer to the decoded frame in its original format.
  * @return A pointer to the RGBA-formatted AVFrame, or @c nullptr if the
@@ -888,20 +1405,6 @@ AVFrame *FFVideoReader::seekToFrame(int64_t frameNumber, bool closeTo)
  */
 const AVFrame *FFVideoReader::ConvertFrameToRGBA(AVFrame *frame)
 {
-  // Create a context for the conversion if it doesn't exist
-  if (!swsContext)
-  {
-    swsContext = sws_getContext(
-        frame->width, frame->height, (AVPixelFormat)frame->format, // Source
-        frame->width, frame->height, AV_PIX_FMT_RGBA,              // Destination
-        SWS_BILINEAR, nullptr, nullptr, nullptr);
-    if (!swsContext)
-    {
-      std::cerr << "Could not initialize the conversion context!" << std::endl;
-      return nullptr;
-    }
-  }
-
   // Allocate memory for the output frame if needed
   if (!rgbaFrame || frame->width != rgbaFrame->width ||
       frame->height != rgbaFrame->height)
@@ -931,11 +1434,11 @@ const AVFrame *FFVideoReader::ConvertFrameToRGBA(AVFrame *frame)
     }
   }
 
-  // Perform the conversion
-  sws_scale(swsContext,
-            frame->data, frame->linesize, 0, frame->height, // Source
-            rgbaFrame->data, rgbaFrame->linesize            // Destination
-  );
+  if (!FrameConverter::forThread().toRGBA(frame, 0, 0, frame->width, frame->height,
+                                          rgbaFrame->data[0], rgbaFrame->linesize[0]))
+  {
+    return nullptr;
+  }
 
   rgbaFrame->pts = frame->pts;
   rgbaFrame->time_base = frame->time_base;
@@ -960,10 +1463,13 @@ const AVFrame *FFVideoReader::ConvertFrameToRGBA(AVFrame *frame)
  */
 const AVFrame *FFVideoReader::getRGBAFrame(int64_t frameNumber, bool closeTo)
 {
+  ForegroundLock lock(*this);
   // 1 to N based frameNumber
   if (frameNumber < 1 || frameNumber > getTotalFrames())
     return nullptr;
 
+  notePrefetchRequest(frameNumber - 1, closeTo);
+
   // 0 to N-1 based frameNumber
   AVFrame *frame = seekToFrame(frameNumber - 1, closeTo);
   if (!frame)
@@ -974,6 +1480,493 @@ const AVFrame *FFVideoReader::getRGBAFrame(int64_t frameNumber, bool closeTo)
   return ConvertFrameToRGBA(frame);
 }
 
+std::shared_ptr<AVFrame> FFVideoReader::getDecodedFrame(int64_t frameNumber, bool closeTo)
+{
+  ForegroundLock lock(*this);
+  // 1 to N based frameNumber
+  if (frameNumber < 1 || frameNumber > getTotalFrames())
+    return nullptr;
+
+  if (closeTo)
+  {
+    auto keyframe = getScrubFrame(frameNumber, 0);
+    if (keyframe)
+    {
+      return keyframe;
+    }
+  }
+
+  notePrefetchRequest(frameNumber - 1, closeTo);
+
+  // 0 to N-1 based frameNumber
+  return shareFrame(seekToFrame(frameNumber - 1, closeTo));
+}
+
+std::shared_ptr<AVFrame> FFVideoReader::getScrubFrame(int64_t frameNumber, int maxWidth,
+                                                      int64_t *keyframeNumber)
+{
+  ForegroundLock lock(*this);
+  int64_t keyframeTs = 0;
+  const int64_t keyframe = getKeyframeNumber(frameNumber, &keyframeTs);
+  if (keyframe < 1 ||
+      !scrubDecoder.open(videoFilename, videoStreamIndex, maxWidth))
+  {
+    return nullptr;
+  }
+  auto decoded = scrubDecoder.decodeAt(keyframeTs);
+  if (decoded && keyframeNumber)
+  {
+    *keyframeNumber = keyframe;
+  }
+  return decoded;
+}
+
+int64_t FFVideoReader::getKeyframeNumber(int64_t frameNumber, int64_t *keyframeTs)
+{
+  ForegroundLock lock(*this);
+  if (!formatContext || frameIndex.empty() || frameNumber < 1 ||
+      frameNumber > getTotalFrames())
+  {
+    return -1;
+  }
+  const int64_t keyframe = frameIndex.keyframeForFrame(frameNumber - 1);
+  if (keyframe < 0)
+  {
+    return -1;
+  }
+  if (keyframeTs)
+  {
+    *keyframeTs = frameIndex.framePts[keyframe];
+  }
+  return keyframe + 1;
+}
+
+int64_t FFVideoReader::getFrameNumberForPts(int64_t pts)
+{
+  ForegroundLock lock(*this);
+  if (!formatContext)
+  {
+    return -1;
+  }
+  int64_t anchor = firstFrameNumber;
+  if (anchor < 0)
+  {
+    const int64_t startTime = formatContext->streams[videoStreamIndex]->start_time;
+    anchor = dts_to_frame_number(startTime != AV_NOPTS_VALUE_ ? startTime : pts);
+  }
+  return dts_to_frame_number(pts) - anchor + 1;
+}
+
+int64_t FFVideoReader::getDecodeCost(int64_t frameNumber, bool *seeks)
+{
+  ForegroundLock lock(*this);
+  if (seeks)
+  {
+    *seeks = false;
+  }
+  if (!formatContext || frameNumber < 1 || frameNumber > getTotalFrames())
+  {
+    return INT64_MAX;
+  }
+  // 0 to N-1 based, as seekToFrame() numbers frames
+  const int64_t target = frameNumber - 1;
+  if (target == currentFrameNumber || findRecentFrame(target))
+  {
+    return 0;
+  }
+
+  if (intraOnly)
+  {
+    return 1;
+  }
+
+  const int64_t delta = target - currentFrameNumber;
+  const bool ahead = currentFrameNumber >= 0 && picture_pts != AV_NOPTS_VALUE_ && delta > 0;
+  if (ahead && delta < (int64_t)short_seek_frames)
+  {
+    return delta;
+  }
+  if (seeks)
+  {
+    // Nothing is lost by moving a decoder that has no position yet.
+    *seeks = currentFrameNumber >= 0;
+  }
+  if (frameIndex.empty())
+  {
+    // The GOP is unknown; assume the backoff of the estimate-based seek.
+    return seek_cost_frames + (int64_t)short_seek_frames;
+  }
+
+  const int64_t keyframe = frameIndex.keyframeForFrame(target);
+  if (ahead && frameIndex.frameAtOrBefore(picture_pts - indexOffset()) >= keyframe)
+  {
+    // Already inside the target's GOP: seekWithIndex() decodes forward.
+    if (seeks)
+    {
+      *seeks = false;
+    }
+    return delta;
+  }
+  return seek_cost_frames + target - std::max(keyframe, (int64_t)0);
+}
+
+VideoIndex FFVideoReader::copyFrameIndex()
+{
+  ForegroundLock lock(*this);
+  return frameIndex;
+}
+
+int64_t FFVideoReader::getIndexOffset()
+{
+  ForegroundLock lock(*this);
+  return formatContext ? indexOffset() : 0;
+}
+
+AVFrame *FFVideoReader::findRecentFrame(int64_t frameNumber) const
+{
+  AVFrame *stored = frameStore.peek(frameNumber);
+  if (stored)
+  {
+    return stored;
+  }
+  auto reverse = reverseFrames.find(frameNumber);
+  return reverse != reverseFrames.end() ? reverse->second : nullptr;
+}
+
+void FFVideoReader::clearReverseFrames()
+{
+  for (auto &entry : reverseFrames)
+  {
+    av_frame_free(&entry.second);
+  }
+  reverseFrames.clear();
+}
+
+void FFVideoReader::notePrefetchRequest(int64_t frameNumber, bool closeTo)
+{
+  {
+    std::lock_guard<std::mutex> signalLock(prefetchSignalMutex);
+    const int64_t step = frameNumber - lastRequestedFrame;
+    if (closeTo || lastRequestedFrame < 0)
+    {
+      prefetchDirection = PrefetchDirection::None;
+    }
+    else if (step > 0 && step <= prefetch_max_step)
+    {
+      prefetchDirection = PrefetchDirection::Forward;
+    }
+    else if (step < 0 && -step <= prefetch_max_step)
+    {
+      prefetchDirection = PrefetchDirection::Backward;
+    }
+    else if (step != 0)
+    {
+      prefetchDirection = PrefetchDirection::None;
+    }
+    lastRequestedFrame = closeTo ? -1 : frameNumber;
+    prefetchGeneration++;
+  }
+  if (prefetchDirection != PrefetchDirection::Backward)
+  {
+    prefetchFillTo = -1;
+    prefetchLastFillTo = -1;
+  }
+  if (prefetchDirection == PrefetchDirection::None)
+  {
+    // A jump or scrub; the reverse window no longer matches.
+    clearReverseFrames();
+  }
+  prefetchSignal.notify_all();
+}
+
+int64_t FFVideoReader::decodedFrameBytes() const
+{
+  int frameBytes = -1;
+  if (frame && frame->width > 0 && frame->height > 0)
+  {
+    frameBytes = av_image_get_buffer_size((AVPixelFormat)frame->format,
+                                          frame->width, frame->height, 1);
+  }
+  if (frameBytes <= 0 && codecContext)
+  {
+    // 4:2:0 estimate until the first software frame is seen.
+    frameBytes = codecContext->width * codecContext->height * 3 / 2;
+  }
+  return std::max(frameBytes, 0);
+}
+
+int64_t FFVideoReader::prefetchFrameCount() const
+{
+  const int64_t frameBytes = decodedFrameBytes();
+  if (frameBytes <= 0)
+  {
+    return 0;
+  }
+  // Leave half the store for the frames already shown.
+  const int64_t storeFrames = std::min<int64_t>(
+      frameStore.maxFrames(), frameStoreBudgetBytes / frameBytes);
+  return std::min<int64_t>(prefetchBudgetBytes / frameBytes,
+                           std::max<int64_t>(storeFrames, short_seek_frames) / 2);
+}
+
+/**
+ * @brief Fills the GOP-reverse buffer below @p lastFrame, one frame per call.
+ *
+ * The window is the reverseBudgetBytes worth of frames just below the last
+ * request. A fill seeks to the keyframe of the highest frame missing from the
+ * window and decodes forward to it, keeping the frames inside the window.
+ * Everything above that frame is already buffered, so the next fill starts
+ * at the previous keyframe: each GOP is decoded once, and while the user
+ * steps through one GOP the worker decodes the one before it.
+ *
+ * When the window is smaller than the GOP a fill is deferred until half of
+ * the window has been consumed, bounding the repeated lead-in decoding.
+ */
+bool FFVideoReader::reverseStep(int64_t lastFrame)
+{
+  const int64_t frameBytes = decodedFrameBytes();
+  const int64_t capacity = frameBytes > 0 ? (int64_t)reverseBudgetBytes / frameBytes : 0;
+  if (capacity <= 0)
+  {
+    return false;
+  }
+  const int64_t low = std::max<int64_t>(lastFrame - capacity, 0);
+
+  // Frames already stepped past are not needed again.
+  for (auto it = reverseFrames.begin(); it != reverseFrames.end();)
+  {
+    if (it->first < low || it->first > lastFrame)
+    {
+      av_frame_free(&it->second);
+      it = reverseFrames.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  if (prefetchFillTo < 0)
+  {
+    int64_t missing = 0;
+    int64_t highestMissing = -1;
+    for (int64_t f = lastFrame - 1; f >= low; f--)
+    {
+      if (!findRecentFrame(f))
+      {
+        missing++;
+        if (highestMissing < 0)
+        {
+          highestMissing = f;
+        }
+      }
+    }
+    // Stop if the last fill did not produce the frame it was meant to.
+    if (highestMissing < 0 || highestMissing + 1 == prefetchLastFillTo)
+    {
+      return false;
+    }
+
+    int64_t ts = frame_number_to_ts(low);
+    bool gopFits = false;
+    if (!frameIndex.empty())
+    {
+      const int64_t keyframe = frameIndex.keyframeForFrame(highestMissing);
+      if (keyframe >= 0)
+      {
+        ts = frameIndex.framePts[keyframe];
+        gopFits = keyframe >= low;
+      }
+    }
+    if (!gopFits && missing * 2 < lastFrame - low)
+    {
+      return false;
+    }
+
+    if (av_seek_frame(formatContext, videoStreamIndex, ts, AVSEEK_FLAG_BACKWARD) < 0)
+    {
+      return false;
+    }
+    avcodec_flush_buffers(codecContext);
+    prefetchFillFrom = low;
+    prefetchFillTo = highestMissing + 1;
+  }
+
+  decodingIntoReverse = true;
+  const bool decoded = grabFrame() != nullptr;
+  decodingIntoReverse = false;
+  if (!decoded || decoderFrameNumber + 1 >= prefetchFillTo)
+  {
+    // This GOP is done; the next call moves on to the previous one.
+    prefetchLastFillTo = prefetchFillTo;
+    prefetchFillTo = -1;
+    return decoded;
+  }
+  return true;
+}
+
+/**
+ * @brief Decodes one frame ahead of the most recent request.
+ *
+ * Forward: continues decoding from the current decoder position until the
+ * frames after @p lastFrame are in frameStore. It never seeks; if the
+ * decoder is somewhere else the next foreground request will reposition it.
+ *
+ * Backward: fills the GOP-reverse buffer, see reverseStep().
+ */
+bool FFVideoReader::prefetchStep(PrefetchDirection direction, int64_t lastFrame)
+{
+  if (!formatContext || !codecContext || firstFrameNumber < 0 || lastFrame < 0)
+  {
+    return false;
+  }
+
+  if (direction == PrefetchDirection::Backward)
+  {
+    return reverseStep(lastFrame);
+  }
+
+  const int64_t ahead = prefetchFrameCount();
+  if (direction == PrefetchDirection::Forward && ahead > 0)
+  {
+    const int64_t last = std::min(lastFrame + ahead, getTotalFrames() - 1);
+    int64_t next = lastFrame + 1;
+    while (next <= last && findRecentFrame(next))
+    {
+      next++;
+    }
+    if (next > last || decoderFrameNumber < 0 || decoderFrameNumber >= next ||
+        next - decoderFrameNumber > (int64_t)short_seek_frames)
+    {
+      return false;
+    }
+    return grabFrame() != nullptr;
+  }
+
+  return false;
+}
+
+void FFVideoReader::prefetchLoop()
+{
+  uint64_t idleGeneration = 0;
+  bool idle = false;
+  std::unique_lock<std::mutex> signalLock(prefetchSignalMutex);
+  while (!prefetchStop)
+  {
+    if (foregroundWaiting > 0 || prefetchDirection == PrefetchDirection::None ||
+        (idle && idleGeneration == prefetchGeneration))
+    {
+      prefetchSignal.wait(signalLock);
+      continue;
+    }
+
+    const uint64_t generation = prefetchGeneration;
+    const PrefetchDirection direction = prefetchDirection;
+    const int64_t lastFrame = lastRequestedFrame;
+    signalLock.unlock();
+
+    bool more;
+    {
+      // Held for one frame at most; ForegroundLock callers get in next.
+      std::lock_guard<std::recursive_mutex> readerLock(readerMutex);
+      more = prefetchStep(direction, lastFrame);
+    }
+
+    signalLock.lock();
+    if (!more)
+    {
+      idle = true;
+      idleGeneration = generation;
+    }
+  }
+}
+
+void FFVideoReader::startPrefetch()
+{
+  if (prefetchThread.joinable() || !formatContext)
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> signalLock(prefetchSignalMutex);
+    if (!prefetchEnabled)
+    {
+      return;
+    }
+    prefetchStop = false;
+  }
+  prefetchThread = std::thread(&FFVideoReader::prefetchLoop, this);
+}
+
+void FFVideoReader::stopPrefetch()
+{
+  if (!prefetchThread.joinable())
+  {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> signalLock(prefetchSignalMutex);
+    prefetchStop = true;
+  }
+  prefetchSignal.notify_all();
+  prefetchThread.join();
+}
+
+void FFVideoReader::setPrefetch(bool enable, size_t budgetBytes, size_t reverseBytes)
+{
+  if (!enable)
+  {
+    stopPrefetch();
+  }
+  {
+    std::lock_guard<std::mutex> signalLock(prefetchSignalMutex);
+    prefetchEnabled = enable;
+  }
+
+  ForegroundLock lock(*this);
+  prefetchBudgetBytes = budgetBytes;
+  reverseBudgetBytes = reverseBytes;
+  if (enable)
+  {
+    startPrefetch();
+  }
+  else
+  {
+    clearReverseFrames();
+  }
+}
+
+void FFVideoReader::configureFrameStore()
+{
+  size_t maxFrames = short_seek_frames;
+  if (formatContext)
+  {
+    maxFrames = std::max<size_t>(
+        maxFrames, (size_t)std::ceil(getFps() * std::max(frameStoreHistorySec, 0.0)));
+  }
+  frameStore.configure(frameStoreBudgetBytes, maxFrames, short_seek_frames);
+}
+
+void FFVideoReader::setFrameStore(size_t budgetBytes, double historySec)
+{
+  ForegroundLock lock(*this);
+  frameStoreBudgetBytes = budgetBytes;
+  frameStoreHistorySec = historySec;
+  configureFrameStore();
+}
+
+FrameStore::Stats FFVideoReader::getFrameStoreStats()
+{
+  ForegroundLock lock(*this);
+  return frameStore.stats();
+}
+
+size_t FFVideoReader::getReverseFrameCount()
+{
+  ForegroundLock lock(*this);
+  return reverseFrames.size();
+}
+
 // ffmpeg -sseof -4 -i tmp-X22_00_55.mp4 -update 1 last.png
 
 #ifdef FFREADER_TEST
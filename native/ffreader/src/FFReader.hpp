@@ -1,5 +1,19 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <map>
+#include <mutex>
 #include <string>
-#include <deque>
+#include <thread>
+#include <vector>
+
+#include "FileSource.hpp"
+#include "FrameStore.hpp"
+#include "ScrubDecoder.hpp"
+#include "VideoIndex.hpp"
+#include "VideoIndexCache.hpp"
 
 extern "C"
 {
@@ -9,6 +23,31 @@ extern "C"
 #include <libswscale/swscale.h>
 }
 
+/**
+ * @class DecodeCancelScope
+ * @brief Lets decodes on the calling thread be cancelled while in scope.
+ *
+ * Readers check the flag before decoding each frame; once it is set, a seek
+ * in progress gives up and returns nullptr, leaving the reader to seek
+ * afresh on its next request. Used by requests that a newer one for the
+ * same view can replace.
+ */
+class DecodeCancelScope
+{
+public:
+  explicit DecodeCancelScope(const std::atomic<bool> *flag);
+  ~DecodeCancelScope();
+
+  DecodeCancelScope(const DecodeCancelScope &) = delete;
+  DecodeCancelScope &operator=(const DecodeCancelScope &) = delete;
+
+  /** True once the flag of the calling thread's innermost scope is set. */
+  static bool cancelled();
+
+private:
+  const std::atomic<bool> *previous;
+};
+
 // This class heavily leveraged from
 // https://github.com/opencv/opencv/blob/a8ec6586118c3f8e8f48549a85f2da7a5b78bcc9/modules/videoio/src/cap_ffmpeg_impl.hpp#L1473
 
@@ -19,11 +58,41 @@ extern "C"
  * This class provides methods to open a video file, seek to specific frames,
  * and decode frames into various formats (including RGBA). It also manages
  * FFmpeg structures like AVFormatContext, AVCodecContext, and SwsContext,
- * and maintains a small ring buffer of recently decoded frames to facilitate
- * short backward seeking.
+ * and keeps recently decoded frames in a memory-budgeted FrameStore to
+ * facilitate short backward seeking.
+ *
+ * An optional prefetch worker (see setPrefetch()) follows the direction of
+ * recent getRGBAFrame() requests and decodes ahead while the caller is idle:
+ * forward into the frame store, backward a whole GOP at a time into a
+ * reverse buffer so stepping back costs about the same as stepping forward.
+ * All public methods serialize on an internal mutex and the worker yields to
+ * them after at most one frame of decoding.
  */
 class FFVideoReader
 {
+  /** Direction the prefetch worker decodes ahead in. */
+  enum class PrefetchDirection
+  {
+    None,
+    Forward,
+    Backward
+  };
+
+  /**
+   * RAII guard held by public methods. Takes readerMutex and, while waiting
+   * for or holding it, keeps the prefetch worker from starting new work.
+   */
+  class ForegroundLock
+  {
+  public:
+    explicit ForegroundLock(FFVideoReader &reader);
+    ~ForegroundLock();
+
+  private:
+    FFVideoReader &reader;
+    std::unique_lock<std::recursive_mutex> lock;
+  };
+
   /** A pointer to the format context, which holds information about the container format. */
   AVFormatContext *formatContext;
 
@@ -42,18 +111,39 @@ class FFVideoReader
   /** True after the hardware decode status has been logged for this file. */
   bool hwDecodeStatusLogged;
 
+  /** False to open files with CPU decode only, see setHardwareDecode(). */
+  bool hardwareDecodeAllowed;
+
+  /** How files opened afterwards are read, see setFileIO(). */
+  FileIOMode ioMode;
+
+  /** Read size for FileIOMode::ReadAhead. */
+  size_t ioReadAheadBytes;
+
+  /** Custom I/O of the open file; null with FileIOMode::Default. */
+  std::unique_ptr<FileSource> fileSource;
+
   /** True after the first hardware frame transfer has been logged for this file. */
   bool hwFrameTransferLogged;
 
-  /** A SwsContext used for pixel format conversion (e.g., YUV -> RGBA). */
-  SwsContext *swsContext;
-
   /** A reusable AVPacket for reading and sending compressed video data to the decoder. */
   AVPacket *packet;
 
   /** A reusable AVFrame for receiving decoded frames from the decoder. */
   AVFrame *frame;
 
+  /** Keyframe-only decoder for scrubbing; never moves the main decoder. */
+  ScrubDecoder scrubDecoder;
+
+  /** True when every indexed frame is a keyframe, see readIntraFrame(). */
+  bool intraOnly;
+
+  /**
+   * Software decoders for getIntraFrames(), one per parallel lane, opened
+   * on first use.
+   */
+  std::vector<AVCodecContext *> intraDecoders;
+
   /** A reusable AVFrame for storing a frame converted to RGBA pixel format. */
   AVFrame *rgbaFrame;
 
@@ -82,16 +172,113 @@ class FFVideoReader
   int64_t firstFrameNumber;
 
   /**
-   * A small ring buffer that stores pairs of (frameNumber, AVFrame*)
-   * for recently decoded frames. Facilitates quick short-range backward seeks.
+   * Recently decoded frames keyed by frame number, bounded in bytes.
+   * Facilitates quick short-range backward seeks.
+   */
+  FrameStore frameStore;
+
+  /** Byte budget for frameStore, see setFrameStore(). */
+  size_t frameStoreBudgetBytes;
+
+  /** Seconds of video frameStore should be able to hold, see setFrameStore(). */
+  double frameStoreHistorySec;
+
+  /**
+   * GOP-reverse buffer: frames below the current backward position, decoded
+   * one GOP per pass by the prefetch worker and keyed by frame number.
+   * Bounded by reverseBudgetBytes; frames already stepped past are dropped.
+   */
+  std::map<int64_t, AVFrame *> reverseFrames;
+
+  /**
+   * True while the prefetch worker decodes a backward fill; grabFrame() then
+   * stores frames in [prefetchFillFrom, prefetchFillTo) into reverseFrames
+   * instead of frameStore and drops the keyframe lead-in.
+   */
+  bool decodingIntoReverse;
+
+  /** Frame number of the last frame produced by the decoder, -1 if unknown. */
+  int64_t decoderFrameNumber;
+
+  /**
+   * Frame and keyframe timestamps for the video stream, built at openFile.
+   * Lets seekToFrame pick the keyframe that starts the target's GOP.
+   */
+  VideoIndex frameIndex;
+
+  /**
+   * Difference between decoded pts and frameIndex timestamps, measured on the
+   * first decoded frame. Non-zero when a container index holds DTS with a
+   * constant composition offset to the PTS, as with B-frames at a constant
+   * frame rate.
    */
-  std::deque<std::pair<int64_t, AVFrame *>> recentFrames;
+  int64_t indexPtsOffset;
+
+  /** Frame count found by refreshTail(), 0 until the file has grown. */
+  int64_t tailFrameCount;
+
+  /** File size when the frame index was last extended. */
+  uint64_t tailFileSize;
+
+  /** Path of the open file, used to locate its index cache. */
+  std::string videoFilename;
+
+  /** File summary loaded from the index cache, valid when hasCachedSummary. */
+  VideoIndexSummary cachedSummary;
+
+  /** True when frameIndex and cachedSummary came from a valid index cache. */
+  bool hasCachedSummary;
 
   /**
    * UTC microseconds of the first frame in the video.
    */
   uint64_t first_utc_us;
 
+  /** Serializes all decoder access between callers and the prefetch worker. */
+  std::recursive_mutex readerMutex;
+
+  /** Number of foreground calls waiting for or holding readerMutex. */
+  std::atomic<int> foregroundWaiting;
+
+  /** Background thread decoding ahead of the caller, when enabled. */
+  std::thread prefetchThread;
+
+  /** Guards the prefetch signalling state below. */
+  std::mutex prefetchSignalMutex;
+
+  /** Wakes the prefetch worker on new requests, foreground release or stop. */
+  std::condition_variable prefetchSignal;
+
+  /** Set to ask the prefetch worker to exit. */
+  bool prefetchStop;
+
+  /** True when the caller asked for prefetching via setPrefetch(). */
+  bool prefetchEnabled;
+
+  /** Incremented for every foreground frame request. */
+  uint64_t prefetchGeneration;
+
+  /** Decoded bytes the worker may hold ahead of the current request. */
+  size_t prefetchBudgetBytes;
+
+  /** Direction inferred from the most recent requests. */
+  PrefetchDirection prefetchDirection;
+
+  /** Zero-based frame number of the most recent foreground request, or -1. */
+  int64_t lastRequestedFrame;
+
+  /** Decoded bytes the reverse buffer may hold below the current request. */
+  size_t reverseBudgetBytes;
+
+  /** Lowest frame the current backward fill keeps, or -1 when none is active. */
+  int64_t prefetchFillFrom;
+
+  /** Frame the current backward fill decodes up to (exclusive upper end). */
+  int64_t prefetchFillTo;
+
+  /** Upper end of the last completed backward fill, to avoid repeating it. */
+  int64_t prefetchLastFillTo;
+
   /**
    * @brief Converts a decoding timestamp (DTS) to seconds using the stream's time base.
    *
@@ -101,13 +288,35 @@ class FFVideoReader
   double dts_to_sec(int64_t dts) const;
 
   /**
-   * @brief Converts a decoding timestamp (DTS) to a frame index based on the current FPS.
+   * @brief Converts a decoded timestamp to a frame index.
    *
-   * @param dts The DTS to be converted.
-   * @return The estimated frame index corresponding to the given DTS.
+   * With a frame index this is the position of the nearest indexed frame, so
+   * frame N is exactly the Nth presented frame. Otherwise it is estimated
+   * from the frame rate.
+   *
+   * @param dts The timestamp to be converted.
+   * @return The frame index corresponding to the timestamp.
    */
   int64_t dts_to_frame_number(int64_t dts) const;
 
+  /**
+   * @brief Converts a frame index to the stream timestamp it is presented at.
+   *
+   * Exact with a frame index, otherwise estimated from the frame rate.
+   *
+   * @param frameNumber The zero-based frame index.
+   * @return The timestamp in stream time_base units.
+   */
+  int64_t frame_number_to_ts(int64_t frameNumber) const;
+
+  /**
+   * @brief Difference between decoded pts and frameIndex timestamps.
+   *
+   * indexPtsOffset once the first frame is decoded; before that the stream
+   * start_time is taken as the first frame's pts.
+   */
+  int64_t indexOffset() const;
+
   /**
    * @brief Retrieves the duration of the video (in seconds).
    *
@@ -146,12 +355,106 @@ class FFVideoReader
    * If the decoder has a frame queued internally, it returns it immediately.
    * Otherwise, it reads packets until a valid frame is decoded. The function
    * also updates internal timestamps and adds the decoded frame to the
-   * ring buffer for potential backward-seeking.
+   * frame store for potential backward-seeking.
    *
    * @return A pointer to the newly decoded AVFrame, or nullptr on failure.
    */
   AVFrame *grabFrame();
 
+  /**
+   * @brief Numbers and stores the frame just received into frame; the second
+   * half of grabFrame().
+   *
+   * @return frame, or nullptr if it could not be made CPU-readable.
+   */
+  AVFrame *acceptFrame();
+
+  /**
+   * @brief Seeks to the packet of a frame using the frame index and reads it
+   * into packet.
+   *
+   * @param frameNumber The zero-based frame index.
+   */
+  bool readPacketAt(int64_t frameNumber);
+
+  /**
+   * @brief Decodes a frame of an intra-only stream from its own packet.
+   *
+   * One seek, one packet read and one decode, drained straight out of the
+   * decoder; used instead of the GOP logic when intraOnly is set.
+   *
+   * @param frameNumber The zero-based frame index.
+   * @return The decoded frame, or nullptr on failure.
+   */
+  AVFrame *readIntraFrame(int64_t frameNumber);
+
+  /** Opens a single-threaded software decoder for the video stream. */
+  AVCodecContext *openIntraDecoder() const;
+
+  /**
+   * @brief Positions the decoder on a frame using the frame index.
+   *
+   * Issues at most one av_seek_frame() to the keyframe that starts the
+   * target's GOP (none when the decoder is already inside that GOP and behind
+   * the target), then decodes forward to the frame.
+   *
+   * @param frameNumber The zero-based frame index to reach.
+   * @return The decoded frame, or nullptr if the index could not place it.
+   */
+  AVFrame *seekWithIndex(int64_t frameNumber);
+
+  /** Returns the frame store or reverse buffer entry for @p frameNumber, or nullptr. */
+  AVFrame *findRecentFrame(int64_t frameNumber) const;
+
+  /** Applies the frame store limits for the open file's resolution and fps. */
+  void configureFrameStore();
+
+  /** Frees every frame in reverseFrames. */
+  void clearReverseFrames();
+
+  /**
+   * @brief Records a foreground request and updates the prefetch direction.
+   *
+   * Steps of up to a few frames in the same direction as the previous one
+   * (arrow-key stepping or playback) select Forward or Backward; anything
+   * else, including closeTo scrubbing, stops prefetching.
+   */
+  void notePrefetchRequest(int64_t frameNumber, bool closeTo);
+
+  /** Approximate bytes of one decoded frame, or 0 if unknown. */
+  int64_t decodedFrameBytes() const;
+
+  /** Number of frames the worker may keep ahead, from the memory budget. */
+  int64_t prefetchFrameCount() const;
+
+  /**
+   * @brief Decodes one frame of the backward fill below @p lastFrame.
+   *
+   * Starts a fill by seeking to the keyframe of the highest missing frame in
+   * the reverse window, so each GOP is decoded exactly once.
+   */
+  bool reverseStep(int64_t lastFrame);
+
+  /**
+   * @brief Performs one unit of prefetch work with readerMutex held.
+   *
+   * Decodes at most one frame (plus a seek when starting a backward fill).
+   *
+   * @param direction Direction of the recent requests.
+   * @param lastFrame Zero-based frame number of the most recent request.
+   * @return true if more work remains for this request.
+   */
+  bool prefetchStep(PrefetchDirection direction, int64_t lastFrame);
+
+  /** Prefetch worker body. */
+  void prefetchLoop();
+
+  /** Starts the prefetch worker if enabled and a file is open. */
+  void startPrefetch();
+
+  /** Stops and joins the prefetch worker. Must not hold readerMutex. */
+  void stopPrefetch();
+
 public:
   /**
    * @brief Default constructor. Initializes internal pointers and state.
@@ -168,13 +471,113 @@ public:
    */
   uint64_t getFirstUtcUs() const { return first_utc_us; }
 
+  /**
+   * @brief Retrieves the file summary stored in the index cache.
+   *
+   * @return The summary when the index was loaded from a cache that matches
+   *         the file on disk, otherwise nullptr.
+   */
+  const VideoIndexSummary *getCachedSummary() const
+  {
+    return hasCachedSummary ? &cachedSummary : nullptr;
+  }
+
+  /**
+   * @brief Writes the frame index and @p summary to the on-disk index cache
+   * so the next openFile of this file can skip indexing and probing.
+   *
+   * @return true if the cache was written.
+   */
+  bool saveIndexCache(const VideoIndexSummary &summary);
+
   /**
    * @brief Opens a video file for reading and decoding.
    *
    * @param filename The path to the video file.
+   * @param decodeFirstFrame If false, the first frame is not decoded until it
+   *                         is requested, so opening only costs the demuxer
+   *                         probe and the frame index.
+   * @param sharedIndex Frame index of the same file from another reader, used
+   *                    instead of loading or building one.
    * @return 0 on success, or -1 on failure (e.g., if file or stream can’t be opened).
    */
-  int openFile(const std::string filename);
+  int openFile(const std::string filename, bool decodeFirstFrame = true,
+               const VideoIndex *sharedIndex = nullptr);
+
+  /** Path of the open file. */
+  const std::string &getFilename() const { return videoFilename; }
+
+  /** A copy of the frame index, for opening another reader of the file. */
+  VideoIndex copyFrameIndex();
+
+  /**
+   * @brief Difference between decoded pts and the frame index timestamps,
+   * for decoders outside this reader that number frames the same way.
+   */
+  int64_t getIndexOffset();
+
+  /**
+   * @brief Reads the extent of the file from the frame index, without decoding.
+   *
+   * Before the first decode the presentation timestamps are anchored on the
+   * stream start_time, which is the first frame's pts.
+   *
+   * @param lastFrameNumber Receives the 1 to N number of the last indexed
+   *                        frame, in the numbering getDecodedFrame() uses.
+   * @param firstPts Receives the pts of the first frame.
+   * @param lastPts Receives the pts of the last frame.
+   * @return false without a frame index.
+   */
+  bool getIndexedExtent(int64_t &lastFrameNumber, int64_t &firstPts, int64_t &lastPts);
+
+  /**
+   * @brief Allows or prevents hardware decoding for files opened afterwards.
+   *
+   * Probes that decode at most one frame skip the device setup this way.
+   */
+  void setHardwareDecode(bool enable) { hardwareDecodeAllowed = enable; }
+
+  /**
+   * @brief Selects how files opened afterwards are read.
+   *
+   * @param mode FileIOMode::Default uses FFmpeg's file protocol.
+   * @param readAheadBytes Size of each read with FileIOMode::ReadAhead.
+   */
+  void setFileIO(FileIOMode mode, size_t readAheadBytes)
+  {
+    ioMode = mode;
+    ioReadAheadBytes = readAheadBytes;
+  }
+
+  /** Read size for FileIOMode::ReadAhead, see setFileIO(). */
+  size_t getReadAheadBytes() const { return ioReadAheadBytes; }
+
+  /** I/O mode of the open file. */
+  FileIOMode getFileIOMode() const
+  {
+    return fileSource ? ioMode : FileIOMode::Default;
+  }
+
+  /**
+   * @brief Bytes, reads and seeks since the file was opened. All zero with
+   * FileIOMode::Default, where FFmpeg does the I/O.
+   */
+  FileIOStats getIOStats() const
+  {
+    return fileSource ? fileSource->stats() : FileIOStats();
+  }
+
+  /** Coded width of the video stream. */
+  int getWidth() const { return formatContext->streams[videoStreamIndex]->codecpar->width; }
+
+  /** Coded height of the video stream. */
+  int getHeight() const { return formatContext->streams[videoStreamIndex]->codecpar->height; }
+
+  /** Time base of the video stream's timestamps. */
+  AVRational getTimeBase() const
+  {
+    return formatContext->streams[videoStreamIndex]->time_base;
+  }
 
   /**
    * @brief Closes the currently open file, freeing any associated resources.
@@ -195,13 +598,26 @@ public:
   /**
    * @brief Retrieves the total number of frames in the video, if known.
    *
-   * If nb_frames in the stream is zero, it estimates the total frame count
-   * by multiplying duration (in seconds) by FPS.
+   * With a frame index this is the number of indexed frames. Otherwise
+   * nb_frames, or if that is zero, duration (in seconds) times FPS.
    *
    * @return The estimated or reported number of frames in the video.
    */
   int64_t getTotalFrames() const;
 
+  /**
+   * @brief Picks up frames appended to a file that is still being written.
+   *
+   * When the file has grown since the last call, packets from the last
+   * indexed keyframe to the new end of file are demuxed (not decoded) and
+   * appended to the frame index, and getTotalFrames() grows to match. Works
+   * for formats that can be read while written, such as fragmented MP4 and
+   * MPEG-TS.
+   *
+   * @return true if new frames were found.
+   */
+  bool refreshTail();
+
   /**
    * @brief Seeks to a specified frame number in the video.
    *
@@ -231,4 +647,125 @@ public:
    * @return A pointer to an RGBA-formatted AVFrame, or nullptr on failure.
    */
   const AVFrame *getRGBAFrame(int64_t frameNumber, bool closeTo = false);
+
+  /**
+   * @brief Retrieves a frame (by index) in its decoded pixel format.
+   *
+   * Same seeking behavior as getRGBAFrame() but without conversion. The
+   * result is a new reference to the decoded buffers, so it stays valid while
+   * the reader (or its prefetch worker) continues decoding.
+   *
+   * When @p closeTo is set and a frame index is available, the keyframe is
+   * decoded by the scrub decoder and the exact-decode position and prefetch
+   * state are left alone.
+   *
+   * @param frameNumber The target frame index to retrieve - 1 to N.
+   * @param closeTo If true, may stop at the nearest keyframe.
+   * @return The decoded frame, or nullptr on failure.
+   */
+  std::shared_ptr<AVFrame> getDecodedFrame(int64_t frameNumber, bool closeTo = false);
+
+  /**
+   * @brief Decodes the keyframe at or before a frame on the scrub decoder.
+   *
+   * Meant for fast drags and thumbnails: only the keyframe is decoded, on a
+   * separate decoder, optionally at reduced resolution.
+   *
+   * @param frameNumber The frame to preview - 1 to N.
+   * @param maxWidth Preferred width for codecs that can decode at reduced
+   *                 resolution; 0 for full size. Callers scale the result
+   *                 further if it is still wider.
+   * @param keyframeNumber Receives the 1 to N number of the decoded keyframe.
+   * @return The decoded keyframe, or nullptr if there is no frame index or
+   *         decoding fails.
+   */
+  std::shared_ptr<AVFrame> getScrubFrame(int64_t frameNumber, int maxWidth,
+                                         int64_t *keyframeNumber = nullptr);
+
+  /**
+   * @brief Returns the keyframe getScrubFrame() would decode for a frame.
+   *
+   * @param frameNumber The frame to look up - 1 to N.
+   * @param keyframeTs Receives the keyframe's seek timestamp, for callers
+   *                   that decode it on their own ScrubDecoder.
+   * @return The 1 to N keyframe number, or -1 without a frame index.
+   */
+  int64_t getKeyframeNumber(int64_t frameNumber, int64_t *keyframeTs = nullptr);
+
+  /**
+   * @brief Frame number of the frame presented at @p pts.
+   *
+   * Uses the same numbering as getDecodedFrame(). Before the first decode the
+   * numbering is anchored on the stream start_time.
+   *
+   * @param pts Presentation timestamp in the stream time_base.
+   * @return The 1 to N frame number, or -1 when no file is open.
+   */
+  int64_t getFrameNumberForPts(int64_t pts);
+
+  /**
+   * @brief Estimates the work getDecodedFrame() would do for a frame.
+   *
+   * Zero for the current frame or one held in the frame store or reverse
+   * buffer, the forward distance when the decoder can reach it without
+   * seeking, and otherwise a seek plus the frames from the GOP's keyframe.
+   *
+   * @param frameNumber The frame to estimate - 1 to N.
+   * @param seeks Receives whether reaching the frame moves the decoder away
+   *              from the position it last decoded; false before the first
+   *              decode.
+   * @return The cost in decoded frames, INT64_MAX if out of range.
+   */
+  int64_t getDecodeCost(int64_t frameNumber, bool *seeks = nullptr);
+
+  /** True when every frame of the stream is a keyframe (MJPEG, ProRes, all-intra). */
+  bool isIntraOnly() const { return intraOnly; }
+
+  /**
+   * @brief Decodes several frames of an intra-only stream in parallel.
+   *
+   * The packets are read here in file order, then decoded on separate
+   * decoders across the shared worker pool. Frames already held are not
+   * decoded again. Leaves the main decoder without a position.
+   *
+   * @param frameNumbers Frames to decode - 1 to N, in any order.
+   * @return One entry per requested frame, nullptr where it failed; all
+   *         nullptr unless isIntraOnly().
+   */
+  std::vector<std::shared_ptr<AVFrame>> getIntraFrames(const std::vector<int64_t> &frameNumbers);
+
+  /** Index of the decoded video stream within the container. */
+  int getVideoStreamIndex() const { return videoStreamIndex; }
+
+  /**
+   * @brief Enables or disables the background prefetch worker.
+   *
+   * When enabled, a thread watches the pattern of getRGBAFrame() requests and,
+   * for forward or backward stepping, decodes the next frames in that
+   * direction into the frame store so the following step is a cache hit.
+   *
+   * @param enable True to run the worker while a file is open.
+   * @param budgetBytes Decoded-frame bytes the worker may hold ahead of the
+   *                    current position.
+   * @param reverseBytes Decoded-frame bytes for the GOP-reverse buffer used
+   *                     when stepping or playing backward. Should cover two
+   *                     GOPs so the previous one decodes while the current
+   *                     one is shown.
+   */
+  void setPrefetch(bool enable, size_t budgetBytes, size_t reverseBytes);
+
+  /**
+   * @brief Sizes the decoded-frame store.
+   *
+   * The store holds up to @p historySec seconds of frames at the file's frame
+   * rate, limited to @p budgetBytes, but never fewer than the short-seek
+   * window so single steps stay cached even at 4K.
+   */
+  void setFrameStore(size_t budgetBytes, double historySec);
+
+  /** Occupancy and hit counters of the decoded-frame store. */
+  FrameStore::Stats getFrameStoreStats();
+
+  /** Number of frames currently held in the GOP-reverse buffer. */
+  size_t getReverseFrameCount();
 };
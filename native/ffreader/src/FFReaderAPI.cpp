@@ -1,9 +1,14 @@
 #include <algorithm>
 #include <cmath>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <tuple>
 #include <napi.h>
 #include <node.h>
 #include <opencv2/core.hpp>
@@ -18,7 +23,13 @@ extern "C"
 }
 
 #include "FFReader.hpp"
+#include "FrameConverter.hpp"
 #include "FrameUtils.hpp"
+#include "ReaderPool.hpp"
+#include "ThumbnailAtlas.hpp"
+#include "TimestampTable.hpp"
+#include "VideoTimeline.hpp"
+#include "WorkerPool.hpp"
 #include "sendMulticast.hpp"
 
 #ifdef __APPLE__
@@ -29,14 +40,135 @@ extern "C" void triggerMacOSLocalNetworkPermission();
 #include "BowNumberPipeline.hpp"
 #endif
 
+/**
+ * @brief A thumbnail atlas for one open file, loaded or built in the
+ * background.
+ *
+ * Destroying the job cancels a running build and waits for it, so closing
+ * the file never leaves a thread decoding it.
+ */
+struct ThumbnailJob
+{
+  uint32_t count = 0;
+  uint32_t thumbWidth = 0;
+  ThumbnailAtlas atlas;
+  std::atomic<bool> cancel{false};
+  std::atomic<int> progress{0};
+  std::atomic<bool> finished{false};
+  bool ok = false; ///< Valid once finished is set.
+  std::thread thread;
+
+  ~ThumbnailJob()
+  {
+    cancel = true;
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+};
+
+/**
+ * @brief The UTC time of every frame of one open file, read in the
+ * background. Destroying the job cancels the pass and waits for it.
+ */
+struct TimestampJob
+{
+  TimestampTable table;
+  std::atomic<bool> cancel{false};
+  std::atomic<int64_t> progress{0};
+  std::atomic<bool> finished{false};
+  bool ok = false; ///< Valid once finished is set.
+  std::thread thread;
+
+  ~TimestampJob()
+  {
+    cancel = true;
+    if (thread.joinable())
+    {
+      thread.join();
+    }
+  }
+};
+
 struct FileInfo
 {
   std::unique_ptr<FFVideoReader> videoReader;
+  /** Extra decoders for exact requests, see the configureReader op. */
+  ReaderPool cursors;
   uint64_t firstFrameTimestampMilli;
   uint64_t lastFrameTimestampMilli;
+  uint64_t firstTsMicro;
+  uint64_t lastTsMicro;
   int32_t numFrames;
+  std::unique_ptr<ThumbnailJob> thumbnails;
+  std::unique_ptr<TimestampJob> timestamps;
 };
 static std::map<std::string, FileInfo> fileInfoMap;
+
+/** Reverse buffer budget of configureReader's prefetch, also used by timelines. */
+static constexpr double defaultReverseMB = 256;
+
+class FileJob;
+
+/**
+ * @brief Async requests for one file, run one at a time in arrival order.
+ *
+ * Only touched on the main thread. busy is held by the request running on a
+ * worker thread and by synchronous ops that use the same FileInfo, so the
+ * two never interleave; see nativeVideoExecutorAsync().
+ */
+struct FileQueue
+{
+  std::mutex busy;
+  /** The request on a worker thread, if any. */
+  FileJob *current = nullptr;
+  std::deque<FileJob *> pending;
+  /** Async grabFramesAtTime requests using the file, see CamerasJob. */
+  int cameraJobs = 0;
+  /** Files closed while a request still used them; freed once it drains. */
+  std::vector<decltype(fileInfoMap)::node_type> closed;
+};
+static std::map<std::string, FileQueue> fileQueues;
+/** Error of a request replaced by a newer one for the same view. */
+static const std::string supersededError = "Superseded";
+
+/**
+ * @brief Locks @p file against its async requests, for the synchronous
+ * decode ops, which block their caller anyway. Waits for a request running
+ * on a worker thread.
+ */
+static std::unique_lock<std::mutex> lockFile(const std::string &file)
+{
+  return std::unique_lock<std::mutex>(fileQueues[file].busy);
+}
+
+/**
+ * @brief Like lockFile(), but returns at once without the lock while a
+ * request is running, so the main thread never waits on a decode.
+ */
+static std::unique_lock<std::mutex> tryLockFile(const std::string &file)
+{
+  return std::unique_lock<std::mutex>(fileQueues[file].busy, std::try_to_lock);
+}
+
+/** Error of a synchronous op on a file an async request is using. */
+static const std::string fileBusyError = "File busy";
+
+/** Segment files joined into one timeline, see the openTimeline op. */
+struct TimelineInfo
+{
+  VideoTimeline timeline;
+  /** Frames from a segment boundary at which the neighbour is opened. */
+  int64_t preloadFrames = 30;
+  /** Prefetch budget for segments the timeline opens; 0 disables. */
+  double prefetchMB = 64;
+  /** Segment files this timeline opened, and so may close again. */
+  std::set<std::string> opened;
+  /** Neighbouring segment files with a warm-up queued, and its frame; 0 is the last. */
+  std::map<std::string, int64_t> warmed;
+};
+static std::map<std::string, TimelineInfo> timelineMap;
 #ifdef RIFE_SUPPORTED
 // Deliberately leaked (raw pointer, never deleted): the ONNX Runtime
 // session + CoreML/DirectML EP spawn background compile/inference threads
@@ -45,45 +177,57 @@ static std::map<std::string, FileInfo> fileInfoMap;
 // These are process-lifetime singletons anyway, so we never tear them down.
 static std::map<std::string, RifeInterpolator *> rifeInterpolatorMap;
 static std::map<std::string, BowNumberPipeline *> bowNumberPipelineMap;
+// Guards both maps and the sessions in them, which requests for different
+// files may use at once.
+static std::mutex modelLock;
 #endif
 static FrameInfoList frameInfoList;
 static FrameRect noZoom = {0, 0, 0, 0};
 static std::ofstream nativeLogStream;
 static int debugLevel = 0;
 
-static int prunePixels(const Napi::Object &request, int height)
+/** Rows cut from the top or bottom of a frame, see the prune request field. */
+struct PruneRequest
+{
+  double percentage = 0;
+  bool top = false;
+};
+
+static PruneRequest readPrune(const Napi::Object &request)
 {
+  PruneRequest prune;
   if (!request.Has("prune") || !request.Get("prune").IsObject())
-    return 0;
-  const auto prune = request.Get("prune").As<Napi::Object>();
-  if (!prune.Has("percentage"))
-    return 0;
-  const double percentage = std::max(
-      0.0, std::min(95.0, prune.Get("percentage").As<Napi::Number>().DoubleValue()));
-  const int pixels = static_cast<int>(
-      std::round((height * percentage / 100.0) / 4.0) * 4.0);
-  return std::max(0, std::min(pixels, height - 4));
+    return prune;
+  const auto value = request.Get("prune").As<Napi::Object>();
+  if (!value.Has("percentage"))
+    return prune;
+  prune.percentage = std::max(
+      0.0, std::min(95.0, value.Get("percentage").As<Napi::Number>().DoubleValue()));
+  prune.top = value.Has("side") && value.Get("side").As<Napi::String>().Utf8Value() == "top";
+  return prune;
 }
 
-static bool pruneFromTop(const Napi::Object &request)
+static int prunePixels(const PruneRequest &prune, int height)
 {
-  const auto prune = request.Get("prune").As<Napi::Object>();
-  return prune.Get("side").As<Napi::String>().Utf8Value() == "top";
+  const int pixels = static_cast<int>(
+      std::round((height * prune.percentage / 100.0) / 4.0) * 4.0);
+  return std::max(0, std::min(pixels, height - 4));
 }
 
 static std::shared_ptr<FrameInfo>
-pruneFrame(const std::shared_ptr<FrameInfo> &source,
-           const Napi::Object &request)
+pruneFrame(const std::shared_ptr<FrameInfo> &source, const PruneRequest &prune)
 {
-  const int pixels = prunePixels(request, source->height);
-  if (pixels == 0)
+  const int pixels = prunePixels(prune, source->height);
+  // Without pixels there is nothing to crop; callers check rgba() themselves.
+  if (pixels == 0 || !source->rgba())
     return source;
-  const int y = pruneFromTop(request) ? pixels : 0;
+  const int y = prune.top ? pixels : 0;
   const int croppedHeight = source->height - pixels;
   const cv::Mat rgba(source->height, source->width, CV_8UC4,
-                     source->data->data(), source->linesize);
+                     source->rgba()->data(), source->linesize);
   const cv::Mat cropped = rgba(cv::Rect(0, y, source->width, croppedHeight)).clone();
   auto result = std::make_shared<FrameInfo>(*source);
+  result->source.reset();
   result->width = cropped.cols;
   result->height = cropped.rows;
   result->linesize = static_cast<int>(cropped.step);
@@ -93,6 +237,170 @@ pruneFrame(const std::shared_ptr<FrameInfo> &source,
   return result;
 }
 
+/**
+ * @brief Reads an optional {x, y, width, height} object field from @p request.
+ * @return false if the field is absent or describes an empty rect.
+ */
+static bool readRect(const Napi::Object &request, const char *field,
+                     FrameRect &rect)
+{
+  if (!request.Has(field) || !request.Get(field).IsObject())
+    return false;
+  const auto obj = request.Get(field).As<Napi::Object>();
+  rect = {obj.Get("x").As<Napi::Number>().Int32Value(),
+          obj.Get("y").As<Napi::Number>().Int32Value(),
+          obj.Get("width").As<Napi::Number>().Int32Value(),
+          obj.Get("height").As<Napi::Number>().Int32Value()};
+  return rect.width > 0 && rect.height > 0;
+}
+
+/**
+ * @brief Returns @p sourceRect of @p source scaled to outWidth x outHeight.
+ *
+ * When the entry still holds the decoded frame, the region is converted and
+ * scaled straight from its planes so no full-size RGBA frame is produced.
+ * Otherwise the existing RGBA pixels are cropped and scaled. @p sourceRect
+ * must lie within the frame.
+ */
+static std::shared_ptr<FrameInfo>
+regionFrame(const std::shared_ptr<FrameInfo> &source, FrameRect sourceRect,
+            int outWidth, int outHeight)
+{
+  if (outWidth <= 0 || outHeight <= 0)
+  {
+    outWidth = sourceRect.width;
+    outHeight = sourceRect.height;
+  }
+
+  auto result = std::make_shared<FrameInfo>(*source);
+  result->source.reset();
+  result->width = outWidth;
+  result->height = outHeight;
+  result->linesize = outWidth * 4;
+  result->totalBytes = result->linesize * outHeight;
+  result->data = std::make_shared<std::vector<uint8_t>>(result->totalBytes);
+
+  auto &converter = FrameConverter::forThread();
+  bool ok = false;
+  if (source->source)
+  {
+    ok = converter.toRGBA(source->source.get(), sourceRect.x, sourceRect.y,
+                          sourceRect.width, sourceRect.height, outWidth,
+                          outHeight, result->data->data(), result->linesize);
+  }
+  else if (source->data)
+  {
+    AVFrame *rgba = av_frame_alloc();
+    if (rgba)
+    {
+      rgba->format = AV_PIX_FMT_RGBA;
+      rgba->width = source->width;
+      rgba->height = source->height;
+      rgba->data[0] = source->data->data();
+      rgba->linesize[0] = source->linesize;
+      ok = converter.toRGBA(rgba, sourceRect.x, sourceRect.y, sourceRect.width,
+                            sourceRect.height, outWidth, outHeight,
+                            result->data->data(), result->linesize);
+      av_frame_free(&rgba);
+    }
+  }
+  return ok ? result : nullptr;
+}
+
+/**
+ * @brief Sets the frame metadata shared by every grabFrameAt response.
+ */
+static void setFrameFields(const Napi::Env &env, Napi::Object &ret,
+                           const std::shared_ptr<FrameInfo> &frameInfo)
+{
+  ret.Set("frameNum", Napi::Number::New(env, frameInfo->frameNum));
+  ret.Set("numFrames", Napi::Number::New(env, frameInfo->numFrames));
+  ret.Set("fps", Napi::Number::New(env, frameInfo->fps));
+  ret.Set("status", Napi::String::New(env, "OK"));
+  ret.Set("file", Napi::String::New(env, frameInfo->file));
+  ret.Set("timestamp", Napi::Number::New(env, frameInfo->timestamp));
+  ret.Set("tsMicro", Napi::Number::New(env, frameInfo->tsMicro));
+  Napi::Object motion = Napi::Object::New(env);
+  motion.Set("x", Napi::Number::New(env, frameInfo->motion.x));
+  motion.Set("y", Napi::Number::New(env, frameInfo->motion.y));
+  motion.Set("dt", Napi::Number::New(env, frameInfo->motion.dt));
+  motion.Set("valid", Napi::Boolean::New(env, frameInfo->motion.valid));
+  ret.Set("motion", motion);
+}
+
+/** A frame as I420 or NV12 planes in one buffer. */
+struct YUVFrame
+{
+  std::vector<uint8_t> data;
+  YUVPlanes planes;
+  bool nv12 = false;
+  bool bt709 = false;
+};
+
+/**
+ * @brief Converts the frame to I420 or NV12 planes.
+ *
+ * Works from the decoded frame held by @p frameInfo, decoding it again if
+ * the entry has already been converted to RGBA. Prune is applied by
+ * dropping rows.
+ *
+ * @return false if no decoded frame is available (e.g. interpolated
+ *         frames), in which case the caller falls back to RGBA.
+ */
+static bool yuvFrame(const std::shared_ptr<FrameInfo> &frameInfo, FFVideoReader &reader,
+                     bool closeTo, bool nv12, const PruneRequest &prune, YUVFrame &yuv)
+{
+  auto decoded = frameInfo->source;
+  if (!decoded && frameInfo->frameNum == std::floor(frameInfo->frameNum))
+  {
+    decoded = reader.getDecodedFrame((int64_t)frameInfo->frameNum, closeTo);
+  }
+  if (!decoded)
+  {
+    return false;
+  }
+
+  const int pixels = prunePixels(prune, decoded->height);
+  const int top = pixels > 0 && prune.top ? pixels : 0;
+  if (!FrameConverter::forThread().toYUV420(decoded.get(), nv12, top,
+                                            decoded->height - pixels, yuv.data, yuv.planes))
+  {
+    yuv.data.clear();
+    return false;
+  }
+  yuv.nv12 = nv12;
+  // Streams that don't declare BT.709 are treated as BT.601, as the RGBA
+  // path does.
+  yuv.bt709 = decoded->colorspace == AVCOL_SPC_BT709;
+  return true;
+}
+
+/**
+ * @brief Sets the pixel fields of a planar grabFrameAt response.
+ */
+static void setYUVFields(const Napi::Env &env, Napi::Object &ret, const YUVFrame &yuv)
+{
+  const auto &planes = yuv.planes;
+  Napi::Array planeArray = Napi::Array::New(env, planes.count);
+  for (int i = 0; i < planes.count; i++)
+  {
+    Napi::Object plane = Napi::Object::New(env);
+    plane.Set("offset", Napi::Number::New(env, planes.offset[i]));
+    plane.Set("stride", Napi::Number::New(env, planes.stride[i]));
+    plane.Set("width", Napi::Number::New(env, planes.width[i]));
+    plane.Set("height", Napi::Number::New(env, planes.height[i]));
+    planeArray.Set((uint32_t)i, plane);
+  }
+  ret.Set("data", Napi::Buffer<uint8_t>::Copy(env, yuv.data.data(), yuv.data.size()));
+  ret.Set("width", Napi::Number::New(env, planes.width[0]));
+  ret.Set("height", Napi::Number::New(env, planes.height[0]));
+  ret.Set("totalBytes", Napi::Number::New(env, (double)yuv.data.size()));
+  ret.Set("format", Napi::String::New(env, yuv.nv12 ? "nv12" : "i420"));
+  ret.Set("planes", planeArray);
+  ret.Set("colorMatrix", Napi::String::New(env, yuv.bt709 ? "bt709" : "bt601"));
+  ret.Set("colorRange", Napi::String::New(env, planes.fullRange ? "full" : "limited"));
+}
+
 /**
  * @brief Extract a 64-bit 100ns UTC timestamp from the video frame.
  * The timestamp is encoded in the row as two pixels per bit with each bit being
@@ -136,6 +444,91 @@ uint64_t extractTimestampFromFrame(const std::vector<uint8_t> &image, int row,
   return number; // Return the timestamp in milliseconds
 }
 
+/**
+ * @brief UTC microseconds of a frame whose time comes from the container's
+ * UTC anchor rather than its pixels.
+ */
+static uint64_t containerTsMicro(const std::unique_ptr<FFVideoReader> &ffreader,
+                                 int64_t pts, AVRational timeBase)
+{
+  return ffreader->getFirstUtcUs() + 1000000 * pts * timeBase.num / timeBase.den;
+}
+
+/**
+ * @brief Fills the size, rate and timestamp fields of @p frame from the
+ * decoded frame it wraps.
+ */
+static void setDecodedFields(FrameInfo &frame, const std::shared_ptr<AVFrame> &decoded,
+                             const std::unique_ptr<FFVideoReader> &ffreader,
+                             double frameNum)
+{
+  frame.width = decoded->width;
+  frame.height = decoded->height;
+  frame.fps = ffreader->getFps();
+  frame.numFrames = ffreader->getTotalFrames();
+  frame.totalBytes = decoded->width * decoded->height * 4;
+  frame.linesize = decoded->width * 4;
+  frame.source = decoded;
+  frame.motion = {0, 0, 0, false};
+  if (ffreader->getFirstUtcUs() != 0)
+  {
+    // std::cerr << "Using first_utc_us from video: " << ffreader->getFirstUtcUs() << std::endl;
+    auto tsMicro = containerTsMicro(ffreader, decoded->pts, decoded->time_base);
+    frame.tsMicro = tsMicro;
+    frame.timestamp = (tsMicro + 500) / 1000;
+    // std::cerr << "timestamp ms: " << frame.timestamp << " pts: " << decoded->pts << std::endl;
+  }
+  else
+  {
+    // The timestamp is encoded in the first 128 pixels of row 0 or 1.
+    const int stripWidth = std::min(decoded->width, 128);
+    std::vector<uint8_t> strip((size_t)stripWidth * 2 * 4);
+    uint64_t timestamp100ns = 0;
+    if (stripWidth == 128 && decoded->height >= 2 &&
+        FrameConverter::forThread().toRGBA(decoded.get(), 0, 0, stripWidth, 2,
+                                           strip.data(), stripWidth * 4))
+    {
+      timestamp100ns = extractTimestampFromFrame(strip, 0, stripWidth);
+    }
+    auto tsMilli =
+        (5000 + timestamp100ns) / 10000; // Round 64-bit number to milliseconds
+    auto tsMicro = (5 + timestamp100ns) / 10;
+
+    if (tsMicro == 0)
+    {
+      tsMilli = uint64_t(0.5 + ((frameNum - 1) * 1000) / (frame.fps));
+    }
+    frame.tsMicro = tsMicro;
+    frame.timestamp = tsMilli;
+  }
+}
+
+/**
+ * @brief Decodes a frame into a new FrameInfo without touching the frame
+ * cache, so it is safe off the main thread.
+ */
+static std::shared_ptr<FrameInfo>
+decodeFrameInfo(const std::unique_ptr<FFVideoReader> &ffreader,
+                const std::string &filename, double frameNum, bool closeTo = false)
+{
+  auto decoded = ffreader->getDecodedFrame(frameNum, closeTo);
+  if (!decoded)
+  {
+    return nullptr;
+  }
+  auto frame = std::make_shared<FrameInfo>(frameNum, filename, closeTo);
+  setDecodedFields(*frame, decoded, ffreader, frameNum);
+  return frame;
+}
+
+/**
+ * @brief Returns frame info for a frame, decoding it if not cached.
+ *
+ * The entry keeps the decoded frame in its native format; RGBA is produced
+ * by FrameInfo::rgba() only when a caller needs pixels. Timestamps come from
+ * the container pts or, for pixel-encoded timestamps, from converting just
+ * the two timestamp rows.
+ */
 static std::shared_ptr<FrameInfo>
 getFrame(const std::unique_ptr<FFVideoReader> &ffreader,
          const std::string &filename, double frameNum, bool closeTo = false)
@@ -146,68 +539,232 @@ getFrame(const std::unique_ptr<FFVideoReader> &ffreader,
   {
     // std::cout << "Reading frame: " << key << " frameNum: " << frameNum
     //           << std::endl;
-    auto rgbaFrame = ffreader->getRGBAFrame(frameNum, closeTo);
-    if (!rgbaFrame)
+    frame = decodeFrameInfo(ffreader, filename, frameNum, closeTo);
+    if (!frame)
     {
       return nullptr;
     }
-    auto totalBytes = rgbaFrame->height * rgbaFrame->width * 4;
-    auto linesize = rgbaFrame->linesize[0];
-    auto pixbytes = rgbaFrame->width * 4;
-    if (pixbytes != linesize)
-    {
-      // remove extra bytes at the end of each frame line as
-      // the html canvas expects compacted data
-      uint8_t *destdata = rgbaFrame->data[0] + pixbytes;
-      uint8_t *srcdata = rgbaFrame->data[0] + linesize;
-      for (int i = 1; i < rgbaFrame->height; i++)
-      {
-        memcpy(destdata, srcdata, pixbytes);
-        destdata += pixbytes;
-        srcdata += linesize;
-      }
-    }
 
     // Add Frame to cache
-    frame = std::make_shared<FrameInfo>(frameNum, filename, closeTo);
-    frame->width = rgbaFrame->width;
-    frame->height = rgbaFrame->height;
-    frame->fps = ffreader->getFps();
-    frame->numFrames = ffreader->getTotalFrames();
-    frame->totalBytes = totalBytes;
-    frame->linesize = pixbytes;
-    frame->data = std::make_shared<std::vector<std::uint8_t>>(
-        rgbaFrame->data[0], rgbaFrame->data[0] + totalBytes);
-    frame->motion = {0, 0, 0, false};
-    if (ffreader->getFirstUtcUs() != 0)
-    {
-      // std::cerr << "Using first_utc_us from video: " << ffreader->getFirstUtcUs() << std::endl;
-      auto tsMicro = ffreader->getFirstUtcUs() + 1000000 * rgbaFrame->pts * rgbaFrame->time_base.num / rgbaFrame->time_base.den;
-      frame->tsMicro = tsMicro;
-      frame->timestamp = (tsMicro + 500) / 1000;
-      // std::cerr << "timestamp ms: " << frame->timestamp << " pts: " << rgbaFrame->pts << std::endl;
+    frameInfoList.addFrame(frame);
+  }
+  return frame;
+}
+
+/**
+ * @brief Returns frame info for a frame of an open file, decoding it on
+ * whichever of the file's cursors reaches it most cheaply if not cached.
+ */
+static std::shared_ptr<FrameInfo>
+getFrame(FileInfo &fileInfo, const std::string &filename, double frameNum,
+         bool closeTo = false)
+{
+  // Keyframe previews use the scrub decoder and leave every cursor in place.
+  if (closeTo ||
+      frameInfoList.getFrame(formatKey(filename, frameNum, false, {0, 0, 0, 0}, false)))
+  {
+    return getFrame(fileInfo.videoReader, filename, frameNum, closeTo);
+  }
+  const auto &reader = fileInfo.cursors.select(fileInfo.videoReader, (int64_t)frameNum);
+  return getFrame(reader, filename, frameNum, closeTo);
+}
+
+/**
+ * @brief Decodes the uncached frames among @p frameNums of an intra-only file
+ * in one parallel batch and adds them to the frame cache, so the getFrame()
+ * calls that follow are cache hits.
+ */
+static void preloadIntraFrames(FileInfo &fileInfo, const std::string &filename,
+                               const std::vector<int64_t> &frameNums)
+{
+  auto &ffreader = fileInfo.videoReader;
+  std::vector<int64_t> missing;
+  for (auto frameNum : frameNums)
+  {
+    if (!frameInfoList.getFrame(formatKey(filename, frameNum, false, {0, 0, 0, 0}, false)))
+    {
+      missing.push_back(frameNum);
     }
-    else
+  }
+  if (!ffreader->isIntraOnly() || missing.size() < 2)
+  {
+    return;
+  }
+  const auto decoded = ffreader->getIntraFrames(missing);
+  for (size_t i = 0; i < missing.size(); i++)
+  {
+    if (decoded[i])
     {
+      auto frame = std::make_shared<FrameInfo>(missing[i], filename, false);
+      setDecodedFields(*frame, decoded[i], ffreader, missing[i]);
+      frameInfoList.addFrame(frame);
+    }
+  }
+}
 
-      auto timestamp100ns =
-          extractTimestampFromFrame(*frame->data, 0, rgbaFrame->width);
-      auto tsMilli =
-          (5000 + timestamp100ns) / 10000; // Round 64-bit number to milliseconds
-      auto tsMicro = (5 + timestamp100ns) / 10;
+/**
+ * @brief Returns a keyframe preview for @p frameNum, decoding it if not cached.
+ *
+ * The keyframe at or before the frame is decoded on the reader's scrub
+ * decoder and, when wider than @p maxWidth, scaled down preserving aspect.
+ * Requests landing on the same keyframe share one cache entry.
+ */
+static std::shared_ptr<FrameInfo>
+scrubFrame(const std::unique_ptr<FFVideoReader> &ffreader,
+           const std::string &filename, double frameNum, int maxWidth)
+{
+  const int64_t keyframe = ffreader->getKeyframeNumber(std::llround(frameNum));
+  if (keyframe < 1)
+  {
+    return nullptr;
+  }
+  const auto key = filename + "-scrub-" + std::to_string(keyframe) + "-" +
+                   std::to_string(maxWidth);
+  auto frame = frameInfoList.getFrame(key);
+  if (frame)
+  {
+    return frame;
+  }
 
-      if (tsMicro == 0)
-      {
-        tsMilli = uint64_t(0.5 + ((frameNum - 1) * 1000) / (frame->fps));
-      }
-      frame->tsMicro = tsMicro;
-      frame->timestamp = tsMilli;
+  // Timestamps drawn into the pixels only survive a full-size decode.
+  const int decodeWidth = ffreader->getFirstUtcUs() != 0 ? maxWidth : 0;
+  auto decoded = ffreader->getScrubFrame(keyframe, decodeWidth);
+  if (!decoded)
+  {
+    return nullptr;
+  }
+  frame = std::make_shared<FrameInfo>(keyframe, filename, true);
+  setDecodedFields(*frame, decoded, ffreader, keyframe);
+  if (maxWidth > 0 && frame->width > maxWidth)
+  {
+    const int outHeight =
+        std::max(1, (int)std::lround((double)frame->height * maxWidth / frame->width));
+    frame = regionFrame(frame, {0, 0, frame->width, frame->height}, maxWidth,
+                        outHeight);
+    if (!frame)
+    {
+      return nullptr;
     }
-    frameInfoList.addFrame(frame);
   }
+  frame->key = key;
+  frameInfoList.addFrame(frame);
   return frame;
 }
 
+/**
+ * @brief Reads the extent of an opened file without decoding its tail.
+ *
+ * A summary from the index cache is trusted as is. Otherwise the frame
+ * count and last pts come from the frame index, and frame 1 is decoded only
+ * when the UTC anchor comes from its pixels; the last frame is then placed
+ * by its pts distance from frame 1. The result is saved to the index cache.
+ *
+ * @param cacheFrames Keep a decoded frame 1 in the frame cache. Safe from
+ *                    any thread; FrameInfoList guards itself. Probes pass
+ *                    false because they throw the reader away.
+ * @return false if there is no frame index or frame 1 cannot be decoded.
+ */
+static bool readFastExtent(const std::unique_ptr<FFVideoReader> &ffreader,
+                           const std::string &file, bool cacheFrames,
+                           VideoIndexSummary &extent)
+{
+  const auto *cached = ffreader->getCachedSummary();
+  if (cached && cached->numFrames > 0)
+  {
+    // The cache is keyed on the file's size and mtime.
+    extent = *cached;
+    return true;
+  }
+
+  int64_t lastFrameNumber = 0;
+  int64_t firstPts = 0;
+  int64_t lastPts = 0;
+  if (!ffreader->getIndexedExtent(lastFrameNumber, firstPts, lastPts))
+  {
+    return false;
+  }
+  const AVRational timeBase = ffreader->getTimeBase();
+  extent = VideoIndexSummary();
+  extent.numFrames = std::min(lastFrameNumber, ffreader->getTotalFrames());
+  extent.firstUtcUs = ffreader->getFirstUtcUs();
+  if (extent.firstUtcUs != 0)
+  {
+    extent.firstTsMicro = containerTsMicro(ffreader, firstPts, timeBase);
+    extent.lastTsMicro = containerTsMicro(ffreader, lastPts, timeBase);
+    extent.firstFrameTimestampMilli = (extent.firstTsMicro + 500) / 1000;
+    extent.lastFrameTimestampMilli = (extent.lastTsMicro + 500) / 1000;
+  }
+  else
+  {
+    auto frameA = cacheFrames ? getFrame(ffreader, file, 1)
+                              : decodeFrameInfo(ffreader, file, 1);
+    if (!frameA)
+    {
+      return false;
+    }
+    const uint64_t spanMicro =
+        (uint64_t)(1000000 * (lastPts - firstPts) * timeBase.num / timeBase.den);
+    extent.firstTsMicro = frameA->tsMicro;
+    extent.lastTsMicro = frameA->tsMicro ? frameA->tsMicro + spanMicro : 0;
+    extent.firstFrameTimestampMilli = frameA->timestamp;
+    extent.lastFrameTimestampMilli = frameA->timestamp + (spanMicro + 500) / 1000;
+  }
+  ffreader->saveIndexCache(extent);
+  return true;
+}
+
+/** Outcome of probing one file for the probeFiles op. */
+struct FileProbe
+{
+  std::string error; ///< Empty on success.
+  double fps = 0;
+  int width = 0;
+  int height = 0;
+  bool exact = true; ///< False when the extent is estimated from the duration.
+  VideoIndexSummary extent;
+};
+
+/**
+ * @brief Opens @p file on a private reader and reads its extent.
+ *
+ * Safe off the main thread: nothing touches the frame cache or the readers
+ * of open files. Files without a frame index get an extent estimated from
+ * the container duration and frame rate.
+ */
+static FileProbe probeFile(const std::string &file)
+{
+  FileProbe probe;
+  std::unique_ptr<FFVideoReader> ffreader(new FFVideoReader());
+  ffreader->setHardwareDecode(false);
+  if (ffreader->openFile(file, false))
+  {
+    probe.error = "Failed to open file";
+    return probe;
+  }
+  probe.fps = ffreader->getFps();
+  probe.width = ffreader->getWidth();
+  probe.height = ffreader->getHeight();
+  if (!readFastExtent(ffreader, file, false, probe.extent))
+  {
+    auto frameA = decodeFrameInfo(ffreader, file, 1);
+    if (!frameA)
+    {
+      probe.error = "Unable to get first frame info";
+      return probe;
+    }
+    const uint64_t spanMicro =
+        (uint64_t)(1000000.0 * (frameA->numFrames - 1) / std::max(probe.fps, 1e-6));
+    probe.exact = false;
+    probe.extent.numFrames = frameA->numFrames;
+    probe.extent.firstTsMicro = frameA->tsMicro;
+    probe.extent.lastTsMicro = frameA->tsMicro ? frameA->tsMicro + spanMicro : 0;
+    probe.extent.firstFrameTimestampMilli = frameA->timestamp;
+    probe.extent.lastFrameTimestampMilli = frameA->timestamp + (spanMicro + 500) / 1000;
+  }
+  ffreader->closeFile();
+  return probe;
+}
+
 // Use 0 based indexing. getFrame() uses 1 based
 static std::shared_ptr<FrameInfo>
 getFrame0(const std::unique_ptr<FFVideoReader> &ffreader,
@@ -220,6 +777,104 @@ getFrame0(const std::unique_ptr<FFVideoReader> &ffreader,
   return getFrame(ffreader, filename, frameNum + 1, closeTo);
 }
 
+/**
+ * @brief Finds the last frame that can actually be decoded.
+ *
+ * The container's frame count can overshoot what is readable, so probe
+ * backward from @p numFrames.
+ *
+ * @return The last readable frame, or nullptr if none was found within the
+ *         probe window.
+ */
+static std::shared_ptr<FrameInfo>
+getLastFrame(const std::unique_ptr<FFVideoReader> &ffreader,
+             const std::string &file, int numFrames)
+{
+  // With a frame index the count is exact and the first probe succeeds
+  // unless the file is truncated. Without one, on VFR files r_frame_rate
+  // can disagree with nb_frames / duration by up to ~1%, so the last
+  // requestable frame index (via dts_to_frame_number = fps * seconds) can
+  // fall short of nb_frames by up to 1% of nb_frames.
+  // Allow retries over that window (with a floor of 200 for short clips).
+  std::shared_ptr<FrameInfo> frameB;
+  const int maxBack =
+      std::max(200, static_cast<int>(numFrames / 50)); // up to 2%
+  // Exponential probe to find any reachable back-offset, then bisect to
+  // find the smallest passing back. Each getFrame() failure near EOF is
+  // expensive (full av_seek_frame + forward-decode), so linear walkback
+  // is O(maxBack) seeks — this is O(log maxBack).
+  int lo = -1; // largest known-failing back (-1 = none tried)
+  int hi = -1; // smallest known-passing back (-1 = none found)
+  for (int probe = 0; probe <= maxBack; probe = probe == 0 ? 1 : probe * 2)
+  {
+    auto f = getFrame(ffreader, file, numFrames - probe);
+    if (f)
+    {
+      frameB = f;
+      hi = probe;
+      break;
+    }
+    lo = probe;
+    if (probe == 0)
+    {
+      std::cerr << "Unable to read frame " << numFrames
+                << ". Walking back up to " << maxBack << " frames..."
+                << std::endl;
+    }
+    if (probe >= maxBack) break;
+  }
+  while (lo >= 0 && hi - lo > 1)
+  {
+    int mid = lo + (hi - lo) / 2;
+    auto f = getFrame(ffreader, file, numFrames - mid);
+    if (f)
+    {
+      frameB = f;
+      hi = mid;
+    }
+    else
+    {
+      lo = mid;
+    }
+  }
+  return frameB;
+}
+
+/**
+ * @brief Returns the timestamp table of a file once its background pass has
+ * finished.
+ *
+ * The first call starts the pass, so only files that are searched by time
+ * pay for it; until it is done callers fall back to findBoundingFrames().
+ */
+static const TimestampTable *timestampTableFor(FileInfo &fileInfo, const std::string &file)
+{
+  auto &job = fileInfo.timestamps;
+  if (!job)
+  {
+    job = std::make_unique<TimestampJob>();
+    TimestampPlan plan;
+    plan.videoFile = file;
+    plan.streamIndex = fileInfo.videoReader->getVideoStreamIndex();
+    plan.firstUtcUs = fileInfo.videoReader->getFirstUtcUs();
+    if (plan.firstUtcUs == 0)
+    {
+      // Reading the pixels decodes the whole file; split it across half the
+      // cores, leaving the rest for playback.
+      plan.index = fileInfo.videoReader->copyFrameIndex();
+      plan.ptsOffset = fileInfo.videoReader->getIndexOffset();
+      plan.decodeWorkers = (int)std::max(1u, std::thread::hardware_concurrency() / 2);
+    }
+    auto build = [target = job.get(), plan = std::move(plan)]()
+    {
+      target->ok = target->table.build(plan, target->cancel, target->progress);
+      target->finished = true;
+    };
+    job->thread = std::thread(build);
+  }
+  return job->finished && job->ok ? &job->table : nullptr;
+}
+
 /**
  * @brief Finds the two adjacent video frames that bound a given timestamp.
  *
@@ -245,6 +900,7 @@ getFrame0(const std::unique_ptr<FFVideoReader> &ffreader,
  *                         Can be computed as:
  *                             guessIndex ≈ (desiredTimestamp - startTimestamp) * fps / 1000
  * @param numFrames        Total number of frames in the video
+ * @param cached           False to decode without the frame cache, for use off the main thread.
  *
  * @return A pair of std::shared_ptr<FrameInfo> {A, B}, such that A->timestamp <= desiredTimestamp < B->timestamp.
  *         Returns {nullptr, nullptr} if input is invalid or bounding frames could not be found.
@@ -255,11 +911,19 @@ getFrame0(const std::unique_ptr<FFVideoReader> &ffreader,
 std::pair<std::shared_ptr<FrameInfo>, std::shared_ptr<FrameInfo>>
 findBoundingFrames(const std::unique_ptr<FFVideoReader> &ffreader,
                    const std::string &filename, uint64_t desiredTimestamp,
-                   size_t guessIndex, size_t numFrames)
+                   size_t guessIndex, size_t numFrames, bool cached = true)
 {
   guessIndex = std::min(std::max(guessIndex, size_t(0)), numFrames - 2);
 
-  auto guessFrame = getFrame0(ffreader, filename, guessIndex);
+  // Off the main thread the frame cache must not be touched; the reader's
+  // own frame store still makes repeated probes of a frame cheap.
+  auto frameAt = [&](size_t index)
+  {
+    return cached ? getFrame0(ffreader, filename, index)
+                  : decodeFrameInfo(ffreader, filename, index + 1.0);
+  };
+
+  auto guessFrame = frameAt(guessIndex);
   if (!guessFrame)
     return {nullptr, nullptr};
 
@@ -269,7 +933,7 @@ findBoundingFrames(const std::unique_ptr<FFVideoReader> &ffreader,
   {
     low = guessIndex;
     high = guessIndex + 1;
-    auto highFrame = getFrame0(ffreader, filename, high);
+    auto highFrame = frameAt(high);
     uint64_t lastTimestamp = guessFrame->timestamp;
     while (high < numFrames && highFrame && highFrame->timestamp <= desiredTimestamp)
     {
@@ -278,7 +942,7 @@ findBoundingFrames(const std::unique_ptr<FFVideoReader> &ffreader,
       lastTimestamp = highFrame->timestamp;
       low = high;
       high = std::min(numFrames - 1, high + (high - guessIndex + 1));
-      highFrame = getFrame0(ffreader, filename, high);
+      highFrame = frameAt(high);
     }
   }
   // Gallop backward
@@ -286,7 +950,7 @@ findBoundingFrames(const std::unique_ptr<FFVideoReader> &ffreader,
   {
     high = guessIndex;
     low = (guessIndex > 0) ? guessIndex - 1 : 0;
-    auto lowFrame = getFrame0(ffreader, filename, low);
+    auto lowFrame = frameAt(low);
     uint64_t lastTimestamp = guessFrame->timestamp;
     while (low > 0 && lowFrame && lowFrame->timestamp > desiredTimestamp)
     {
@@ -295,7 +959,7 @@ findBoundingFrames(const std::unique_ptr<FFVideoReader> &ffreader,
       lastTimestamp = lowFrame->timestamp;
       high = low;
       low = (low > 2 * (guessIndex - low + 1)) ? low - 2 * (guessIndex - low + 1) : 0;
-      lowFrame = getFrame0(ffreader, filename, low);
+      lowFrame = frameAt(low);
     }
   }
 
@@ -303,7 +967,7 @@ findBoundingFrames(const std::unique_ptr<FFVideoReader> &ffreader,
   while (low + 1 < high)
   {
     size_t mid = (low + high) / 2;
-    auto midFrame = getFrame0(ffreader, filename, mid);
+    auto midFrame = frameAt(mid);
     if (!midFrame)
       break; // corrupted frame
     if (midFrame->timestamp <= desiredTimestamp)
@@ -312,17 +976,1707 @@ findBoundingFrames(const std::unique_ptr<FFVideoReader> &ffreader,
       high = mid;
   }
 
-  auto A = getFrame0(ffreader, filename, low);
-  auto B = getFrame0(ffreader, filename, std::min(low + 1, numFrames - 1));
+  auto A = frameAt(low);
+  auto B = frameAt(std::min(low + 1, numFrames - 1));
   if (!A || !B)
     return {nullptr, nullptr};
   return {A, B};
 }
 
-Napi::Object nativeVideoExecutor(const Napi::CallbackInfo &info)
+/**
+ * @brief Opens @p file and reads its extent into @p info, without touching
+ * fileInfoMap, so it can run on a worker thread.
+ *
+ * @param fast Read the extent from the frame index instead of decoding
+ *             backward from the end; see the openFile op.
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string buildFileInfo(const std::string &file, bool fast, FileIOMode ioMode,
+                                 size_t readAheadBytes, FileInfo &info)
 {
-  // std::cerr << "nativeVideoExecutor add-on" << std::endl;
-
+  std::unique_ptr<FFVideoReader> ffreader(new FFVideoReader());
+  ffreader->setFileIO(ioMode, readAheadBytes);
+  if (ffreader->openFile(file, !fast))
+  {
+    return "Failed to open file";
+  }
+
+  const auto *cached = ffreader->getCachedSummary();
+  VideoIndexSummary extent;
+  if (!fast || !readFastExtent(ffreader, file, true, extent))
+  {
+    auto frameA = getFrame(ffreader, file, 1);
+    if (!frameA)
+    {
+      return "Unable to get first frame info";
+    }
+    // The index cache remembers the last readable frame from a previous
+    // session, so the backward probe is only needed the first time.
+    const bool useCache = cached && cached->numFrames > 0 &&
+                          cached->firstTsMicro == frameA->tsMicro;
+    if (useCache)
+    {
+      extent = *cached;
+    }
+    else
+    {
+      auto frameB = getLastFrame(ffreader, file, frameA->numFrames);
+      if (!frameB)
+      {
+        return "Unable to get last frame info";
+      }
+      // std::cerr << "timestamps = " << frameA->timestamp << "," << frameA->tsMicro << " - " << frameB->timestamp << "," << frameB->tsMicro << std::endl;
+      extent.numFrames = frameB->frameNum;
+      extent.firstFrameTimestampMilli = frameA->timestamp;
+      extent.lastFrameTimestampMilli = frameB->timestamp;
+      extent.firstTsMicro = frameA->tsMicro;
+      extent.lastTsMicro = frameB->tsMicro;
+      extent.firstUtcUs = ffreader->getFirstUtcUs();
+      ffreader->saveIndexCache(extent);
+    }
+  }
+
+  // Fill in the FileInfo struct
+  info.videoReader = std::move(ffreader);
+  info.firstFrameTimestampMilli = extent.firstFrameTimestampMilli;
+  info.lastFrameTimestampMilli = extent.lastFrameTimestampMilli;
+  info.firstTsMicro = extent.firstTsMicro;
+  info.lastTsMicro = extent.lastTsMicro;
+  info.numFrames = (int32_t)extent.numFrames;
+  return "";
+}
+
+/**
+ * @brief Opens @p file and adds it to fileInfoMap.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string openFileInfo(const std::string &file, bool fast, FileIOMode ioMode,
+                                size_t readAheadBytes)
+{
+  FileInfo info;
+  auto error = buildFileInfo(file, fast, ioMode, readAheadBytes, info);
+  if (!error.empty())
+  {
+    return error;
+  }
+  // Insert into the map with a filename as the key
+  fileInfoMap[file] = std::move(info);
+  return "";
+}
+
+/**
+ * @brief Sets the extent fields of an openFile response. The extent lets
+ * callers size the timeline without probing frames.
+ */
+static void setExtentFields(const Napi::Env &env, Napi::Object &ret, const FileInfo &fileInfo)
+{
+  ret.Set("numFrames", Napi::Number::New(env, fileInfo.numFrames));
+  ret.Set("firstTimestamp", Napi::Number::New(env, fileInfo.firstFrameTimestampMilli));
+  ret.Set("lastTimestamp", Napi::Number::New(env, fileInfo.lastFrameTimestampMilli));
+  ret.Set("firstTsMicro", Napi::Number::New(env, fileInfo.firstTsMicro));
+  ret.Set("lastTsMicro", Napi::Number::New(env, fileInfo.lastTsMicro));
+}
+
+/** An openFile request, read from its JS object on the main thread. */
+struct OpenRequest
+{
+  std::string file;
+  bool fast = false;
+  FileIOMode ioMode = FileIOMode::Default;
+  size_t readAheadBytes = 0;
+};
+
+/**
+ * @brief Reads the arguments of the openFile op.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string readOpenRequest(const Napi::Object &args, OpenRequest &open)
+{
+  if (!args.Has("file"))
+  {
+    return "Missing file field";
+  }
+  open.file = args.Get("file").As<Napi::String>().Utf8Value();
+
+  // Fast open reads the extent from the frame index instead of decoding
+  // backward from the end, and decodes frame 1 only when the UTC anchor
+  // has to come from its pixels.
+  open.fast = args.Has("fast") && args.Get("fast").As<Napi::Boolean>().Value();
+
+  // Optional I/O layer: 'readahead' reads readAheadMB at a time with
+  // access hints, 'mmap' reads from a mapping of the file.
+  if (args.Has("io"))
+  {
+    const auto io = args.Get("io").As<Napi::String>().Utf8Value();
+    if (io == "readahead")
+    {
+      open.ioMode = FileIOMode::ReadAhead;
+    }
+    else if (io == "mmap")
+    {
+      open.ioMode = FileIOMode::Mapped;
+    }
+    else if (io != "default")
+    {
+      return "io must be 'default', 'readahead' or 'mmap'";
+    }
+  }
+  double readAheadMB = 4;
+  if (args.Has("readAheadMB"))
+  {
+    readAheadMB = std::clamp(args.Get("readAheadMB").As<Napi::Number>().DoubleValue(),
+                             0.0625, 64.0);
+  }
+  open.readAheadBytes = (size_t)(readAheadMB * 1024 * 1024);
+  return "";
+}
+
+/**
+ * @brief Closes an open file, waiting for its background work first.
+ */
+static void closeFileInfo(const std::string &file)
+{
+  auto it = fileInfoMap.find(file);
+  if (it == fileInfoMap.end())
+  {
+    return;
+  }
+  auto queue = fileQueues.find(file);
+  if (queue != fileQueues.end() && (queue->second.current || queue->second.cameraJobs > 0))
+  {
+    // Queued requests hold a pointer to the FileInfo. Extracting keeps it
+    // in place, off the map, until they have run.
+    queue->second.closed.push_back(fileInfoMap.extract(it));
+    return;
+  }
+  if (queue != fileQueues.end())
+  {
+    fileQueues.erase(queue);
+  }
+  it->second.videoReader->closeFile();
+  fileInfoMap.erase(it);
+}
+
+/** A timeline segment that a job opens on its worker thread. */
+struct SegmentOpen
+{
+  std::string timeline;
+  size_t segment = 0;
+  std::string file;
+  /** The timeline's prefetch budget; 0 disables. */
+  double prefetchMB = 0;
+  FileInfo info;
+  bool opened = false;
+};
+
+/**
+ * @brief Opens the segment of @p open into its info. Touches no JS values
+ * or shared maps, so it can run on a worker thread.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string openSegment(SegmentOpen &open)
+{
+  auto error = buildFileInfo(open.file, true, FileIOMode::Default, 0, open.info);
+  if (!error.empty())
+  {
+    return error;
+  }
+  if (open.prefetchMB > 0)
+  {
+    const auto prefetchBytes = static_cast<size_t>(open.prefetchMB * 1024 * 1024);
+    const auto reverseBytes = static_cast<size_t>(defaultReverseMB * 1024 * 1024);
+    open.info.videoReader->setPrefetch(true, prefetchBytes, reverseBytes);
+    open.info.cursors.setPrefetch(true, prefetchBytes, reverseBytes);
+  }
+  open.opened = true;
+  return "";
+}
+
+/**
+ * @brief Adds a segment opened by openSegment() to fileInfoMap and its
+ * timeline. An open of the same file that got there first wins, and a
+ * timeline closed meanwhile leaves the segment with @p open, to be dropped.
+ *
+ * @return The FileInfo that serves the segment's file.
+ */
+static FileInfo *adoptSegment(SegmentOpen &open)
+{
+  auto it = fileInfoMap.find(open.file);
+  if (it != fileInfoMap.end())
+  {
+    return &it->second;
+  }
+  auto timelineIt = timelineMap.find(open.timeline);
+  if (timelineIt == timelineMap.end())
+  {
+    return &open.info;
+  }
+  auto &timeline = timelineIt->second;
+  const auto &segments = timeline.timeline.segments();
+  if (open.segment >= segments.size() || segments[open.segment].file != open.file)
+  {
+    return &open.info;
+  }
+  it = fileInfoMap.emplace(open.file, std::move(open.info)).first;
+  timeline.opened.insert(open.file);
+  // The probe estimates the extent of files without a frame index; the
+  // reader's count is what grabFrameAt serves.
+  timeline.timeline.setSegmentFrames(open.segment, it->second.numFrames);
+  return &it->second;
+}
+
+/**
+ * @brief Queues a background decode of @p frameNum of a segment file, 0
+ * meaning its last frame, so the reader's frame store already holds it, and
+ * its decoder sits there, when a request for it arrives. Opens the segment
+ * first when @p open is set. Defined with the async jobs.
+ */
+static void queueWarmup(const Napi::Env &env, const std::string &file,
+                        std::unique_ptr<SegmentOpen> open, int64_t frameNum);
+
+/**
+ * @brief Readies the segment that serves a request.
+ *
+ * An open segment's frame count is refreshed; otherwise @p open is set for
+ * the request's job to open it on its worker thread. Within preloadFrames
+ * of either end, the neighbouring segment is opened and the frame across
+ * the boundary decoded, both in the background. Segments the timeline
+ * opened that are no longer needed are closed.
+ */
+static void useTimelineSegment(const Napi::Env &env, const std::string &id,
+                               TimelineInfo &timeline, size_t segment, double localFrame,
+                               std::unique_ptr<SegmentOpen> &open)
+{
+  auto segmentOpen = [&](size_t index)
+  {
+    std::unique_ptr<SegmentOpen> next;
+    const auto &file = timeline.timeline.segments()[index].file;
+    auto it = fileInfoMap.find(file);
+    if (it != fileInfoMap.end())
+    {
+      // Picks up growth found by refreshFile.
+      timeline.timeline.setSegmentFrames(index, it->second.numFrames);
+      return next;
+    }
+    next = std::make_unique<SegmentOpen>();
+    next->timeline = id;
+    next->segment = index;
+    next->file = file;
+    next->prefetchMB = timeline.prefetchMB;
+    return next;
+  };
+  open = segmentOpen(segment);
+
+  const auto &segments = timeline.timeline.segments();
+  std::set<std::string> keep = {segments[segment].file};
+  auto preload = [&](size_t neighbour, bool last)
+  {
+    const auto &file = segments[neighbour].file;
+    keep.insert(file);
+    // A segment is approached from either end, so a new frame replaces the
+    // queued warm-up of the other.
+    const int64_t frameNum = last ? 0 : 1;
+    auto warmed = timeline.warmed.find(file);
+    if (warmed != timeline.warmed.end() && warmed->second == frameNum)
+    {
+      return;
+    }
+    timeline.warmed[file] = frameNum;
+    queueWarmup(env, file, segmentOpen(neighbour), frameNum);
+  };
+  if (segment + 1 < segments.size() &&
+      localFrame > segments[segment].numFrames - timeline.preloadFrames)
+  {
+    preload(segment + 1, false);
+  }
+  if (segment > 0 && localFrame <= timeline.preloadFrames)
+  {
+    preload(segment - 1, true);
+  }
+
+  for (auto it = timeline.warmed.begin(); it != timeline.warmed.end();)
+  {
+    it = keep.count(it->first) ? std::next(it) : timeline.warmed.erase(it);
+  }
+  for (auto it = timeline.opened.begin(); it != timeline.opened.end();)
+  {
+    if (keep.count(*it))
+    {
+      ++it;
+      continue;
+    }
+    closeFileInfo(*it);
+    it = timeline.opened.erase(it);
+  }
+}
+
+/**
+ * @brief Probes @p files with up to @p concurrency files open at a time.
+ */
+static std::vector<FileProbe> probeFilesConcurrently(const std::vector<std::string> &files,
+                                                     int concurrency)
+{
+  // Each lane opens one file at a time, bounding concurrent file I/O.
+  const int lanes = std::max(1, std::min(concurrency, (int)files.size()));
+  std::vector<FileProbe> probes(files.size());
+  std::atomic<size_t> nextFile{0};
+  auto probeLane = [&](int)
+  {
+    for (size_t i = nextFile++; i < files.size(); i = nextFile++)
+    {
+      probes[i] = probeFile(files[i]);
+    }
+  };
+  WorkerPool::files().parallelFor(lanes, probeLane);
+  return probes;
+}
+
+/** A grabFrameAt request, read from its JS object on the main thread. */
+struct GrabRequest
+{
+  std::string file;
+  double frameNum = 0;
+  int64_t tsMilli = 0;
+  bool scrub = false;
+  int maxWidth = 0;
+  FrameRect roi = noZoom;
+  bool blend = false;
+  bool closeTo = false;
+  std::string interpMethod = "blend";
+  std::string outputFormat = "rgba";
+  std::string rifeModelFile;
+  FrameRect rifeCrop = noZoom;
+  bool hasRifeCrop = false;
+  std::string saveAs;
+  FrameRect sourceRect = noZoom;
+  bool hasSourceRect = false;
+  int outWidth = 0;
+  int outHeight = 0;
+  PruneRequest prune;
+  /** Async requests only: a newer request for the same view replaces this one. */
+  std::string view;
+  /** Set when the request was made on a timeline. */
+  bool timeline = false;
+  double timelineFirstFrame = 0;
+  double timelineNumFrames = 0;
+  /** Set when the timeline segment that serves the request is not open yet. */
+  std::unique_ptr<SegmentOpen> open;
+};
+
+/** What a grabFrameAt response is built from. */
+struct GrabResult
+{
+  std::shared_ptr<FrameInfo> frameInfo;
+  /** Planar output; empty when the response is RGBA. */
+  YUVFrame yuv;
+  /** The clamped sourceRect and the frame it was cut from, if requested. */
+  bool region = false;
+  FrameRect sourceRect = noZoom;
+  int frameWidth = 0;
+  int frameHeight = 0;
+};
+
+/**
+ * @brief Reads a grabFrameAt request and finds the open file that serves it.
+ *
+ * A timeline request is mapped to its segment here, which may close segment
+ * files, so it has to run on the main thread. A segment that is not open
+ * yet leaves @p fileInfo null and sets the request's open instead.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string readGrabRequest(const Napi::Object &request, GrabRequest &grab,
+                                   FileInfo *&fileInfo)
+{
+  if (!request.Has("frameNum"))
+  {
+    return "Missing frameNum field";
+  }
+  if (!request.Has("videoFile") && !request.Has("timeline"))
+  {
+    return "Missing videoFile field";
+  }
+  grab.file = request.Has("videoFile")
+                  ? request.Get("videoFile").As<Napi::String>().Utf8Value()
+                  : std::string();
+  grab.frameNum = request.Get("frameNum").As<Napi::Number>().DoubleValue();
+  // std::cerr << "Grabbing frame at " << frameNum << std::endl;
+  grab.tsMilli = request.Get("tsMilli").As<Napi::Number>().Int64Value();
+
+  // On a timeline, frameNum and tsMilli span all segments. The request is
+  // served by one segment file; the response reports where that segment
+  // starts so callers can map its frameNum back.
+  if (request.Has("timeline"))
+  {
+    auto timelineIt =
+        timelineMap.find(request.Get("timeline").As<Napi::String>().Utf8Value());
+    if (timelineIt == timelineMap.end())
+    {
+      return "Timeline not open";
+    }
+    auto &timeline = timelineIt->second;
+    size_t segment = 0;
+    double localFrame = 1;
+    const bool located = grab.tsMilli
+                             ? timeline.timeline.locateTime(grab.tsMilli, segment,
+                                                            localFrame)
+                             : timeline.timeline.locateFrame(grab.frameNum, segment,
+                                                             localFrame);
+    if (!located)
+    {
+      return "Request is outside the timeline";
+    }
+    useTimelineSegment(request.Env(), timelineIt->first, timeline, segment, localFrame,
+                       grab.open);
+    const auto &part = timeline.timeline.segments()[segment];
+    grab.file = part.file;
+    grab.frameNum = localFrame;
+    if (grab.tsMilli)
+    {
+      // A time in the gap between two recordings shows the earlier
+      // recording's last frame.
+      auto open = fileInfoMap.find(grab.file);
+      grab.tsMilli = std::min<int64_t>(grab.tsMilli, open != fileInfoMap.end()
+                                                         ? open->second.lastFrameTimestampMilli
+                                                         : part.lastTimestampMilli);
+    }
+    grab.timeline = true;
+    grab.timelineFirstFrame = (double)part.firstFrame;
+    grab.timelineNumFrames = (double)timeline.timeline.numFrames();
+  }
+  auto it = fileInfoMap.find(grab.file);
+  if (it != fileInfoMap.end())
+  {
+    fileInfo = &it->second;
+  }
+  else if (!grab.open)
+  {
+    std::cerr << "File not open opening " << grab.file << std::endl;
+    return "File not open";
+  }
+
+  grab.scrub = request.Has("scrub") && request.Get("scrub").As<Napi::Boolean>().Value();
+  if (request.Has("maxWidth"))
+  {
+    grab.maxWidth = request.Get("maxWidth").As<Napi::Number>().Int32Value();
+  }
+  if (request.Has("saveAs"))
+  {
+    grab.saveAs = request.Get("saveAs").As<Napi::String>().Utf8Value();
+  }
+  if (debugLevel > 1)
+  {
+    std::cout << "saveAs: " << grab.saveAs << ", frameNum: " << grab.frameNum << ", tsMilli: " << grab.tsMilli << ", file:" << grab.file << std::endl;
+  }
+
+  if (request.Has("zoom") && request.Get("zoom").IsObject())
+  {
+    auto zoom = request.Get("zoom").As<Napi::Object>();
+    auto x = zoom.Get("x").As<Napi::Number>().Int32Value();
+    auto y = zoom.Get("y").As<Napi::Number>().Int32Value();
+    auto zwidth = zoom.Get("width").As<Napi::Number>().Int32Value();
+    auto zheight = zoom.Get("height").As<Napi::Number>().Int32Value();
+    grab.roi = {x, y, zwidth, zheight};
+    if (debugLevel > 1)
+    {
+      std::cout << "roi: " << grab.roi.x << "," << grab.roi.y << " " << grab.roi.width
+                << "x" << grab.roi.height << std::endl;
+    }
+  }
+  grab.blend =
+      request.Has("blend") && request.Get("blend").As<Napi::Boolean>().Value();
+  grab.closeTo =
+      request.Has("closeTo") && request.Get("closeTo").As<Napi::Boolean>().Value();
+
+  if (request.Has("interpMethod"))
+  {
+    grab.interpMethod = request.Get("interpMethod").As<Napi::String>().Utf8Value();
+  }
+  if (request.Has("outputFormat"))
+  {
+    grab.outputFormat = request.Get("outputFormat").As<Napi::String>().Utf8Value();
+  }
+  if (request.Has("modelFile"))
+  {
+    grab.rifeModelFile = request.Get("modelFile").As<Napi::String>().Utf8Value();
+  }
+  if (request.Has("crop") && request.Get("crop").IsObject())
+  {
+    auto cropObj = request.Get("crop").As<Napi::Object>();
+    auto x = cropObj.Get("x").As<Napi::Number>().Int32Value();
+    auto y = cropObj.Get("y").As<Napi::Number>().Int32Value();
+    auto cwidth = cropObj.Get("width").As<Napi::Number>().Int32Value();
+    auto cheight = cropObj.Get("height").As<Napi::Number>().Int32Value();
+    grab.rifeCrop = {x, y, cwidth, cheight};
+    grab.hasRifeCrop = (grab.rifeCrop.width > 0) && (grab.rifeCrop.height > 0);
+  }
+  grab.hasSourceRect = readRect(request, "sourceRect", grab.sourceRect);
+  if (request.Has("outputSize") && request.Get("outputSize").IsObject())
+  {
+    auto outputSize = request.Get("outputSize").As<Napi::Object>();
+    grab.outWidth = outputSize.Get("width").As<Napi::Number>().Int32Value();
+    grab.outHeight = outputSize.Get("height").As<Napi::Number>().Int32Value();
+  }
+  grab.prune = readPrune(request);
+  if (request.Has("view"))
+  {
+    grab.view = request.Get("view").As<Napi::String>().Utf8Value();
+  }
+  return "";
+}
+
+/**
+ * @brief Decodes, interpolates and converts the frame for a grabFrameAt
+ * request. Touches no JS values, so it can run on a worker thread.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string grabFrame(FileInfo &fileInfo, const GrabRequest &request,
+                             GrabResult &result)
+{
+  const auto &file = request.file;
+  const double frameNum = request.frameNum;
+  const int64_t tsMilli = request.tsMilli;
+
+  // Scrub previews show the nearest keyframe from a separate decoder, so
+  // dragging never disturbs exact decoding or prefetch.
+  if (request.scrub)
+  {
+    auto frameInfo = scrubFrame(fileInfo.videoReader, file, frameNum, request.maxWidth);
+    if (!frameInfo || !frameInfo->rgba())
+    {
+      std::string msg = "Failed to grab scrub frame " + std::to_string(frameNum);
+      std::cerr << msg << std::endl;
+      return msg;
+    }
+    result.frameInfo = frameInfo;
+    return "";
+  }
+
+  auto roi = request.roi;
+  const auto blend = request.blend;
+  const auto closeTo = request.closeTo;
+  const auto &interpMethod = request.interpMethod;
+  const auto &outputFormat = request.outputFormat;
+  const auto rifeCrop = request.rifeCrop;
+  const auto &saveAs = request.saveAs;
+
+  auto hasZoom =
+      (roi.width > 0) && (roi.height > 0) && ((roi.x > 0 || roi.y > 0));
+
+  auto key = formatKey(file, frameNum, hasZoom, roi, closeTo);
+  if (interpMethod == "rife")
+  {
+    key += "-rife-" + std::to_string(rifeCrop.x) + "-" +
+           std::to_string(rifeCrop.y) + "-" + std::to_string(rifeCrop.width) +
+           "-" + std::to_string(rifeCrop.height);
+  }
+  auto frameInfo = frameInfoList.getFrame(key);
+  if (!frameInfo)
+  {
+    // Only meant to absorb float representation noise (e.g. 123.9999997
+    // meaning "really frame 124"), not real fractional requests -- a wider
+    // tolerance here silently skips interpolation/RIFE near integer frames
+    // and returns the raw decode instead, which is visibly different
+    // (sharper/less blended) and shows up as a jump right at the boundary.
+    constexpr double kIntegerFrameEpsilon = 1e-3;
+    // Nothing in cache, generate a new result
+    auto intPart = static_cast<int>(frameNum);
+    double fractionalPart = frameNum - intPart; // Extract fractional part
+    auto fractionalFrame =
+        ((fractionalPart > kIntegerFrameEpsilon) &&
+         (fractionalPart < 1.0 - kIntegerFrameEpsilon));
+    if (!fractionalFrame)
+    {
+      intPart = std::round(
+          frameNum); // ensure a frameNum like 123.9999 ends up 124.
+    }
+
+    if (tsMilli)
+    {
+      if (tsMilli < int64_t(fileInfo.firstFrameTimestampMilli) || tsMilli > int64_t(fileInfo.lastFrameTimestampMilli))
+      {
+        std::string msg = "Requested timestamp " + std::to_string(tsMilli) + " not within file bounds: " + "[" + std::to_string(fileInfo.firstFrameTimestampMilli) + "," + std::to_string(fileInfo.lastFrameTimestampMilli) + "]";
+        std::cerr << msg << std::endl;
+        return msg;
+      }
+      // find frames on either side of requested time
+      float delta = fileInfo.lastFrameTimestampMilli - fileInfo.firstFrameTimestampMilli;
+      auto seekFrameFloat = delta <= 0 ? 1 : 1 + ((tsMilli - fileInfo.firstFrameTimestampMilli) / delta) * (fileInfo.numFrames - 1);
+      intPart = static_cast<int>(seekFrameFloat);
+      fractionalPart = seekFrameFloat - intPart; // Extract fractional part
+      fractionalFrame =
+          ((fractionalPart > kIntegerFrameEpsilon) &&
+           (fractionalPart < 1.0 - kIntegerFrameEpsilon));
+
+      // The timestamp table answers without decoding; the galloping search
+      // below decodes a frame per probe.
+      const auto *timestamps = timestampTableFor(fileInfo, file);
+      TimestampBounds bounds;
+      if (timestamps && timestamps->findBounds(tsMilli * 1000, bounds))
+      {
+        intPart = (int)fileInfo.videoReader->getFrameNumberForPts(bounds.ptsA);
+        fractionalPart = double(tsMilli * 1000 - bounds.tsMicroA) /
+                         (bounds.tsMicroB - bounds.tsMicroA);
+        seekFrameFloat = intPart + fractionalPart;
+        fractionalFrame =
+            ((fractionalPart > kIntegerFrameEpsilon) &&
+             (fractionalPart < 1.0 - kIntegerFrameEpsilon));
+      }
+      else if (auto [frameA, frameB] = findBoundingFrames(fileInfo.videoReader, file, tsMilli, intPart, fileInfo.numFrames);
+               frameA && frameB)
+      {
+
+        if (debugLevel > 1)
+        {
+          std::cerr << "Found bounding frames at " << frameA->frameNum << ", " << frameB->frameNum << std::endl;
+        }
+        intPart = frameA->frameNum;
+        float delta = frameB->timestamp - frameA->timestamp;
+        if (delta <= 0)
+        {
+          std::string msg = "Malformed video frames detected at frame " + std::to_string(frameA->frameNum) + " and " + std::to_string(frameB->frameNum);
+          std::cerr << msg << std::endl;
+          return msg;
+        }
+
+        fractionalPart = (tsMilli - frameA->timestamp) / delta;
+        seekFrameFloat = intPart + fractionalPart;
+        fractionalFrame =
+            ((fractionalPart > kIntegerFrameEpsilon) &&
+             (fractionalPart < 1.0 - kIntegerFrameEpsilon));
+      }
+    }
+
+    if (fractionalFrame)
+    {
+      preloadIntraFrames(fileInfo, file, {intPart, intPart + 1});
+      auto frameA = getFrame(fileInfo, file, intPart);
+      auto frameB = getFrame(fileInfo, file, intPart + 1);
+      if (DecodeCancelScope::cancelled())
+      {
+        // Skips interpolation too; nothing is cached under this key.
+        return supersededError;
+      }
+      if ((frameA && !frameA->rgba()) || (frameB && !frameB->rgba()))
+      {
+        std::string msg = "Failed to convert frames " + std::to_string(intPart) +
+                          " and " + std::to_string(intPart + 1);
+        std::cerr << msg << std::endl;
+        return msg;
+      }
+      if (frameA && frameB)
+      {
+        if (tsMilli)
+        {
+          // refine the fractional part now that we know the exact frame times
+          // involved.
+          fractionalPart = double(tsMilli * 1000 - frameA->tsMicro) /
+                           (frameB->tsMicro - frameA->tsMicro);
+          // std::cout << "tsMilli=" << tsMilli << " A ts=" << frameA->tsMicro
+          //           << " B ts=" << frameB->tsMicro
+          //           << " frac=" << fractionalPart << std::endl;
+          // std::cout << tsMilli << std::endl
+          //           << frameA->tsMicro << std::endl
+          //           << frameB->tsMicro << std::endl;
+          if (std::abs(fractionalPart) >= 1.0)
+          {
+            std::cout << "Restricting fractional part to 1.0" << std::endl;
+            fractionalPart = 0;
+          }
+        }
+        if (!hasZoom)
+        {
+          // GE: If we have no zoom do we want to trigger interpolate?
+          std::cout << "Not zooming.  restricting roi"
+                    << " roi width=" << roi.width << std::endl;
+          // Use a slice around the center
+          auto width = std::min(frameA->width, 256);
+          roi = {frameA->width / 2 - width / 2, 0, width, frameA->height};
+        }
+        // range check roi
+
+        roi.width = std::min(roi.width, frameA->width);
+        roi.height = std::min(roi.height, frameA->height);
+        roi.x = std::max(0, roi.x);
+        roi.y = std::max(0, roi.y);
+        if (roi.x + roi.width > frameA->width)
+        {
+          roi.x = frameA->width - roi.width;
+        }
+        if (roi.y + roi.height > frameA->height)
+        {
+          roi.y = frameA->height - roi.height;
+        }
+
+        // std::cout << "A framenum=" << frameA->frameNum
+        //           << " B framenum=" << frameB->frameNum
+        //           << " frac=" << fractionalPart << std::endl;
+
+        bool generatedByRife = false;
+#ifdef RIFE_SUPPORTED
+        if (interpMethod == "rife" && !request.rifeModelFile.empty())
+        {
+          auto rifeRoi = request.hasRifeCrop ? rifeCrop : roi;
+          rifeRoi.width = std::min(rifeRoi.width, frameA->width);
+          rifeRoi.height = std::min(rifeRoi.height, frameA->height);
+          rifeRoi.x = std::max(0, rifeRoi.x);
+          rifeRoi.y = std::max(0, rifeRoi.y);
+          if (rifeRoi.x + rifeRoi.width > frameA->width)
+          {
+            rifeRoi.x = frameA->width - rifeRoi.width;
+          }
+          if (rifeRoi.y + rifeRoi.height > frameA->height)
+          {
+            rifeRoi.y = frameA->height - rifeRoi.height;
+          }
+
+          try
+          {
+            // Model sessions are shared by requests for every file.
+            std::lock_guard<std::mutex> guard(modelLock);
+            auto &interpolator = rifeInterpolatorMap[request.rifeModelFile];
+            if (!interpolator)
+            {
+              interpolator = new RifeInterpolator(request.rifeModelFile);
+            }
+            cv::Mat matA(frameA->height, frameA->width, CV_8UC4,
+                        (void *)frameA->rgba()->data());
+            cv::Mat matB(frameA->height, frameA->width, CV_8UC4,
+                        (void *)frameB->rgba()->data());
+            cv::Rect cvCrop(rifeRoi.x, rifeRoi.y, rifeRoi.width, rifeRoi.height);
+            cv::Mat resultMat = interpolator->interpolate(
+                matA, matB, static_cast<float>(fractionalPart), cvCrop,
+                debugLevel);
+
+            // Composite the (small, fast-to-infer) interpolated crop back
+            // into a full-size copy of frameA so the response keeps the
+            // same width/height/linesize contract the blend path uses.
+            // Downstream rendering (Video.tsx) reuses image.width/height
+            // to (re)size the canvas and video-scaling state every frame,
+            // so returning a crop-sized buffer here corrupts that state.
+            frameInfo = std::make_shared<FrameInfo>(*frameA);
+            frameInfo->source.reset();
+            frameInfo->data = std::make_shared<std::vector<uint8_t>>(*(frameA->rgba()));
+            cv::Mat fullMat(frameInfo->height, frameInfo->width, CV_8UC4,
+                            frameInfo->data->data());
+            resultMat.copyTo(fullMat(cvCrop));
+            frameInfo->tsMicro =
+                frameA->tsMicro +
+                (frameB->tsMicro - frameA->tsMicro) * fractionalPart + 0.5;
+            frameInfo->timestamp = (frameInfo->tsMicro + 500) / 1000;
+            frameInfo->frameNum =
+                frameA->frameNum +
+                (frameB->frameNum - frameA->frameNum) * fractionalPart;
+            frameInfo->roi = rifeRoi;
+            generatedByRife = true;
+          }
+          catch (const std::exception &e)
+          {
+            std::cerr << "RIFE interpolation failed, falling back to blend: "
+                      << e.what() << std::endl;
+          }
+        }
+#endif
+        if (!generatedByRife)
+        {
+          frameInfo = generateInterpolatedFrame(frameA, frameB, fractionalPart,
+                                                roi, blend);
+        }
+        if (debugLevel > 1)
+        {
+          std::cout << __FILE__ << ":" << __LINE__
+                    << " Generating interpolated frame requestedFrameNum="
+                    << frameNum << " between " << frameA->frameNum << " and "
+                    << frameB->frameNum << " at " << fractionalPart
+                    << "% zoom=" << (hasZoom ? "true" : "false")
+                    << " interpMethod=" << interpMethod
+                    << " blend=" << (blend ? "true" : "false") << " motion=[" << frameInfo->motion.x << "," << frameInfo->motion.y << "," << frameInfo->motion.valid << "," << frameInfo->motion.dt << "]" << std::endl;
+        }
+        frameA->motion = frameInfo->motion;
+        frameA->roi = frameInfo->roi;
+      }
+      else if (frameA)
+      {
+        std::cerr << "Failed to grab frames " << file << ": " << intPart
+                  << " and " << intPart + 1 << std::endl;
+        // Make a copy for cache purposes
+        frameInfo = std::make_shared<FrameInfo>(*frameA);
+        frameInfo->data =
+            std::make_shared<std::vector<uint8_t>>(*(frameA->rgba()));
+        frameInfo->source.reset();
+      }
+      else
+      {
+        std::string msg = "Failed to grab frame " + std::to_string(intPart);
+        std::cerr << msg << std::endl;
+        return msg;
+      }
+      frameInfo->key = key;
+      frameInfoList.addFrame(frameInfo);
+    }
+    else
+    {
+      frameInfo = getFrame(fileInfo, file, intPart, closeTo);
+      if (frameInfo)
+      {
+        // Region requests scale straight from the cached entry's planes, so
+        // they skip the zoom entry, which would need full RGBA.
+        if (hasZoom && !request.hasSourceRect)
+        {
+          if (!frameInfo->rgba())
+          {
+            std::string msg = "Failed to convert frame " + std::to_string(frameNum);
+            std::cerr << msg << std::endl;
+            return msg;
+          }
+          // Shares the cached pixels; only motion and roi differ per zoom.
+          frameInfo = std::make_shared<FrameInfo>(*frameInfo);
+          frameInfo->key = key;
+          frameInfoList.addFrame(frameInfo);
+        }
+      }
+      else if (DecodeCancelScope::cancelled())
+      {
+        return supersededError;
+      }
+      else
+      {
+        std::string msg = "Failed to grab frame " + std::to_string(frameNum);
+        std::cerr << msg << std::endl;
+        return msg;
+      }
+    }
+    // if (hasZoom) {
+    //   sharpenFrame(frameInfo);
+    // }
+  }
+
+
+  // Planar output skips RGBA conversion entirely. Region requests and
+  // saveAs still need RGBA, as do interpolated frames.
+  if ((outputFormat == "i420" || outputFormat == "nv12") && !request.hasSourceRect &&
+      saveAs.empty() &&
+      yuvFrame(frameInfo, *fileInfo.videoReader, closeTo, outputFormat == "nv12",
+               request.prune, result.yuv))
+  {
+    result.frameInfo = frameInfo;
+    return "";
+  }
+
+  // A source rect selects the displayed region, delivered at the requested
+  // output size. It replaces prune, which only makes sense for full frames.
+  if (request.hasSourceRect)
+  {
+    const int outWidth = request.outWidth;
+    const int outHeight = request.outHeight;
+    const int frameWidth = frameInfo->width;
+    const int frameHeight = frameInfo->height;
+    auto sourceRect = request.sourceRect;
+    sourceRect.x = std::max(0, std::min(sourceRect.x, frameWidth - 1));
+    sourceRect.y = std::max(0, std::min(sourceRect.y, frameHeight - 1));
+    sourceRect.width = std::min(sourceRect.width, frameWidth - sourceRect.x);
+    sourceRect.height = std::min(sourceRect.height, frameHeight - sourceRect.y);
+    const auto regionKey =
+        key + "-region-" + std::to_string(sourceRect.x) + "-" +
+        std::to_string(sourceRect.y) + "-" + std::to_string(sourceRect.width) +
+        "-" + std::to_string(sourceRect.height) + "-" +
+        std::to_string(outWidth) + "x" + std::to_string(outHeight);
+    auto region = frameInfoList.getFrame(regionKey);
+    if (!region)
+    {
+      region = regionFrame(frameInfo, sourceRect, outWidth, outHeight);
+      if (!region)
+      {
+        std::string msg = "Failed to convert region of frame " +
+                          std::to_string(frameNum);
+        std::cerr << msg << std::endl;
+        return msg;
+      }
+      region->key = regionKey;
+      frameInfoList.addFrame(region);
+    }
+    frameInfo = region;
+    result.region = true;
+    result.sourceRect = sourceRect;
+    result.frameWidth = frameWidth;
+    result.frameHeight = frameHeight;
+  }
+  else
+  {
+    frameInfo = pruneFrame(frameInfo, request.prune);
+  }
+
+  if (!saveAs.empty())
+  {
+    saveFrameAsPNG(frameInfo, saveAs);
+  }
+
+  if (!frameInfo->rgba())
+  {
+    std::string msg = "Failed to convert frame " + std::to_string(frameNum);
+    std::cerr << msg << std::endl;
+    return msg;
+  }
+  result.frameInfo = frameInfo;
+
+  if (debugLevel > 1)
+  {
+    std::cout << "Grabbed frame: " << frameInfo->frameNum << " ts=" << frameInfo->timestamp << " WxH=" << frameInfo->width
+              << "x" << frameInfo->height << std::endl;
+  }
+  return "";
+}
+
+/**
+ * @brief Fills a grabFrameAt response from @p result.
+ */
+static void setGrabFields(const Napi::Env &env, Napi::Object &ret,
+                          const GrabRequest &request, const GrabResult &result)
+{
+  if (request.timeline)
+  {
+    ret.Set("timelineFirstFrame", Napi::Number::New(env, request.timelineFirstFrame));
+    ret.Set("timelineNumFrames", Napi::Number::New(env, request.timelineNumFrames));
+  }
+  const auto &frameInfo = result.frameInfo;
+  if (!result.yuv.data.empty())
+  {
+    setYUVFields(env, ret, result.yuv);
+    setFrameFields(env, ret, frameInfo);
+    return;
+  }
+  if (result.region)
+  {
+    Napi::Object rect = Napi::Object::New(env);
+    rect.Set("x", Napi::Number::New(env, result.sourceRect.x));
+    rect.Set("y", Napi::Number::New(env, result.sourceRect.y));
+    rect.Set("width", Napi::Number::New(env, result.sourceRect.width));
+    rect.Set("height", Napi::Number::New(env, result.sourceRect.height));
+    ret.Set("sourceRect", rect);
+    ret.Set("frameWidth", Napi::Number::New(env, result.frameWidth));
+    ret.Set("frameHeight", Napi::Number::New(env, result.frameHeight));
+  }
+  ret.Set("data", Napi::Buffer<uint8_t>::Copy(env, frameInfo->data->data(),
+                                              frameInfo->totalBytes));
+  ret.Set("width", Napi::Number::New(env, frameInfo->width));
+  ret.Set("height", Napi::Number::New(env, frameInfo->height));
+  ret.Set("totalBytes", Napi::Number::New(env, frameInfo->totalBytes));
+  ret.Set("format", Napi::String::New(env, "rgba"));
+  setFrameFields(env, ret, frameInfo);
+}
+
+#ifdef RIFE_SUPPORTED
+/** A detectBowAtFrame request, read from its JS object on the main thread. */
+struct BowRequest
+{
+  std::string videoFile;
+  std::string boatModelFile;
+  std::string cardModelFile;
+  std::string numberModelFile;
+  double frameNum = 0;
+  bool closeTo = false;
+  bool detectCardsWithoutBoat = false;
+  PruneRequest prune;
+  /** Detect at this point only, rather than every boat in the frame. */
+  bool hasPoint = false;
+  cv::Point point;
+};
+
+/** What a detectBowAtFrame response is built from. */
+struct BowResult
+{
+  double frameNum = 0;
+  uint64_t timestamp = 0;
+  std::vector<BowNumberDetection> detections;
+};
+
+/**
+ * @brief Reads a detectBowAtFrame request and finds its open file.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string readBowRequest(const Napi::Object &args, BowRequest &bow,
+                                  FileInfo *&fileInfo)
+{
+  if (!args.Has("request") || !args.Get("request").IsObject())
+  {
+    return "Missing bow detection request";
+  }
+  const auto request = args.Get("request").As<Napi::Object>();
+  if (!request.Has("videoFile") || !request.Has("frameNum") ||
+      !request.Has("boatModelFile") || !request.Has("cardModelFile") ||
+      !request.Has("numberModelFile"))
+  {
+    return "Bow detection requires videoFile, frameNum, boatModelFile, "
+           "cardModelFile, and numberModelFile";
+  }
+
+  bow.videoFile = request.Get("videoFile").As<Napi::String>().Utf8Value();
+  bow.boatModelFile = request.Get("boatModelFile").As<Napi::String>().Utf8Value();
+  bow.cardModelFile = request.Get("cardModelFile").As<Napi::String>().Utf8Value();
+  bow.numberModelFile = request.Get("numberModelFile").As<Napi::String>().Utf8Value();
+  bow.frameNum = request.Get("frameNum").As<Napi::Number>().DoubleValue();
+  bow.closeTo =
+      request.Has("closeTo") && request.Get("closeTo").As<Napi::Boolean>().Value();
+  bow.detectCardsWithoutBoat =
+      request.Has("detectCardsWithoutBoat") &&
+      request.Get("detectCardsWithoutBoat").As<Napi::Boolean>().Value();
+  bow.prune = readPrune(request);
+  if (request.Has("point"))
+  {
+    const auto pointObject = request.Get("point").As<Napi::Object>();
+    bow.hasPoint = true;
+    bow.point = cv::Point(pointObject.Get("x").As<Napi::Number>().Int32Value(),
+                          pointObject.Get("y").As<Napi::Number>().Int32Value());
+  }
+
+  const auto file = fileInfoMap.find(bow.videoFile);
+  if (file == fileInfoMap.end())
+  {
+    return "Video file is not open";
+  }
+  fileInfo = &file->second;
+  return "";
+}
+
+/**
+ * @brief Reads the frame and runs the bow number pipeline on it. Touches no
+ * JS values, so it can run on a worker thread.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string detectBow(FileInfo &fileInfo, const BowRequest &bow, BowResult &result)
+{
+  try
+  {
+    const auto frame =
+        getFrame(fileInfo.videoReader, bow.videoFile, bow.frameNum, bow.closeTo);
+    if (!frame)
+    {
+      return "Unable to read frame " + std::to_string(bow.frameNum);
+    }
+
+    const auto detectionFrame = pruneFrame(frame, bow.prune);
+    if (!detectionFrame->rgba())
+    {
+      return "Unable to convert frame " + std::to_string(bow.frameNum);
+    }
+    const cv::Mat rgba(detectionFrame->height, detectionFrame->width, CV_8UC4,
+                       detectionFrame->rgba()->data(), detectionFrame->linesize);
+    result.frameNum = frame->frameNum;
+    result.timestamp = frame->timestamp;
+
+    std::lock_guard<std::mutex> guard(modelLock);
+    const std::string pipelineKey =
+        bow.boatModelFile + "|" + bow.cardModelFile + "|" + bow.numberModelFile;
+    auto pipelineEntry = bowNumberPipelineMap.find(pipelineKey);
+    if (pipelineEntry == bowNumberPipelineMap.end())
+    {
+      pipelineEntry =
+          bowNumberPipelineMap
+              .emplace(pipelineKey,
+                       new BowNumberPipeline(bow.boatModelFile, bow.cardModelFile,
+                                             bow.numberModelFile))
+              .first;
+    }
+    if (bow.hasPoint)
+    {
+      result.detections.push_back(
+          pipelineEntry->second->detect(rgba, bow.point, bow.detectCardsWithoutBoat));
+    }
+    else
+    {
+      result.detections = pipelineEntry->second->detectAll(rgba, bow.detectCardsWithoutBoat);
+    }
+    return "";
+  }
+  catch (const std::exception &error)
+  {
+    return error.what();
+  }
+}
+
+/**
+ * @brief Fills a detectBowAtFrame response from @p result.
+ */
+static void setBowFields(const Napi::Env &env, Napi::Object &ret, const BowResult &result)
+{
+  ret.Set("frameNum", Napi::Number::New(env, result.frameNum));
+  ret.Set("timestamp", Napi::Number::New(env, result.timestamp));
+
+  const auto makeBox = [&env](const cv::Rect &box)
+  {
+    Napi::Object value = Napi::Object::New(env);
+    value.Set("x", Napi::Number::New(env, box.x));
+    value.Set("y", Napi::Number::New(env, box.y));
+    value.Set("width", Napi::Number::New(env, box.width));
+    value.Set("height", Napi::Number::New(env, box.height));
+    return value;
+  };
+  Napi::Array detectionValues = Napi::Array::New(env, result.detections.size());
+  for (size_t index = 0; index < result.detections.size(); ++index)
+  {
+    const auto &detection = result.detections[index];
+    Napi::Object value = Napi::Object::New(env);
+    value.Set("text", Napi::String::New(env, detection.text));
+    value.Set("confidence",
+              Napi::Number::New(env, detection.confidence));
+    value.Set("box", makeBox(detection.cardBox));
+    value.Set("boatBox", makeBox(detection.boatBox));
+    detectionValues.Set(index, value);
+  }
+  ret.Set("detections", detectionValues);
+}
+#endif
+
+/** A probeFiles request, read from its JS object on the main thread. */
+struct ProbeRequest
+{
+  std::vector<std::string> files;
+  int concurrency = 4;
+};
+
+static std::string readProbeRequest(const Napi::Object &args, ProbeRequest &probe)
+{
+  if (!args.Has("files") || !args.Get("files").IsArray())
+  {
+    return "Missing files field";
+  }
+  auto fileArray = args.Get("files").As<Napi::Array>();
+  for (uint32_t i = 0; i < fileArray.Length(); i++)
+  {
+    probe.files.push_back(fileArray.Get(i).As<Napi::String>().Utf8Value());
+  }
+  if (args.Has("concurrency"))
+  {
+    probe.concurrency = std::max(1, args.Get("concurrency").As<Napi::Number>().Int32Value());
+  }
+  return "";
+}
+
+/**
+ * @brief Fills a probeFiles response from @p probes.
+ */
+static void setProbeFields(const Napi::Env &env, Napi::Object &ret,
+                           const ProbeRequest &request, const std::vector<FileProbe> &probes)
+{
+  const auto &files = request.files;
+  Napi::Array results = Napi::Array::New(env, files.size());
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    const auto &probe = probes[i];
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("file", Napi::String::New(env, files[i]));
+    if (!probe.error.empty())
+    {
+      result.Set("status", Napi::String::New(env, probe.error));
+      results.Set((uint32_t)i, result);
+      continue;
+    }
+    result.Set("status", Napi::String::New(env, "OK"));
+    result.Set("fps", Napi::Number::New(env, probe.fps));
+    result.Set("width", Napi::Number::New(env, probe.width));
+    result.Set("height", Napi::Number::New(env, probe.height));
+    result.Set("exact", Napi::Boolean::New(env, probe.exact));
+    result.Set("numFrames", Napi::Number::New(env, (double)probe.extent.numFrames));
+    result.Set("firstTimestamp",
+               Napi::Number::New(env, (double)probe.extent.firstFrameTimestampMilli));
+    result.Set("lastTimestamp",
+               Napi::Number::New(env, (double)probe.extent.lastFrameTimestampMilli));
+    result.Set("firstTsMicro", Napi::Number::New(env, (double)probe.extent.firstTsMicro));
+    result.Set("lastTsMicro", Napi::Number::New(env, (double)probe.extent.lastTsMicro));
+    results.Set((uint32_t)i, result);
+  }
+  ret.Set("files", results);
+}
+
+/** An openTimeline request, read from its JS object on the main thread. */
+struct TimelineRequest
+{
+  std::string id;
+  /** The segment files, probed for their extent. */
+  ProbeRequest probe;
+  int64_t preloadFrames = -1; ///< -1 keeps the timeline's setting.
+  double prefetchMB = -1;     ///< -1 keeps the timeline's setting.
+};
+
+static std::string readTimelineRequest(const Napi::Object &args, TimelineRequest &timeline)
+{
+  if (!args.Has("timeline") || !args.Has("files") || !args.Get("files").IsArray())
+  {
+    return "Missing timeline or files field";
+  }
+  timeline.id = args.Get("timeline").As<Napi::String>().Utf8Value();
+  readProbeRequest(args, timeline.probe);
+  timeline.probe.concurrency = 4;
+  if (timeline.probe.files.empty())
+  {
+    return "Timeline needs at least one file";
+  }
+  if (args.Has("preloadFrames"))
+  {
+    timeline.preloadFrames =
+        std::max(0, args.Get("preloadFrames").As<Napi::Number>().Int32Value());
+  }
+  if (args.Has("prefetchMB"))
+  {
+    timeline.prefetchMB = std::max(0.0, args.Get("prefetchMB").As<Napi::Number>().DoubleValue());
+  }
+  return "";
+}
+
+/**
+ * @brief Sets the segments of a timeline from their probes and fills the
+ * openTimeline response. Main thread only, as it uses the open files.
+ *
+ * Segments are sized from their frame index without opening readers; only
+ * the segment in use and its neighbour near a boundary get one.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string openTimeline(const Napi::Env &env, Napi::Object &ret,
+                                const TimelineRequest &request,
+                                const std::vector<FileProbe> &probes)
+{
+  const auto &files = request.probe.files;
+  std::vector<TimelineSegment> segments(files.size());
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    if (!probes[i].error.empty())
+    {
+      return "Unable to add " + files[i] + " to timeline: " + probes[i].error;
+    }
+    const auto &extent = probes[i].extent;
+    segments[i].file = files[i];
+    segments[i].numFrames = extent.numFrames;
+    segments[i].firstTsMicro = extent.firstTsMicro;
+    segments[i].lastTsMicro = extent.lastTsMicro;
+    segments[i].firstTimestampMilli = extent.firstFrameTimestampMilli;
+    segments[i].lastTimestampMilli = extent.lastFrameTimestampMilli;
+  }
+
+  // Reopening an id keeps its readers; ones no longer used close lazily.
+  auto &timeline = timelineMap[request.id];
+  timeline.timeline.setSegments(std::move(segments));
+  if (request.preloadFrames >= 0)
+  {
+    timeline.preloadFrames = request.preloadFrames;
+  }
+  if (request.prefetchMB >= 0)
+  {
+    timeline.prefetchMB = request.prefetchMB;
+  }
+  for (size_t i = 0; i < files.size(); i++)
+  {
+    // Files that were already open report the reader's exact extent.
+    auto open = fileInfoMap.find(files[i]);
+    if (open != fileInfoMap.end())
+    {
+      timeline.timeline.setSegmentFrames(i, open->second.numFrames);
+    }
+  }
+
+  const auto &parts = timeline.timeline.segments();
+  Napi::Array segmentArray = Napi::Array::New(env, parts.size());
+  for (size_t i = 0; i < parts.size(); i++)
+  {
+    Napi::Object segment = Napi::Object::New(env);
+    segment.Set("file", Napi::String::New(env, parts[i].file));
+    segment.Set("firstFrame", Napi::Number::New(env, (double)parts[i].firstFrame));
+    segment.Set("numFrames", Napi::Number::New(env, (double)parts[i].numFrames));
+    segment.Set("firstTimestamp", Napi::Number::New(env, (double)parts[i].firstTimestampMilli));
+    segment.Set("lastTimestamp", Napi::Number::New(env, (double)parts[i].lastTimestampMilli));
+    segmentArray.Set((uint32_t)i, segment);
+  }
+  ret.Set("numFrames", Napi::Number::New(env, (double)timeline.timeline.numFrames()));
+  ret.Set("firstTimestamp", Napi::Number::New(env, (double)parts.front().firstTimestampMilli));
+  ret.Set("lastTimestamp", Napi::Number::New(env, (double)parts.back().lastTimestampMilli));
+  ret.Set("firstTsMicro", Napi::Number::New(env, (double)parts.front().firstTsMicro));
+  ret.Set("lastTsMicro", Napi::Number::New(env, (double)parts.back().lastTsMicro));
+  ret.Set("segments", segmentArray);
+  return "";
+}
+
+/** The new end of a file still being written, see refreshExtent(). */
+struct RefreshResult
+{
+  bool grown = false;
+  int32_t numFrames = 0;
+  uint64_t lastTsMicro = 0;
+  uint64_t lastFrameTimestampMilli = 0;
+};
+
+/**
+ * @brief Indexes frames appended to a file still being written. Frame 1 and
+ * the UTC anchor are unchanged. Leaves the extent fields, which the main
+ * thread reads, to setRefreshFields(), so it can run on a worker thread.
+ */
+static void refreshExtent(FileInfo &fileInfo, RefreshResult &result)
+{
+  auto &ffreader = fileInfo.videoReader;
+  int64_t lastFrameNumber = 0;
+  int64_t firstPts = 0;
+  int64_t lastPts = 0;
+  result.grown = ffreader->refreshTail() &&
+                 ffreader->getIndexedExtent(lastFrameNumber, firstPts, lastPts);
+  if (!result.grown)
+  {
+    return;
+  }
+  // Rebuilt on the next search by time, covering the new frames.
+  fileInfo.timestamps.reset();
+  // The extra cursors hold the shorter index; reopened on demand.
+  fileInfo.cursors.clear();
+  const AVRational timeBase = ffreader->getTimeBase();
+  const uint64_t spanMicro =
+      (uint64_t)(1000000 * (lastPts - firstPts) * timeBase.num / timeBase.den);
+  result.numFrames = (int32_t)std::min(lastFrameNumber, ffreader->getTotalFrames());
+  if (ffreader->getFirstUtcUs() != 0)
+  {
+    result.lastTsMicro = containerTsMicro(ffreader, lastPts, timeBase);
+    result.lastFrameTimestampMilli = (result.lastTsMicro + 500) / 1000;
+  }
+  else
+  {
+    result.lastTsMicro = fileInfo.firstTsMicro ? fileInfo.firstTsMicro + spanMicro : 0;
+    result.lastFrameTimestampMilli =
+        fileInfo.firstFrameTimestampMilli + (spanMicro + 500) / 1000;
+  }
+}
+
+/**
+ * @brief Moves the end of the extent to @p result and fills a refreshFile
+ * response.
+ */
+static void setRefreshFields(const Napi::Env &env, Napi::Object &ret, FileInfo &fileInfo,
+                             const RefreshResult &result)
+{
+  if (result.grown)
+  {
+    fileInfo.numFrames = result.numFrames;
+    fileInfo.lastTsMicro = result.lastTsMicro;
+    fileInfo.lastFrameTimestampMilli = result.lastFrameTimestampMilli;
+  }
+  ret.Set("grown", Napi::Boolean::New(env, result.grown));
+  ret.Set("numFrames", Napi::Number::New(env, fileInfo.numFrames));
+  ret.Set("firstTimestamp", Napi::Number::New(env, fileInfo.firstFrameTimestampMilli));
+  ret.Set("lastTimestamp", Napi::Number::New(env, fileInfo.lastFrameTimestampMilli));
+  ret.Set("firstTsMicro", Napi::Number::New(env, fileInfo.firstTsMicro));
+  ret.Set("lastTsMicro", Napi::Number::New(env, fileInfo.lastTsMicro));
+}
+
+/**
+ * @brief Reads the file of a request and finds it among the open files.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string readOpenFile(const Napi::Object &args, std::string &file,
+                                FileInfo *&fileInfo)
+{
+  if (!args.Has("file"))
+  {
+    return "Missing file field";
+  }
+  file = args.Get("file").As<Napi::String>().Utf8Value();
+  auto it = fileInfoMap.find(file);
+  if (it == fileInfoMap.end())
+  {
+    return "File not open";
+  }
+  fileInfo = &it->second;
+  return "";
+}
+
+/** A configureReader request; groups that were not given are left alone. */
+struct ReaderConfig
+{
+  std::string file;
+  bool setPrefetch = false;
+  bool prefetch = false;
+  size_t prefetchBytes = 0;
+  size_t reverseBytes = 0;
+  bool setFrameStore = false;
+  size_t frameStoreBytes = 0;
+  double historySec = 1.0;
+  bool setCursors = false;
+  int cursors = 0; ///< 0 keeps the current count.
+  size_t cursorStoreBytes = 0;
+};
+
+static std::string readReaderConfig(const Napi::Object &args, ReaderConfig &config,
+                                    FileInfo *&fileInfo)
+{
+  auto error = readOpenFile(args, config.file, fileInfo);
+  if (!error.empty())
+  {
+    return error;
+  }
+  if (args.Has("prefetch"))
+  {
+    config.setPrefetch = true;
+    config.prefetch = args.Get("prefetch").As<Napi::Boolean>().Value();
+    double prefetchMB = 64;
+    if (args.Has("prefetchMB"))
+    {
+      prefetchMB = std::max(0.0, args.Get("prefetchMB").As<Napi::Number>().DoubleValue());
+    }
+    double reverseMB = defaultReverseMB;
+    if (args.Has("reverseMB"))
+    {
+      reverseMB = std::max(0.0, args.Get("reverseMB").As<Napi::Number>().DoubleValue());
+    }
+    config.prefetchBytes = static_cast<size_t>(prefetchMB * 1024 * 1024);
+    config.reverseBytes = static_cast<size_t>(reverseMB * 1024 * 1024);
+  }
+  if (args.Has("frameStoreMB") || args.Has("historySec"))
+  {
+    config.setFrameStore = true;
+    double frameStoreMB = 256;
+    if (args.Has("frameStoreMB"))
+    {
+      frameStoreMB = std::max(0.0, args.Get("frameStoreMB").As<Napi::Number>().DoubleValue());
+    }
+    if (args.Has("historySec"))
+    {
+      config.historySec =
+          std::max(0.0, args.Get("historySec").As<Napi::Number>().DoubleValue());
+    }
+    config.frameStoreBytes = static_cast<size_t>(frameStoreMB * 1024 * 1024);
+  }
+  if (args.Has("cursors") || args.Has("cursorFrameStoreMB"))
+  {
+    // Extra decoders parked at recent positions, for flipping between
+    // frames too far apart for the frame store.
+    config.setCursors = true;
+    if (args.Has("cursors"))
+    {
+      config.cursors = std::clamp(args.Get("cursors").As<Napi::Number>().Int32Value(), 1, 8);
+    }
+    double cursorFrameStoreMB = 64;
+    if (args.Has("cursorFrameStoreMB"))
+    {
+      cursorFrameStoreMB =
+          std::max(0.0, args.Get("cursorFrameStoreMB").As<Napi::Number>().DoubleValue());
+    }
+    config.cursorStoreBytes = static_cast<size_t>(cursorFrameStoreMB * 1024 * 1024);
+  }
+  return "";
+}
+
+/**
+ * @brief Applies @p config to the file's reader and cursors. Touches no JS
+ * values, so it can run on a worker thread.
+ */
+static void configureReader(FileInfo &fileInfo, const ReaderConfig &config)
+{
+  if (config.setPrefetch)
+  {
+    fileInfo.videoReader->setPrefetch(config.prefetch, config.prefetchBytes,
+                                      config.reverseBytes);
+    fileInfo.cursors.setPrefetch(config.prefetch, config.prefetchBytes, config.reverseBytes);
+  }
+  if (config.setFrameStore)
+  {
+    fileInfo.videoReader->setFrameStore(config.frameStoreBytes, config.historySec);
+  }
+  if (config.setCursors)
+  {
+    const size_t cursors =
+        config.cursors > 0 ? (size_t)config.cursors : fileInfo.cursors.cursorLimit();
+    fileInfo.cursors.configure(cursors, config.cursorStoreBytes);
+  }
+}
+
+/** One file of a grabFramesAtTime request and the frames found in it. */
+struct CameraFetch
+{
+  std::string file;
+  FileInfo *fileInfo = nullptr;
+  const TimestampTable *timestamps = nullptr;
+  /**
+   * Async requests only: the file's busy lock, held while this camera is
+   * fetched. Synchronous requests take the locks before fetching.
+   */
+  std::mutex *busy = nullptr;
+  std::string error;
+  std::shared_ptr<FrameInfo> frameA;
+  std::shared_ptr<FrameInfo> frameB;
+  double fraction = 0;
+};
+
+/** A grabFramesAtTime request, read from its JS object on the main thread. */
+struct CamerasRequest
+{
+  int64_t tsMilli = 0;
+  bool bracket = false;
+  /** In the order of the requested files. */
+  std::vector<CameraFetch> fetches;
+};
+
+/**
+ * @brief Reads a grabFramesAtTime request and finds the open files and
+ * timestamp tables that serve it. A file that cannot serve the time gets
+ * its error here.
+ *
+ * @return An empty string on success, otherwise the error message.
+ */
+static std::string readCamerasRequest(const Napi::Object &args, CamerasRequest &request)
+{
+  if (!args.Has("files") || !args.Get("files").IsArray() || !args.Has("tsMilli"))
+  {
+    return "Missing files or tsMilli field";
+  }
+  request.tsMilli = args.Get("tsMilli").As<Napi::Number>().Int64Value();
+  request.bracket = args.Has("mode") && args.Get("mode").IsString() &&
+                    args.Get("mode").As<Napi::String>().Utf8Value() == "bracket";
+  auto fileArray = args.Get("files").As<Napi::Array>();
+  request.fetches.resize(fileArray.Length());
+  for (uint32_t i = 0; i < fileArray.Length(); i++)
+  {
+    auto &fetch = request.fetches[i];
+    fetch.file = fileArray.Get(i).As<Napi::String>().Utf8Value();
+    auto it = fileInfoMap.find(fetch.file);
+    if (it == fileInfoMap.end())
+    {
+      fetch.error = "File not open";
+      continue;
+    }
+    fetch.fileInfo = &it->second;
+    if (request.tsMilli < int64_t(it->second.firstFrameTimestampMilli) ||
+        request.tsMilli > int64_t(it->second.lastFrameTimestampMilli))
+    {
+      fetch.error = "Requested timestamp not within file bounds";
+      continue;
+    }
+    fetch.timestamps = timestampTableFor(it->second, fetch.file);
+  }
+  return "";
+}
+
+/**
+ * @brief Decodes and converts the frames of every camera without an error,
+ * one camera per lane of WorkerPool::files(). Each lane only touches its
+ * own reader, so this can run on a worker thread.
+ */
+static void fetchCameras(CamerasRequest &request)
+{
+  const int64_t tsMilli = request.tsMilli;
+  const bool bracket = request.bracket;
+  auto fetchCamera = [&](int i)
+  {
+    auto &fetch = request.fetches[i];
+    if (!fetch.error.empty())
+    {
+      return;
+    }
+    std::unique_lock<std::mutex> guard;
+    if (fetch.busy)
+    {
+      guard = std::unique_lock<std::mutex>(*fetch.busy);
+    }
+    auto &fileInfo = *fetch.fileInfo;
+    auto &reader = fileInfo.videoReader;
+    TimestampBounds bounds;
+    if (fetch.timestamps && fetch.timestamps->findBounds(tsMilli * 1000, bounds))
+    {
+      fetch.frameA = decodeFrameInfo(reader, fetch.file,
+                                     (double)reader->getFrameNumberForPts(bounds.ptsA));
+      fetch.frameB = decodeFrameInfo(reader, fetch.file,
+                                     (double)reader->getFrameNumberForPts(bounds.ptsB));
+    }
+    else if (fileInfo.numFrames >= 2)
+    {
+      const double span = std::max<double>(
+          1, (double)fileInfo.lastFrameTimestampMilli - fileInfo.firstFrameTimestampMilli);
+      const size_t guess = (size_t)((tsMilli - fileInfo.firstFrameTimestampMilli) / span *
+                                    (fileInfo.numFrames - 1));
+      std::tie(fetch.frameA, fetch.frameB) = findBoundingFrames(
+          reader, fetch.file, tsMilli, guess, fileInfo.numFrames, false);
+    }
+    else
+    {
+      fetch.frameA = decodeFrameInfo(reader, fetch.file, 1);
+      fetch.frameB = fetch.frameA;
+    }
+    if (!fetch.frameA || !fetch.frameB)
+    {
+      fetch.error = "Unable to find frames at requested time";
+      return;
+    }
+
+    const bool micro = fetch.frameA->tsMicro && fetch.frameB->tsMicro;
+    const double at = micro ? tsMilli * 1000.0 : (double)tsMilli;
+    const double a = micro ? fetch.frameA->tsMicro : fetch.frameA->timestamp;
+    const double b = micro ? fetch.frameB->tsMicro : fetch.frameB->timestamp;
+    fetch.fraction = b > a ? std::min(1.0, std::max(0.0, (at - a) / (b - a))) : 0;
+    if (!bracket && fetch.fraction > 0.5)
+    {
+      std::swap(fetch.frameA, fetch.frameB);
+    }
+    // Convert here so the pixel work is parallel too; the conversion itself
+    // splits across WorkerPool::shared().
+    fetch.frameA->rgba();
+    if (bracket)
+    {
+      fetch.frameB->rgba();
+    }
+  };
+  WorkerPool::files().parallelFor((int)request.fetches.size(), fetchCamera);
+}
+
+/** Sets the frames of a fetched grabFramesAtTime request on @p ret. */
+static void setCamerasFields(const Napi::Env &env, Napi::Object &ret,
+                             const CamerasRequest &request)
+{
+  auto frameObject = [&](const std::shared_ptr<FrameInfo> &frameInfo)
+  {
+    Napi::Object result = Napi::Object::New(env);
+    if (!frameInfo->data)
+    {
+      result.Set("status", Napi::String::New(env, "Unable to convert frame"));
+      return result;
+    }
+    frameInfoList.addFrame(frameInfo);
+    result.Set("data", Napi::Buffer<uint8_t>::Copy(env, frameInfo->data->data(),
+                                                   frameInfo->totalBytes));
+    result.Set("width", Napi::Number::New(env, frameInfo->width));
+    result.Set("height", Napi::Number::New(env, frameInfo->height));
+    result.Set("totalBytes", Napi::Number::New(env, frameInfo->totalBytes));
+    result.Set("format", Napi::String::New(env, "rgba"));
+    setFrameFields(env, result, frameInfo);
+    return result;
+  };
+  Napi::Array results = Napi::Array::New(env, request.fetches.size());
+  for (size_t i = 0; i < request.fetches.size(); i++)
+  {
+    const auto &fetch = request.fetches[i];
+    if (!fetch.error.empty())
+    {
+      Napi::Object result = Napi::Object::New(env);
+      result.Set("status", Napi::String::New(env, fetch.error));
+      result.Set("file", Napi::String::New(env, fetch.file));
+      results.Set((uint32_t)i, result);
+      continue;
+    }
+    auto result = frameObject(fetch.frameA);
+    if (request.bracket)
+    {
+      result.Set("next", frameObject(fetch.frameB));
+      result.Set("fraction", Napi::Number::New(env, fetch.fraction));
+    }
+    results.Set((uint32_t)i, result);
+  }
+  ret.Set("frames", results);
+}
+
+Napi::Object nativeVideoExecutor(const Napi::CallbackInfo &info)
+{
+  // std::cerr << "nativeVideoExecutor add-on" << std::endl;
+
   Napi::Env env = info.Env();
   Napi::Object ret = Napi::Object::New(env);
   ret.Set("status", Napi::String::New(env, "OK"));
@@ -350,20 +2704,241 @@ Napi::Object nativeVideoExecutor(const Napi::CallbackInfo &info)
   {
     debugLevel = args.Get("debugLevel").As<Napi::Number>().Int32Value();
   }
-  if (op == "setLogFile")
+  if (op == "setLogFile")
+  {
+    auto logFile = args.Get("logFile").As<Napi::String>().Utf8Value();
+    nativeLogStream.open(logFile, std::ios::app);
+    if (nativeLogStream.is_open())
+    {
+      std::cout.rdbuf(nativeLogStream.rdbuf());
+      std::cerr.rdbuf(nativeLogStream.rdbuf());
+      std::cerr << "C++ stdout/stderr redirected to " << logFile << std::endl;
+    }
+    return ret;
+  }
+
+  if (op == "closeFile")
+  {
+    if (!args.Has("file"))
+    {
+      Napi::TypeError::New(env, "Missing file field")
+          .ThrowAsJavaScriptException();
+      return ret;
+    }
+    auto file = args.Get("file").As<Napi::String>().Utf8Value();
+    auto it = fileInfoMap.find(file);
+    if (it == fileInfoMap.end())
+    {
+      std::cerr << "File not open opening " << file << std::endl;
+      Napi::TypeError::New(env, "File not open").ThrowAsJavaScriptException();
+      return ret;
+    }
+    closeFileInfo(file);
+    return ret;
+  }
+
+  if (op == "openTimeline")
+  {
+    TimelineRequest request;
+    auto error = readTimelineRequest(args, request);
+    if (error.empty())
+    {
+      const auto probes =
+          probeFilesConcurrently(request.probe.files, request.probe.concurrency);
+      error = openTimeline(env, ret, request, probes);
+      if (error.empty())
+      {
+        return ret;
+      }
+    }
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return ret;
+  }
+
+  if (op == "closeTimeline")
+  {
+    if (!args.Has("timeline"))
+    {
+      Napi::TypeError::New(env, "Missing timeline field")
+          .ThrowAsJavaScriptException();
+      return ret;
+    }
+    auto it = timelineMap.find(args.Get("timeline").As<Napi::String>().Utf8Value());
+    if (it == timelineMap.end())
+    {
+      Napi::TypeError::New(env, "Timeline not open").ThrowAsJavaScriptException();
+      return ret;
+    }
+    for (const auto &file : it->second.opened)
+    {
+      closeFileInfo(file);
+    }
+    timelineMap.erase(it);
+    return ret;
+  }
+
+  if (op == "openFile")
+  {
+    OpenRequest request;
+    auto error = readOpenRequest(args, request);
+    if (error.empty())
+    {
+      auto existing = fileInfoMap.find(request.file);
+      if (existing != fileInfoMap.end())
+      {
+        // std::cerr << "File already open, using existing file" << std::endl;
+        setExtentFields(env, ret, existing->second);
+        return ret;
+      }
+      error = openFileInfo(request.file, request.fast, request.ioMode, request.readAheadBytes);
+      if (error.empty())
+      {
+        setExtentFields(env, ret, fileInfoMap[request.file]);
+        return ret;
+      }
+    }
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return ret;
+  }
+
+  if (op == "refreshFile")
+  {
+    std::string file;
+    FileInfo *fileInfo = nullptr;
+    auto error = readOpenFile(args, file, fileInfo);
+    if (!error.empty())
+    {
+      Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+      return ret;
+    }
+    // While a request decodes the file, report the extent unchanged; the
+    // caller polls again.
+    RefreshResult result;
+    auto guard = tryLockFile(file);
+    if (guard.owns_lock())
+    {
+      refreshExtent(*fileInfo, result);
+    }
+    ret.Set("busy", Napi::Boolean::New(env, !guard.owns_lock()));
+    setRefreshFields(env, ret, *fileInfo, result);
+    return ret;
+  }
+
+  if (op == "probeFiles")
+  {
+    ProbeRequest request;
+    auto error = readProbeRequest(args, request);
+    if (!error.empty())
+    {
+      Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+      return ret;
+    }
+    setProbeFields(env, ret, request,
+                   probeFilesConcurrently(request.files, request.concurrency));
+    return ret;
+  }
+
+  if (op == "configureReader")
+  {
+    ReaderConfig config;
+    FileInfo *fileInfo = nullptr;
+    auto error = readReaderConfig(args, config, fileInfo);
+    if (error.empty())
+    {
+      auto guard = tryLockFile(config.file);
+      if (guard.owns_lock())
+      {
+        configureReader(*fileInfo, config);
+        return ret;
+      }
+      error = fileBusyError;
+    }
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return ret;
+  }
+
+  if (op == "readerStats")
+  {
+    if (!args.Has("file"))
+    {
+      Napi::TypeError::New(env, "Missing file field")
+          .ThrowAsJavaScriptException();
+      return ret;
+    }
+    auto file = args.Get("file").As<Napi::String>().Utf8Value();
+    auto it = fileInfoMap.find(file);
+    if (it == fileInfoMap.end())
+    {
+      Napi::TypeError::New(env, "File not open").ThrowAsJavaScriptException();
+      return ret;
+    }
+    auto guard = tryLockFile(file);
+    if (!guard.owns_lock())
+    {
+      Napi::TypeError::New(env, fileBusyError).ThrowAsJavaScriptException();
+      return ret;
+    }
+
+    const auto stats = it->second.videoReader->getFrameStoreStats();
+    ret.Set("status", Napi::String::New(env, "OK"));
+    ret.Set("frames", Napi::Number::New(env, static_cast<double>(stats.frames)));
+    ret.Set("bytes", Napi::Number::New(env, static_cast<double>(stats.bytes)));
+    ret.Set("budgetBytes", Napi::Number::New(env, static_cast<double>(stats.budgetBytes)));
+    ret.Set("maxFrames", Napi::Number::New(env, static_cast<double>(stats.maxFrames)));
+    ret.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+    ret.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+    ret.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+    ret.Set("reverseFrames",
+            Napi::Number::New(env, static_cast<double>(
+                                       it->second.videoReader->getReverseFrameCount())));
+    const auto &timestamps = it->second.timestamps;
+    ret.Set("timestampFrames",
+            Napi::Number::New(env, timestamps && timestamps->finished && timestamps->ok
+                                       ? (double)timestamps->table.size()
+                                       : 0.0));
+    // Cumulative since open; callers diff two snapshots for per-request cost.
+    const auto io = it->second.videoReader->getIOStats();
+    const auto ioMode = it->second.videoReader->getFileIOMode();
+    ret.Set("ioMode", Napi::String::New(env, ioMode == FileIOMode::ReadAhead ? "readahead"
+                                             : ioMode == FileIOMode::Mapped  ? "mmap"
+                                                                             : "default"));
+    ret.Set("ioBytes", Napi::Number::New(env, static_cast<double>(io.bytesRead)));
+    ret.Set("ioReads", Napi::Number::New(env, static_cast<double>(io.readCalls)));
+    ret.Set("ioSeeks", Napi::Number::New(env, static_cast<double>(io.seeks)));
+    ret.Set("cursors",
+            Napi::Number::New(env, static_cast<double>(it->second.cursors.openCursors())));
+    ret.Set("intraOnly", Napi::Boolean::New(env, it->second.videoReader->isIntraOnly()));
+    return ret;
+  }
+
+  if (op == "detectBowAtFrame")
   {
-    auto logFile = args.Get("logFile").As<Napi::String>().Utf8Value();
-    nativeLogStream.open(logFile, std::ios::app);
-    if (nativeLogStream.is_open())
+#ifndef RIFE_SUPPORTED
+    Napi::Error::New(env, "Bow number detection requires ONNX Runtime, which "
+                          "is not built for this platform")
+        .ThrowAsJavaScriptException();
+    return ret;
+#else
+    BowRequest request;
+    FileInfo *fileInfo = nullptr;
+    auto error = readBowRequest(args, request, fileInfo);
+    if (error.empty())
     {
-      std::cout.rdbuf(nativeLogStream.rdbuf());
-      std::cerr.rdbuf(nativeLogStream.rdbuf());
-      std::cerr << "C++ stdout/stderr redirected to " << logFile << std::endl;
+      auto guard = lockFile(request.videoFile);
+      BowResult result;
+      error = detectBow(*fileInfo, request, result);
+      if (error.empty())
+      {
+        setBowFields(env, ret, result);
+        return ret;
+      }
     }
+    Napi::Error::New(env, error).ThrowAsJavaScriptException();
     return ret;
+#endif
   }
 
-  if (op == "closeFile")
+  if (op == "getThumbnails")
   {
     if (!args.Has("file"))
     {
@@ -375,639 +2950,906 @@ Napi::Object nativeVideoExecutor(const Napi::CallbackInfo &info)
     auto it = fileInfoMap.find(file);
     if (it == fileInfoMap.end())
     {
-      std::cerr << "File not open opening " << file << std::endl;
       Napi::TypeError::New(env, "File not open").ThrowAsJavaScriptException();
       return ret;
     }
-    it->second.videoReader->closeFile();
-    fileInfoMap.erase(file);
+    auto &fileInfo = it->second;
+    uint32_t count = 100;
+    if (args.Has("count"))
+    {
+      count = (uint32_t)std::max(
+          1, std::min(args.Get("count").As<Napi::Number>().Int32Value(), 2000));
+    }
+    uint32_t thumbWidth = 160;
+    if (args.Has("width"))
+    {
+      thumbWidth = (uint32_t)std::max(
+          16, std::min(args.Get("width").As<Napi::Number>().Int32Value(), 1024));
+    }
+
+    // A previous atlas is mapped from disk; otherwise one is built from
+    // keyframes in the background and the caller polls until it is ready.
+    auto &job = fileInfo.thumbnails;
+    if (!job || job->count != count || job->thumbWidth != thumbWidth)
+    {
+      job.reset();
+      auto next = std::make_unique<ThumbnailJob>();
+      next->count = count;
+      next->thumbWidth = thumbWidth;
+      if (next->atlas.load(file, count, thumbWidth))
+      {
+        next->progress = (int)count;
+        next->ok = true;
+        next->finished = true;
+      }
+      else
+      {
+        ThumbnailPlan plan;
+        plan.videoFile = file;
+        plan.streamIndex = fileInfo.videoReader->getVideoStreamIndex();
+        plan.thumbWidth = thumbWidth;
+        // The keyframes are looked up on the builder thread too, since the
+        // reader may be busy decoding for a request.
+        auto build = [target = next.get(), reader = fileInfo.videoReader.get(),
+                      numFrames = (int64_t)fileInfo.numFrames, plan]() mutable
+        {
+          for (uint32_t i = 0; i < target->count && !target->cancel; i++)
+          {
+            // Tile i shows the middle of its 1/count slice of the file.
+            const int64_t frame = 1 + (int64_t)((i + 0.5) * numFrames / target->count);
+            int64_t keyframeTs = 0;
+            const int64_t keyframe = reader->getKeyframeNumber(frame, &keyframeTs);
+            if (keyframe < 1)
+            {
+              std::cerr << "Thumbnails need a frame index: " << plan.videoFile << std::endl;
+              break;
+            }
+            plan.frameNumbers.push_back(keyframe);
+            plan.keyframeTs.push_back(keyframeTs);
+          }
+          target->ok = plan.frameNumbers.size() == target->count &&
+                       target->atlas.build(plan, target->cancel, target->progress);
+          target->finished = true;
+        };
+        next->thread = std::thread(build);
+      }
+      job = std::move(next);
+    }
+
+    ret.Set("count", Napi::Number::New(env, job->count));
+    ret.Set("progress", Napi::Number::New(env, job->progress.load()));
+    if (!job->finished)
+    {
+      ret.Set("state", Napi::String::New(env, "building"));
+      return ret;
+    }
+    if (!job->ok)
+    {
+      ret.Set("state", Napi::String::New(env, "failed"));
+      return ret;
+    }
+
+    const auto &layout = job->atlas.layout();
+    ret.Set("state", Napi::String::New(env, "ready"));
+    ret.Set("data", Napi::Buffer<uint8_t>::Copy(env, job->atlas.pixels(),
+                                                layout.bytes()));
+    ret.Set("width", Napi::Number::New(env, layout.width()));
+    ret.Set("height", Napi::Number::New(env, layout.height()));
+    ret.Set("thumbWidth", Napi::Number::New(env, layout.thumbWidth));
+    ret.Set("thumbHeight", Napi::Number::New(env, layout.thumbHeight));
+    ret.Set("columns", Napi::Number::New(env, layout.columns));
+    ret.Set("rows", Napi::Number::New(env, layout.rows));
+    Napi::Array frameNumbers = Napi::Array::New(env, layout.count);
+    for (uint32_t i = 0; i < layout.count; i++)
+    {
+      frameNumbers.Set(i, Napi::Number::New(env, (double)job->atlas.frameNumbers()[i]));
+    }
+    ret.Set("frameNumbers", frameNumbers);
     return ret;
   }
 
-  if (op == "openFile")
+  if (op == "grabFramesAtTime")
   {
-    if (!args.Has("file"))
+    CamerasRequest request;
+    auto error = readCamerasRequest(args, request);
+    if (!error.empty())
     {
-      Napi::TypeError::New(env, "Missing file field")
-          .ThrowAsJavaScriptException();
+      Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
       return ret;
     }
-    auto file = args.Get("file").As<Napi::String>().Utf8Value();
+    // Async requests for these files wait until the lanes are done. A file
+    // an async request is decoding is reported busy rather than waited for.
+    std::map<std::string, bool> locked;
+    std::vector<std::unique_lock<std::mutex>> fileLocks;
+    for (auto &fetch : request.fetches)
+    {
+      if (!fetch.error.empty())
+      {
+        continue;
+      }
+      auto lock = locked.find(fetch.file);
+      if (lock == locked.end())
+      {
+        fileLocks.push_back(tryLockFile(fetch.file));
+        lock = locked.emplace(fetch.file, fileLocks.back().owns_lock()).first;
+      }
+      if (!lock->second)
+      {
+        fetch.error = fileBusyError;
+      }
+    }
+    fetchCameras(request);
+    setCamerasFields(env, ret, request);
+    return ret;
+  }
 
-    if (fileInfoMap.count(file))
+  if (op == "grabFrameAt")
+  {
+    GrabRequest request;
+    FileInfo *fileInfo = nullptr;
+    auto error = readGrabRequest(args.Get("request").As<Napi::Object>(), request, fileInfo);
+    if (error.empty() && request.open)
     {
-      // std::cerr << "File already open, using existing file" << std::endl;
-      ret.Set("status", Napi::String::New(env, "OK"));
-      return ret;
+      // This op blocks its caller anyway, so the segment is opened here.
+      error = openSegment(*request.open);
+      fileInfo = error.empty() ? adoptSegment(*request.open) : nullptr;
+    }
+    if (error.empty())
+    {
+      auto guard = lockFile(request.file);
+      GrabResult result;
+      error = grabFrame(*fileInfo, request, result);
+      if (error.empty())
+      {
+        setGrabFields(env, ret, request, result);
+        return ret;
+      }
     }
+    Napi::TypeError::New(env, error).ThrowAsJavaScriptException();
+    return ret;
+  }
 
-    std::unique_ptr<FFVideoReader> ffreader(new FFVideoReader());
-    auto error = ffreader->openFile(file);
-    if (error)
+  if (op == "sendMulticast")
+  {
+    if (!args.Has("dest"))
+    {
+      Napi::TypeError::New(env, "Missing dest ip field")
+          .ThrowAsJavaScriptException();
+      return ret;
+    }
+    if (!args.Has("port"))
     {
-      Napi::TypeError::New(env, "Failed to open file")
+      Napi::TypeError::New(env, "Missing port field")
           .ThrowAsJavaScriptException();
       return ret;
     }
-
-    auto frameA = getFrame(ffreader, file, 1);
-    if (!frameA)
+    if (!args.Has("msg"))
     {
-      Napi::TypeError::New(env, "Unable to get first frame info")
+      Napi::TypeError::New(env, "Missing msg field")
           .ThrowAsJavaScriptException();
       return ret;
     }
-    // On VFR files, r_frame_rate can disagree with nb_frames / duration by
-    // up to ~1%, so the last requestable frame index (via dts_to_frame_number
-    // = fps * seconds) can fall short of nb_frames by up to 1% of nb_frames.
-    // Allow retries over that window (with a floor of 200 for short clips).
-    std::shared_ptr<FrameInfo> frameB;
-    const int maxBack =
-        std::max(200, static_cast<int>(frameA->numFrames / 50)); // up to 2%
-    // Exponential probe to find any reachable back-offset, then bisect to
-    // find the smallest passing back. Each getFrame() failure near EOF is
-    // expensive (full av_seek_frame + forward-decode), so linear walkback
-    // is O(maxBack) seeks — this is O(log maxBack).
-    int lo = -1; // largest known-failing back (-1 = none tried)
-    int hi = -1; // smallest known-passing back (-1 = none found)
-    for (int probe = 0; probe <= maxBack; probe = probe == 0 ? 1 : probe * 2)
-    {
-      auto f = getFrame(ffreader, file, frameA->numFrames - probe);
-      if (f)
+    auto dest = args.Get("dest").As<Napi::String>().Utf8Value();
+    auto port = args.Get("port").As<Napi::Number>().Uint32Value();
+    auto msg = args.Get("msg").As<Napi::String>().Utf8Value();
+
+    auto error = sendMulticast(msg, dest, port);
+    if (error == 0)
+    {
+      ret.Set("status", Napi::String::New(env, "OK"));
+    }
+    else
+    {
+      ret.Set("status", Napi::String::New(env, "Failed"));
+    }
+    return ret;
+  }
+
+  Napi::TypeError::New(env, "Unrecognized op field")
+      .ThrowAsJavaScriptException();
+
+  return ret;
+}
+
+/**
+ * @class FileJob
+ * @brief An op decoded on a libuv worker thread that settles a Promise.
+ *
+ * Requests for the same file run one at a time in arrival order, queued in
+ * fileQueues; requests for different files run concurrently. run() does the
+ * work without touching JS values and respond() builds the result on the
+ * main thread.
+ *
+ * A job with a view is replaced by the next job for the same view: if still
+ * queued it is dropped, if running its decode is cancelled between frames.
+ * Either way its Promise rejects with "Superseded", so a burst of scrub
+ * requests costs at most the one decode already under way.
+ */
+class FileJob : public Napi::AsyncWorker
+{
+public:
+  FileJob(const Napi::Env &env, const std::string &file, const std::string &view = "")
+      : Napi::AsyncWorker(env), file(file), view(view),
+        deferred(Napi::Promise::Deferred::New(env))
+  {
+  }
+
+  /** Replaces older jobs for the view, then queues behind earlier requests. */
+  Napi::Promise start()
+  {
+    if (!view.empty())
+    {
+      supersede();
+    }
+    auto &queue = fileQueues[file];
+    busy = &queue.busy;
+    if (queue.current)
+    {
+      queue.pending.push_back(this);
+    }
+    else
+    {
+      queue.current = this;
+      dispatch();
+    }
+    return deferred.Promise();
+  }
+
+  /** Like start(), for work nobody waits on: its Promise never settles. */
+  void startInBackground()
+  {
+    background = true;
+    start();
+  }
+
+protected:
+  /** @return An empty string on success, otherwise the error message. */
+  virtual std::string run() = 0;
+  virtual void respond(const Napi::Env &env, Napi::Object &ret) = 0;
+  /** Runs on the main thread just before the job goes to a worker thread. */
+  virtual void prepare() {}
+
+  void Execute() override
+  {
+    std::lock_guard<std::mutex> guard(*busy);
+    DecodeCancelScope scope(&cancel);
+    auto error = cancel ? std::string() : run();
+    if (cancel)
+    {
+      error = supersededError;
+    }
+    if (!error.empty())
+    {
+      SetError(error);
+    }
+  }
+
+  void OnOK() override
+  {
+    Napi::Env env = Env();
+    Napi::Object ret = Napi::Object::New(env);
+    ret.Set("status", Napi::String::New(env, "OK"));
+    respond(env, ret);
+    if (!background)
+    {
+      deferred.Resolve(ret);
+    }
+    finish();
+  }
+
+  void OnError(const Napi::Error &error) override
+  {
+    if (!background)
+    {
+      deferred.Reject(error.Value());
+    }
+    finish();
+  }
+
+  const std::string file;
+
+private:
+  /**
+   * @brief Drops queued jobs for this view and cancels a running one, in
+   * every file so a timeline view that moved to another segment is covered.
+   */
+  void supersede()
+  {
+    for (auto &entry : fileQueues)
+    {
+      auto &queue = entry.second;
+      if (queue.current && queue.current->view == view)
       {
-        frameB = f;
-        hi = probe;
-        break;
+        queue.current->cancel = true;
       }
-      lo = probe;
-      if (probe == 0)
+      for (auto it = queue.pending.begin(); it != queue.pending.end();)
       {
-        std::cerr << "Unable to read frame " << frameA->numFrames
-                  << ". Walking back up to " << maxBack << " frames..."
-                  << std::endl;
+        if ((*it)->view != view)
+        {
+          ++it;
+          continue;
+        }
+        // Never queued, so it is deleted here rather than after OnError.
+        auto *job = *it;
+        it = queue.pending.erase(it);
+        if (!job->background)
+        {
+          job->deferred.Reject(Napi::Error::New(Env(), supersededError).Value());
+        }
+        delete job;
       }
-      if (probe >= maxBack) break;
     }
-    while (lo >= 0 && hi - lo > 1)
+  }
+
+  /** Starts the next queued request for the file once this one has settled. */
+  void finish()
+  {
+    auto it = fileQueues.find(file);
+    if (it == fileQueues.end())
     {
-      int mid = lo + (hi - lo) / 2;
-      auto f = getFrame(ffreader, file, frameA->numFrames - mid);
-      if (f)
-      {
-        frameB = f;
-        hi = mid;
-      }
-      else
+      return;
+    }
+    auto &queue = it->second;
+    if (!queue.pending.empty())
+    {
+      queue.current = queue.pending.front();
+      queue.pending.pop_front();
+      queue.current->dispatch();
+      return;
+    }
+    queue.current = nullptr;
+    if (queue.cameraJobs == 0)
+    {
+      fileQueues.erase(it);
+    }
+  }
+
+  void dispatch()
+  {
+    prepare();
+    Queue();
+  }
+
+  const std::string view;
+  Napi::Promise::Deferred deferred;
+  bool background = false;
+  std::mutex *busy = nullptr;
+  std::atomic<bool> cancel{false};
+};
+
+/**
+ * @class SegmentJob
+ * @brief A FileJob on a timeline segment that may not be open yet.
+ *
+ * Such a segment is opened on the worker thread first, where a newer
+ * request for the view cannot cancel it, and joins the open files on the
+ * main thread even if the rest of the job fails, so the open is never
+ * repeated. A job queued behind another open of the segment uses that one.
+ */
+class SegmentJob : public FileJob
+{
+public:
+  SegmentJob(const Napi::Env &env, const std::string &file, const std::string &view,
+             FileInfo *fileInfo, std::unique_ptr<SegmentOpen> open)
+      : FileJob(env, file, view), fileInfo(fileInfo), open(std::move(open))
+  {
+  }
+
+protected:
+  /** The job's work on the open segment; see FileJob::run(). */
+  virtual std::string runOn(FileInfo &fileInfo) = 0;
+
+  void prepare() override
+  {
+    auto it = open ? fileInfoMap.find(file) : fileInfoMap.end();
+    if (it != fileInfoMap.end())
+    {
+      fileInfo = &it->second;
+      open.reset();
+    }
+  }
+
+  std::string run() override
+  {
+    if (open)
+    {
+      DecodeCancelScope opening(nullptr);
+      auto error = openSegment(*open);
+      if (!error.empty())
       {
-        lo = mid;
+        return error;
       }
+      fileInfo = &open->info;
     }
-    if (!frameB)
+    return runOn(*fileInfo);
+  }
+
+  void OnOK() override
+  {
+    adopt();
+    FileJob::OnOK();
+  }
+
+  void OnError(const Napi::Error &error) override
+  {
+    adopt();
+    FileJob::OnError(error);
+  }
+
+private:
+  void adopt()
+  {
+    if (open && open->opened)
     {
-      Napi::TypeError::New(env, "Unable to get last frame info")
-          .ThrowAsJavaScriptException();
-      return ret;
+      adoptSegment(*open);
     }
-    ret.Set("status", Napi::String::New(env, "OK"));
-    // std::cerr << "timestamps = " << frameA->timestamp << "," << frameA->tsMicro << " - " << frameB->timestamp << "," << frameB->tsMicro << std::endl;
+  }
+
+  FileInfo *fileInfo;
+  std::unique_ptr<SegmentOpen> open;
+};
+
+class GrabFrameJob : public SegmentJob
+{
+public:
+  GrabFrameJob(const Napi::Env &env, GrabRequest request, FileInfo *fileInfo)
+      : SegmentJob(env, request.file, request.view, fileInfo, std::move(request.open)),
+        request(std::move(request))
+  {
+  }
+
+protected:
+  std::string runOn(FileInfo &fileInfo) override
+  {
+    return grabFrame(fileInfo, request, result);
+  }
+  void respond(const Napi::Env &env, Napi::Object &ret) override
+  {
+    setGrabFields(env, ret, request, result);
+  }
+
+private:
+  GrabRequest request;
+  GrabResult result;
+};
+
+/**
+ * A decode queued by queueWarmup(). Its view is the file's, so a warm-up
+ * of the segment's other end replaces it.
+ */
+class WarmFrameJob : public SegmentJob
+{
+public:
+  WarmFrameJob(const Napi::Env &env, const std::string &file, FileInfo *fileInfo,
+               std::unique_ptr<SegmentOpen> open, int64_t frameNum)
+      : SegmentJob(env, file, "warmup:" + file, fileInfo, std::move(open)),
+        frameNum(frameNum)
+  {
+  }
+
+protected:
+  std::string runOn(FileInfo &fileInfo) override
+  {
+    fileInfo.videoReader->getDecodedFrame(frameNum > 0 ? frameNum : fileInfo.numFrames,
+                                          false);
+    return "";
+  }
+  void respond(const Napi::Env &, Napi::Object &) override {}
+
+private:
+  const int64_t frameNum;
+};
+
+static void queueWarmup(const Napi::Env &env, const std::string &file,
+                        std::unique_ptr<SegmentOpen> open, int64_t frameNum)
+{
+  auto it = fileInfoMap.find(file);
+  FileInfo *fileInfo = it != fileInfoMap.end() ? &it->second : nullptr;
+  (new WarmFrameJob(env, file, fileInfo, std::move(open), frameNum))->startInBackground();
+}
+
+class OpenFileJob : public FileJob
+{
+public:
+  OpenFileJob(const Napi::Env &env, OpenRequest request)
+      : FileJob(env, request.file), request(std::move(request))
+  {
+  }
+
+protected:
+  std::string run() override
+  {
+    return buildFileInfo(request.file, request.fast, request.ioMode,
+                         request.readAheadBytes, info);
+  }
+  void respond(const Napi::Env &env, Napi::Object &ret) override
+  {
+    // An earlier open of the same file wins; this reader is dropped.
+    auto it = fileInfoMap.find(file);
+    if (it == fileInfoMap.end())
+    {
+      it = fileInfoMap.emplace(file, std::move(info)).first;
+    }
+    setExtentFields(env, ret, it->second);
+  }
+
+private:
+  OpenRequest request;
+  FileInfo info;
+};
+
+class RefreshFileJob : public FileJob
+{
+public:
+  RefreshFileJob(const Napi::Env &env, const std::string &file, FileInfo *fileInfo)
+      : FileJob(env, file), fileInfo(fileInfo)
+  {
+  }
+
+protected:
+  std::string run() override
+  {
+    refreshExtent(*fileInfo, result);
+    return "";
+  }
+  void respond(const Napi::Env &env, Napi::Object &ret) override
+  {
+    ret.Set("busy", Napi::Boolean::New(env, false));
+    setRefreshFields(env, ret, *fileInfo, result);
+  }
 
-    // Fill in the FileInfo struct
-    FileInfo info;
-    info.videoReader = std::move(ffreader);
-    info.firstFrameTimestampMilli = frameA->timestamp;
-    info.lastFrameTimestampMilli = frameB->timestamp;
-    info.numFrames = frameB->frameNum;
+private:
+  FileInfo *fileInfo;
+  RefreshResult result;
+};
 
-    // Insert into the map with a filename as the key
-    fileInfoMap[file] = std::move(info);
-    return ret;
+class ConfigureReaderJob : public FileJob
+{
+public:
+  ConfigureReaderJob(const Napi::Env &env, ReaderConfig config, FileInfo *fileInfo)
+      : FileJob(env, config.file), config(std::move(config)), fileInfo(fileInfo)
+  {
   }
 
-  if (op == "detectBowAtFrame")
+protected:
+  std::string run() override
   {
-#ifndef RIFE_SUPPORTED
-    Napi::Error::New(env, "Bow number detection requires ONNX Runtime, which "
-                          "is not built for this platform")
-        .ThrowAsJavaScriptException();
-    return ret;
-#else
-    try
-    {
-      if (!args.Has("request") || !args.Get("request").IsObject())
-      {
-        throw std::invalid_argument("Missing bow detection request");
-      }
-      const auto request = args.Get("request").As<Napi::Object>();
-      if (!request.Has("videoFile") || !request.Has("frameNum") ||
-          !request.Has("boatModelFile") || !request.Has("cardModelFile") ||
-          !request.Has("numberModelFile"))
-      {
-        throw std::invalid_argument(
-            "Bow detection requires videoFile, frameNum, boatModelFile, "
-            "cardModelFile, and numberModelFile");
-      }
-
-      const std::string videoFile =
-          request.Get("videoFile").As<Napi::String>().Utf8Value();
-      const std::string boatModelFile =
-          request.Get("boatModelFile").As<Napi::String>().Utf8Value();
-      const std::string cardModelFile =
-          request.Get("cardModelFile").As<Napi::String>().Utf8Value();
-      const std::string numberModelFile =
-          request.Get("numberModelFile").As<Napi::String>().Utf8Value();
-      const double frameNum =
-          request.Get("frameNum").As<Napi::Number>().DoubleValue();
-      const bool closeTo =
-          request.Has("closeTo") &&
-          request.Get("closeTo").As<Napi::Boolean>().Value();
-      const bool detectCardsWithoutBoat =
-          request.Has("detectCardsWithoutBoat") &&
-          request.Get("detectCardsWithoutBoat").As<Napi::Boolean>().Value();
-
-      const auto file = fileInfoMap.find(videoFile);
-      if (file == fileInfoMap.end())
-      {
-        throw std::invalid_argument("Video file is not open");
-      }
+    configureReader(*fileInfo, config);
+    return "";
+  }
+  void respond(const Napi::Env &, Napi::Object &) override {}
 
-      const auto frame =
-          getFrame(file->second.videoReader, videoFile, frameNum, closeTo);
-      if (!frame)
-      {
-        throw std::runtime_error(
-            "Unable to read frame " + std::to_string(frameNum));
-      }
+private:
+  ReaderConfig config;
+  FileInfo *fileInfo;
+};
 
-      const std::string pipelineKey =
-          boatModelFile + "|" + cardModelFile + "|" + numberModelFile;
-      auto pipelineEntry = bowNumberPipelineMap.find(pipelineKey);
-      if (pipelineEntry == bowNumberPipelineMap.end())
-      {
-        pipelineEntry =
-            bowNumberPipelineMap
-                .emplace(pipelineKey,
-                        new BowNumberPipeline(boatModelFile, cardModelFile,
-                                              numberModelFile))
-                .first;
-      }
+/**
+ * @class ProbeJob
+ * @brief Probes files on a libuv worker thread and settles a Promise.
+ *
+ * Probing opens its own readers and touches no open file, so unlike FileJob
+ * it is not queued behind other requests. respond() uses the probes on the
+ * main thread.
+ */
+class ProbeJob : public Napi::AsyncWorker
+{
+public:
+  ProbeJob(const Napi::Env &env, ProbeRequest request)
+      : Napi::AsyncWorker(env), request(std::move(request)),
+        deferred(Napi::Promise::Deferred::New(env))
+  {
+  }
 
-      const auto detectionFrame = pruneFrame(frame, request);
-      const cv::Mat rgba(detectionFrame->height, detectionFrame->width, CV_8UC4,
-                         detectionFrame->data->data(), detectionFrame->linesize);
-      ret.Set("frameNum", Napi::Number::New(env, frame->frameNum));
-      ret.Set("timestamp", Napi::Number::New(env, frame->timestamp));
+  Napi::Promise start()
+  {
+    Queue();
+    return deferred.Promise();
+  }
 
-      const auto makeBox = [&env](const cv::Rect &box)
-      {
-        Napi::Object value = Napi::Object::New(env);
-        value.Set("x", Napi::Number::New(env, box.x));
-        value.Set("y", Napi::Number::New(env, box.y));
-        value.Set("width", Napi::Number::New(env, box.width));
-        value.Set("height", Napi::Number::New(env, box.height));
-        return value;
-      };
-      std::vector<BowNumberDetection> detections;
-      if (request.Has("point"))
-      {
-        const auto pointObject = request.Get("point").As<Napi::Object>();
-        const cv::Point pointOfInterest(
-            pointObject.Get("x").As<Napi::Number>().Int32Value(),
-            pointObject.Get("y").As<Napi::Number>().Int32Value());
-        detections.push_back(
-            pipelineEntry->second->detect(rgba, pointOfInterest,
-                                          detectCardsWithoutBoat));
-      }
-      else
-      {
-        detections = pipelineEntry->second->detectAll(
-            rgba, detectCardsWithoutBoat);
-      }
+protected:
+  /** @return An empty string on success, otherwise the error message. */
+  virtual std::string respond(const Napi::Env &env, Napi::Object &ret) = 0;
 
-      Napi::Array detectionValues = Napi::Array::New(env, detections.size());
-      for (size_t index = 0; index < detections.size(); ++index)
-      {
-        const auto &detection = detections[index];
-        Napi::Object value = Napi::Object::New(env);
-        value.Set("text", Napi::String::New(env, detection.text));
-        value.Set("confidence",
-                  Napi::Number::New(env, detection.confidence));
-        value.Set("box", makeBox(detection.cardBox));
-        value.Set("boatBox", makeBox(detection.boatBox));
-        detectionValues.Set(index, value);
-      }
-      ret.Set("detections", detectionValues);
-      return ret;
-    }
-    catch (const std::exception &error)
-    {
-      Napi::Error::New(env, error.what()).ThrowAsJavaScriptException();
-      return ret;
-    }
-#endif
+  void Execute() override
+  {
+    probes = probeFilesConcurrently(request.files, request.concurrency);
   }
 
-  if (op == "grabFrameAt")
+  void OnOK() override
   {
-    auto request = args.Get("request").As<Napi::Object>();
-    if (!request.Has("frameNum"))
-    {
-      Napi::TypeError::New(env, "Missing frameNum field")
-          .ThrowAsJavaScriptException();
-      return ret;
-    }
-    if (!request.Has("videoFile"))
-    {
-      Napi::TypeError::New(env, "Missing videoFile field")
-          .ThrowAsJavaScriptException();
-      return ret;
-    }
-    auto file = request.Get("videoFile").As<Napi::String>().Utf8Value();
-    auto frameNum = request.Get("frameNum").As<Napi::Number>().DoubleValue();
-    // std::cerr << "Grabbing frame at " << frameNum << std::endl;
-    auto tsMilli = request.Get("tsMilli").As<Napi::Number>().Int64Value();
-    auto it = fileInfoMap.find(file);
-    if (it == fileInfoMap.end())
-    {
-      std::cerr << "File not open opening " << file << std::endl;
-      Napi::TypeError::New(env, "File not open").ThrowAsJavaScriptException();
-      return ret;
-    }
-    auto &fileInfo = it->second;
-
-    auto roi = noZoom;
-    std::string saveAs;
-    if (request.Has("saveAs"))
+    Napi::Env env = Env();
+    Napi::Object ret = Napi::Object::New(env);
+    ret.Set("status", Napi::String::New(env, "OK"));
+    auto error = respond(env, ret);
+    if (error.empty())
     {
-      saveAs = request.Get("saveAs").As<Napi::String>().Utf8Value();
+      deferred.Resolve(ret);
     }
-    if (debugLevel > 1)
+    else
     {
-      std::cout << "saveAs: " << saveAs << ", frameNum: " << frameNum << ", tsMilli: " << tsMilli << ", file:" << file << std::endl;
+      deferred.Reject(Napi::TypeError::New(env, error).Value());
     }
+  }
 
-    if (request.Has("zoom") && request.Get("zoom").IsObject())
-    {
-      auto zoom = request.Get("zoom").As<Napi::Object>();
-      auto x = zoom.Get("x").As<Napi::Number>().Int32Value();
-      auto y = zoom.Get("y").As<Napi::Number>().Int32Value();
-      auto zwidth = zoom.Get("width").As<Napi::Number>().Int32Value();
-      auto zheight = zoom.Get("height").As<Napi::Number>().Int32Value();
-      roi = {x, y, zwidth, zheight};
-      if (debugLevel > 1)
-      {
-        std::cout << "roi: " << roi.x << "," << roi.y << " " << roi.width << "x"
-                  << roi.height << std::endl;
-      }
-    }
-    auto blend =
-        request.Has("blend") && request.Get("blend").As<Napi::Boolean>().Value();
-    auto closeTo =
-        request.Has("closeTo") && request.Get("closeTo").As<Napi::Boolean>().Value();
+  void OnError(const Napi::Error &error) override { deferred.Reject(error.Value()); }
 
-    std::string interpMethod = "blend";
-    if (request.Has("interpMethod"))
-    {
-      interpMethod = request.Get("interpMethod").As<Napi::String>().Utf8Value();
-    }
-    std::string rifeModelFile;
-    if (request.Has("modelFile"))
-    {
-      rifeModelFile = request.Get("modelFile").As<Napi::String>().Utf8Value();
-    }
-    auto rifeCrop = noZoom;
-    auto hasRifeCrop = false;
-    if (request.Has("crop") && request.Get("crop").IsObject())
-    {
-      auto cropObj = request.Get("crop").As<Napi::Object>();
-      auto x = cropObj.Get("x").As<Napi::Number>().Int32Value();
-      auto y = cropObj.Get("y").As<Napi::Number>().Int32Value();
-      auto cwidth = cropObj.Get("width").As<Napi::Number>().Int32Value();
-      auto cheight = cropObj.Get("height").As<Napi::Number>().Int32Value();
-      rifeCrop = {x, y, cwidth, cheight};
-      hasRifeCrop = (rifeCrop.width > 0) && (rifeCrop.height > 0);
-    }
+  const ProbeRequest request;
+  std::vector<FileProbe> probes;
 
-    auto hasZoom =
-        (roi.width > 0) && (roi.height > 0) && ((roi.x > 0 || roi.y > 0));
+private:
+  Napi::Promise::Deferred deferred;
+};
 
-    auto key = formatKey(file, frameNum, hasZoom, roi, closeTo);
-    if (interpMethod == "rife")
-    {
-      key += "-rife-" + std::to_string(rifeCrop.x) + "-" +
-             std::to_string(rifeCrop.y) + "-" + std::to_string(rifeCrop.width) +
-             "-" + std::to_string(rifeCrop.height);
-    }
-    auto frameInfo = frameInfoList.getFrame(key);
-    if (!frameInfo)
-    {
-      // Only meant to absorb float representation noise (e.g. 123.9999997
-      // meaning "really frame 124"), not real fractional requests -- a wider
-      // tolerance here silently skips interpolation/RIFE near integer frames
-      // and returns the raw decode instead, which is visibly different
-      // (sharper/less blended) and shows up as a jump right at the boundary.
-      constexpr double kIntegerFrameEpsilon = 1e-3;
-      // Nothing in cache, generate a new result
-      auto intPart = static_cast<int>(frameNum);
-      double fractionalPart = frameNum - intPart; // Extract fractional part
-      auto fractionalFrame =
-          ((fractionalPart > kIntegerFrameEpsilon) &&
-           (fractionalPart < 1.0 - kIntegerFrameEpsilon));
-      if (!fractionalFrame)
-      {
-        intPart = std::round(
-            frameNum); // ensure a frameNum like 123.9999 ends up 124.
-      }
+class ProbeFilesJob : public ProbeJob
+{
+public:
+  using ProbeJob::ProbeJob;
 
-      if (tsMilli)
-      {
-        if (tsMilli < int64_t(fileInfo.firstFrameTimestampMilli) || tsMilli > int64_t(fileInfo.lastFrameTimestampMilli))
-        {
-          std::string msg = "Requested timestamp " + std::to_string(tsMilli) + " not within file bounds: " + "[" + std::to_string(fileInfo.firstFrameTimestampMilli) + "," + std::to_string(fileInfo.lastFrameTimestampMilli) + "]";
-          std::cerr << msg << std::endl;
-          Napi::TypeError::New(env, msg.c_str()).ThrowAsJavaScriptException();
-          return ret;
-        }
-        // find frames on either side of requested time
-        float delta = fileInfo.lastFrameTimestampMilli - fileInfo.firstFrameTimestampMilli;
-        auto seekFrameFloat = delta <= 0 ? 1 : 1 + ((tsMilli - fileInfo.firstFrameTimestampMilli) / delta) * (fileInfo.numFrames - 1);
-        intPart = static_cast<int>(seekFrameFloat);
-        fractionalPart = seekFrameFloat - intPart; // Extract fractional part
-        fractionalFrame =
-            ((fractionalPart > kIntegerFrameEpsilon) &&
-             (fractionalPart < 1.0 - kIntegerFrameEpsilon));
+protected:
+  std::string respond(const Napi::Env &env, Napi::Object &ret) override
+  {
+    setProbeFields(env, ret, request, probes);
+    return "";
+  }
+};
 
-        auto [frameA, frameB] = findBoundingFrames(fileInfo.videoReader, file, tsMilli, intPart, fileInfo.numFrames);
+class OpenTimelineJob : public ProbeJob
+{
+public:
+  OpenTimelineJob(const Napi::Env &env, TimelineRequest timeline)
+      : ProbeJob(env, timeline.probe), timeline(std::move(timeline))
+  {
+  }
 
-        if (frameA && frameB)
-        {
+protected:
+  std::string respond(const Napi::Env &env, Napi::Object &ret) override
+  {
+    return openTimeline(env, ret, timeline, probes);
+  }
 
-          if (debugLevel > 1)
-          {
-            std::cerr << "Found bounding frames at " << frameA->frameNum << ", " << frameB->frameNum << std::endl;
-          }
-          intPart = frameA->frameNum;
-          float delta = frameB->timestamp - frameA->timestamp;
-          if (delta <= 0)
-          {
-            std::string msg = "Malformed video frames detected at frame " + std::to_string(frameA->frameNum) + " and " + std::to_string(frameB->frameNum);
-            std::cerr << msg << std::endl;
-            Napi::TypeError::New(env, msg.c_str()).ThrowAsJavaScriptException();
-            return ret;
-          }
+private:
+  TimelineRequest timeline;
+};
 
-          fractionalPart = (tsMilli - frameA->timestamp) / delta;
-          seekFrameFloat = intPart + fractionalPart;
-          fractionalFrame =
-              ((fractionalPart > kIntegerFrameEpsilon) &&
-               (fractionalPart < 1.0 - kIntegerFrameEpsilon));
-        }
-      }
+/**
+ * @class CamerasJob
+ * @brief Runs a grabFramesAtTime request on a libuv worker thread and
+ * settles a Promise.
+ *
+ * The files are not queued: each lane takes its file's busy lock while it
+ * fetches, so the request waits for a decode under way on that file rather
+ * than reporting it busy. Counting the job in each file's queue keeps the
+ * lock and the FileInfo alive should the file be closed meanwhile.
+ */
+class CamerasJob : public Napi::AsyncWorker
+{
+public:
+  CamerasJob(const Napi::Env &env, CamerasRequest request)
+      : Napi::AsyncWorker(env), request(std::move(request)),
+        deferred(Napi::Promise::Deferred::New(env))
+  {
+  }
 
-      if (fractionalFrame)
+  Napi::Promise start()
+  {
+    for (auto &fetch : request.fetches)
+    {
+      if (fetch.error.empty())
       {
-        auto frameA = getFrame(fileInfo.videoReader, file, intPart);
-        auto frameB = getFrame(fileInfo.videoReader, file, intPart + 1);
-        if (frameA && frameB)
-        {
-          if (tsMilli)
-          {
-            // refine the fractional part now that we know the exact frame times
-            // involved.
-            fractionalPart = double(tsMilli * 1000 - frameA->tsMicro) /
-                             (frameB->tsMicro - frameA->tsMicro);
-            // std::cout << "tsMilli=" << tsMilli << " A ts=" << frameA->tsMicro
-            //           << " B ts=" << frameB->tsMicro
-            //           << " frac=" << fractionalPart << std::endl;
-            // std::cout << tsMilli << std::endl
-            //           << frameA->tsMicro << std::endl
-            //           << frameB->tsMicro << std::endl;
-            if (std::abs(fractionalPart) >= 1.0)
-            {
-              std::cout << "Restricting fractional part to 1.0" << std::endl;
-              fractionalPart = 0;
-            }
-          }
-          if (!hasZoom)
-          {
-            // GE: If we have no zoom do we want to trigger interpolate?
-            std::cout << "Not zooming.  restricting roi"
-                      << " roi width=" << roi.width << std::endl;
-            // Use a slice around the center
-            auto width = std::min(frameA->width, 256);
-            roi = {frameA->width / 2 - width / 2, 0, width, frameA->height};
-          }
-          // range check roi
+        auto &queue = fileQueues[fetch.file];
+        queue.cameraJobs++;
+        fetch.busy = &queue.busy;
+      }
+    }
+    Queue();
+    return deferred.Promise();
+  }
 
-          roi.width = std::min(roi.width, frameA->width);
-          roi.height = std::min(roi.height, frameA->height);
-          roi.x = std::max(0, roi.x);
-          roi.y = std::max(0, roi.y);
-          if (roi.x + roi.width > frameA->width)
-          {
-            roi.x = frameA->width - roi.width;
-          }
-          if (roi.y + roi.height > frameA->height)
-          {
-            roi.y = frameA->height - roi.height;
-          }
+protected:
+  void Execute() override { fetchCameras(request); }
 
-          // std::cout << "A framenum=" << frameA->frameNum
-          //           << " B framenum=" << frameB->frameNum
-          //           << " frac=" << fractionalPart << std::endl;
+  void OnOK() override
+  {
+    Napi::Env env = Env();
+    Napi::Object ret = Napi::Object::New(env);
+    ret.Set("status", Napi::String::New(env, "OK"));
+    setCamerasFields(env, ret, request);
+    deferred.Resolve(ret);
+    release();
+  }
 
-          bool generatedByRife = false;
-#ifdef RIFE_SUPPORTED
-          if (interpMethod == "rife" && !rifeModelFile.empty())
-          {
-            auto rifeRoi = hasRifeCrop ? rifeCrop : roi;
-            rifeRoi.width = std::min(rifeRoi.width, frameA->width);
-            rifeRoi.height = std::min(rifeRoi.height, frameA->height);
-            rifeRoi.x = std::max(0, rifeRoi.x);
-            rifeRoi.y = std::max(0, rifeRoi.y);
-            if (rifeRoi.x + rifeRoi.width > frameA->width)
-            {
-              rifeRoi.x = frameA->width - rifeRoi.width;
-            }
-            if (rifeRoi.y + rifeRoi.height > frameA->height)
-            {
-              rifeRoi.y = frameA->height - rifeRoi.height;
-            }
+  void OnError(const Napi::Error &error) override
+  {
+    deferred.Reject(error.Value());
+    release();
+  }
 
-            try
-            {
-              auto &interpolator = rifeInterpolatorMap[rifeModelFile];
-              if (!interpolator)
-              {
-                interpolator = new RifeInterpolator(rifeModelFile);
-              }
-              cv::Mat matA(frameA->height, frameA->width, CV_8UC4,
-                          (void *)frameA->data->data());
-              cv::Mat matB(frameA->height, frameA->width, CV_8UC4,
-                          (void *)frameB->data->data());
-              cv::Rect cvCrop(rifeRoi.x, rifeRoi.y, rifeRoi.width, rifeRoi.height);
-              cv::Mat resultMat = interpolator->interpolate(
-                  matA, matB, static_cast<float>(fractionalPart), cvCrop,
-                  debugLevel);
-
-              // Composite the (small, fast-to-infer) interpolated crop back
-              // into a full-size copy of frameA so the response keeps the
-              // same width/height/linesize contract the blend path uses.
-              // Downstream rendering (Video.tsx) reuses image.width/height
-              // to (re)size the canvas and video-scaling state every frame,
-              // so returning a crop-sized buffer here corrupts that state.
-              frameInfo = std::make_shared<FrameInfo>(*frameA);
-              frameInfo->data = std::make_shared<std::vector<uint8_t>>(*(frameA->data));
-              cv::Mat fullMat(frameInfo->height, frameInfo->width, CV_8UC4,
-                              frameInfo->data->data());
-              resultMat.copyTo(fullMat(cvCrop));
-              frameInfo->tsMicro =
-                  frameA->tsMicro +
-                  (frameB->tsMicro - frameA->tsMicro) * fractionalPart + 0.5;
-              frameInfo->timestamp = (frameInfo->tsMicro + 500) / 1000;
-              frameInfo->frameNum =
-                  frameA->frameNum +
-                  (frameB->frameNum - frameA->frameNum) * fractionalPart;
-              frameInfo->roi = rifeRoi;
-              generatedByRife = true;
-            }
-            catch (const std::exception &e)
-            {
-              std::cerr << "RIFE interpolation failed, falling back to blend: "
-                        << e.what() << std::endl;
-            }
-          }
-#endif
-          if (!generatedByRife)
-          {
-            frameInfo = generateInterpolatedFrame(frameA, frameB, fractionalPart,
-                                                  roi, blend);
-          }
-          if (debugLevel > 1)
-          {
-            std::cout << __FILE__ << ":" << __LINE__
-                      << " Generating interpolated frame requestedFrameNum="
-                      << frameNum << " between " << frameA->frameNum << " and "
-                      << frameB->frameNum << " at " << fractionalPart
-                      << "% zoom=" << (hasZoom ? "true" : "false")
-                      << " interpMethod=" << interpMethod
-                      << " blend=" << (blend ? "true" : "false") << " motion=[" << frameInfo->motion.x << "," << frameInfo->motion.y << "," << frameInfo->motion.valid << "," << frameInfo->motion.dt << "]" << std::endl;
-          }
-          frameA->motion = frameInfo->motion;
-          frameA->roi = frameInfo->roi;
-        }
-        else
-        {
-          std::cerr << "Failed to grab frames " << file << ": " << intPart
-                    << " and " << intPart + 1 << std::endl;
-          // Make a copy for cache purposes
-          frameInfo = std::make_shared<FrameInfo>(*frameInfo);
-          frameInfo->data =
-              std::make_shared<std::vector<uint8_t>>(*(frameA->data));
-        }
-        frameInfo->key = key;
-        frameInfoList.addFrame(frameInfo);
+private:
+  /** Drops the job from its files' queues, freeing those left unused. */
+  void release()
+  {
+    for (auto &fetch : request.fetches)
+    {
+      if (!fetch.busy)
+      {
+        continue;
       }
-      else
+      auto it = fileQueues.find(fetch.file);
+      if (it != fileQueues.end() && --it->second.cameraJobs == 0 && !it->second.current)
       {
-        frameInfo = getFrame(fileInfo.videoReader, file, intPart, closeTo);
-        if (frameInfo)
-        {
-          if (hasZoom)
-          {
-            frameInfo = std::make_shared<FrameInfo>(*frameInfo);
-            frameInfo->data =
-                std::make_shared<std::vector<uint8_t>>(*(frameInfo->data));
-            frameInfo->key = key;
-            frameInfoList.addFrame(frameInfo);
-          }
-        }
-        else
-        {
-          std::string msg = "Failed to grab frame " + std::to_string(frameNum);
-          std::cerr << msg << std::endl;
-          Napi::TypeError::New(env, msg.c_str()).ThrowAsJavaScriptException();
-          return ret;
-        }
+        fileQueues.erase(it);
       }
-      // if (hasZoom) {
-      //   sharpenFrame(frameInfo);
-      // }
     }
+  }
+
+  CamerasRequest request;
+  Napi::Promise::Deferred deferred;
+};
 
-    frameInfo = pruneFrame(frameInfo, request);
+#ifdef RIFE_SUPPORTED
+class DetectBowJob : public FileJob
+{
+public:
+  DetectBowJob(const Napi::Env &env, BowRequest request, FileInfo *fileInfo)
+      : FileJob(env, request.videoFile), request(std::move(request)), fileInfo(fileInfo)
+  {
+  }
+
+protected:
+  std::string run() override { return detectBow(*fileInfo, request, result); }
+  void respond(const Napi::Env &env, Napi::Object &ret) override
+  {
+    setBowFields(env, ret, result);
+  }
+
+private:
+  BowRequest request;
+  FileInfo *fileInfo;
+  BowResult result;
+};
+#endif
+
+/**
+ * @brief nativeVideoExecutor returning a Promise.
+ *
+ * grabFrameAt, openFile, detectBowAtFrame, refreshFile, configureReader,
+ * probeFiles, openTimeline and grabFramesAtTime only read their arguments
+ * on the calling thread; the work runs on a worker thread, the file ops queued behind the
+ * file's earlier requests. Other ops run synchronously and settle at once;
+ * those on a file in use by a request report it busy rather than wait.
+ */
+Napi::Value nativeVideoExecutorAsync(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+  auto deferred = Napi::Promise::Deferred::New(env);
+  auto reject = [&](const std::string &error)
+  {
+    deferred.Reject(Napi::TypeError::New(env, error).Value());
+    return deferred.Promise();
+  };
+  if (info.Length() < 1 || !info[0].IsObject())
+  {
+    return reject("Wrong number of arguments");
+  }
+  auto args = info[0].As<Napi::Object>();
+  const auto op = args.Has("op") ? args.Get("op").As<Napi::String>().Utf8Value()
+                                 : std::string();
 
-    if (!saveAs.empty())
+  if (op == "grabFrameAt")
+  {
+    GrabRequest request;
+    FileInfo *fileInfo = nullptr;
+    auto error = readGrabRequest(args.Get("request").As<Napi::Object>(), request, fileInfo);
+    if (!error.empty())
     {
-      saveFrameAsPNG(frameInfo, saveAs);
+      return reject(error);
     }
+    return (new GrabFrameJob(env, std::move(request), fileInfo))->start();
+  }
 
-    ret.Set("data", Napi::Buffer<uint8_t>::Copy(env, frameInfo->data->data(),
-                                                frameInfo->totalBytes));
-    ret.Set("width", Napi::Number::New(env, frameInfo->width));
-    ret.Set("height", Napi::Number::New(env, frameInfo->height));
-    ret.Set("totalBytes", Napi::Number::New(env, frameInfo->totalBytes));
-    ret.Set("frameNum", Napi::Number::New(env, frameInfo->frameNum));
-    ret.Set("numFrames", Napi::Number::New(env, frameInfo->numFrames));
-    ret.Set("fps", Napi::Number::New(env, frameInfo->fps));
-    ret.Set("status", Napi::String::New(env, "OK"));
-    ret.Set("file", Napi::String::New(env, frameInfo->file));
-    ret.Set("timestamp", Napi::Number::New(env, frameInfo->timestamp));
-    ret.Set("tsMicro", Napi::Number::New(env, frameInfo->tsMicro));
-    Napi::Object motion = Napi::Object::New(env);
-    motion.Set("x", Napi::Number::New(env, frameInfo->motion.x));
-    motion.Set("y", Napi::Number::New(env, frameInfo->motion.y));
-    motion.Set("dt", Napi::Number::New(env, frameInfo->motion.dt));
-    motion.Set("valid", Napi::Boolean::New(env, frameInfo->motion.valid));
-    ret.Set("motion", motion);
-
-    if (debugLevel > 1)
+  if (op == "openFile")
+  {
+    OpenRequest request;
+    auto error = readOpenRequest(args, request);
+    if (!error.empty())
     {
-      std::cout << "Grabbed frame: " << frameInfo->frameNum << " ts=" << frameInfo->timestamp << " WxH=" << frameInfo->width
-                << "x" << frameInfo->height << std::endl;
+      return reject(error);
     }
-    return ret;
+    auto existing = fileInfoMap.find(request.file);
+    if (existing != fileInfoMap.end())
+    {
+      Napi::Object ret = Napi::Object::New(env);
+      ret.Set("status", Napi::String::New(env, "OK"));
+      setExtentFields(env, ret, existing->second);
+      deferred.Resolve(ret);
+      return deferred.Promise();
+    }
+    return (new OpenFileJob(env, std::move(request)))->start();
   }
 
-  if (op == "sendMulticast")
+  if (op == "refreshFile")
   {
-    if (!args.Has("dest"))
+    std::string file;
+    FileInfo *fileInfo = nullptr;
+    auto error = readOpenFile(args, file, fileInfo);
+    if (!error.empty())
     {
-      Napi::TypeError::New(env, "Missing dest ip field")
-          .ThrowAsJavaScriptException();
-      return ret;
+      return reject(error);
     }
-    if (!args.Has("port"))
+    return (new RefreshFileJob(env, file, fileInfo))->start();
+  }
+
+  if (op == "configureReader")
+  {
+    ReaderConfig config;
+    FileInfo *fileInfo = nullptr;
+    auto error = readReaderConfig(args, config, fileInfo);
+    if (!error.empty())
     {
-      Napi::TypeError::New(env, "Missing port field")
-          .ThrowAsJavaScriptException();
-      return ret;
+      return reject(error);
     }
-    if (!args.Has("msg"))
+    return (new ConfigureReaderJob(env, std::move(config), fileInfo))->start();
+  }
+
+  if (op == "probeFiles")
+  {
+    ProbeRequest request;
+    auto error = readProbeRequest(args, request);
+    if (!error.empty())
     {
-      Napi::TypeError::New(env, "Missing msg field")
-          .ThrowAsJavaScriptException();
-      return ret;
+      return reject(error);
     }
-    auto dest = args.Get("dest").As<Napi::String>().Utf8Value();
-    auto port = args.Get("port").As<Napi::Number>().Uint32Value();
-    auto msg = args.Get("msg").As<Napi::String>().Utf8Value();
+    return (new ProbeFilesJob(env, std::move(request)))->start();
+  }
 
-    auto error = sendMulticast(msg, dest, port);
-    if (error == 0)
+  if (op == "openTimeline")
+  {
+    TimelineRequest request;
+    auto error = readTimelineRequest(args, request);
+    if (!error.empty())
     {
-      ret.Set("status", Napi::String::New(env, "OK"));
+      return reject(error);
     }
-    else
+    return (new OpenTimelineJob(env, std::move(request)))->start();
+  }
+
+  if (op == "grabFramesAtTime")
+  {
+    CamerasRequest request;
+    auto error = readCamerasRequest(args, request);
+    if (!error.empty())
     {
-      ret.Set("status", Napi::String::New(env, "Failed"));
+      return reject(error);
     }
-    return ret;
+    return (new CamerasJob(env, std::move(request)))->start();
   }
 
-  Napi::TypeError::New(env, "Unrecognized op field")
-      .ThrowAsJavaScriptException();
+#ifdef RIFE_SUPPORTED
+  if (op == "detectBowAtFrame")
+  {
+    BowRequest request;
+    FileInfo *fileInfo = nullptr;
+    auto error = readBowRequest(args, request, fileInfo);
+    if (!error.empty())
+    {
+      deferred.Reject(Napi::Error::New(env, error).Value());
+      return deferred.Promise();
+    }
+    return (new DetectBowJob(env, std::move(request), fileInfo))->start();
+  }
+#endif
 
-  return ret;
+  auto ret = nativeVideoExecutor(info);
+  if (env.IsExceptionPending())
+  {
+    deferred.Reject(env.GetAndClearPendingException().Value());
+  }
+  else
+  {
+    deferred.Resolve(ret);
+  }
+  return deferred.Promise();
 }
 
 // Initialize the addon
@@ -1015,6 +3857,8 @@ Napi::Object Init(Napi::Env env, Napi::Object exports)
 {
   exports.Set(Napi::String::New(env, "nativeVideoExecutor"),
               Napi::Function::New(env, nativeVideoExecutor));
+  exports.Set(Napi::String::New(env, "nativeVideoExecutorAsync"),
+              Napi::Function::New(env, nativeVideoExecutorAsync));
   std::cerr << "System built " __DATE__ "  " __TIME__ << std::endl;
   std::cerr << "OpenCV runtime version: " << cv::getVersionString() << std::endl;
 
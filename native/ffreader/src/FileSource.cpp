@@ -0,0 +1,248 @@
+#include "FileSource.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+extern "C"
+{
+#include <libavutil/avutil.h>
+#include <libavutil/mem.h>
+}
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Mapped reads are plain copies, so a small AVIO buffer is enough.
+constexpr static size_t mapped_buffer_bytes = 256 * 1024;
+
+FileSource::~FileSource() { close(); }
+
+bool FileSource::open(const std::string &file, FileIOMode ioMode, size_t readAheadBytes)
+{
+  close();
+  path = file;
+  mode = ioMode;
+  if (mode == FileIOMode::Mapped)
+  {
+    if (!mapped.open(path))
+    {
+      return false;
+    }
+    size = (int64_t)mapped.size();
+  }
+  else
+  {
+#ifdef _WIN32
+    const std::wstring widePath = utf8Path(path).wstring();
+    HANDLE handle = CreateFileW(widePath.c_str(), GENERIC_READ,
+                                FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+      return false;
+    }
+    fileHandle = handle;
+#else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+      return false;
+    }
+#if defined(POSIX_FADV_RANDOM)
+    // Our reads are already large; stop the kernel reading further ahead.
+    posix_fadvise(fd, 0, 0, POSIX_FADV_RANDOM);
+#endif
+#endif
+    size = refreshSize();
+  }
+
+  const size_t bufferBytes =
+      mode == FileIOMode::Mapped ? mapped_buffer_bytes : std::max<size_t>(readAheadBytes, 4096);
+  auto *buffer = static_cast<unsigned char *>(av_malloc(bufferBytes));
+  if (!buffer)
+  {
+    close();
+    return false;
+  }
+  avio = avio_alloc_context(buffer, (int)bufferBytes, 0, this, &FileSource::readPacket,
+                            nullptr, &FileSource::seekPacket);
+  if (!avio)
+  {
+    av_free(buffer);
+    close();
+    return false;
+  }
+  return true;
+}
+
+void FileSource::close()
+{
+  if (avio)
+  {
+    av_freep(&avio->buffer);
+    avio_context_free(&avio);
+  }
+  mapped.close();
+#ifdef _WIN32
+  if (fileHandle)
+  {
+    CloseHandle(fileHandle);
+    fileHandle = nullptr;
+  }
+#else
+  if (fd >= 0)
+  {
+    ::close(fd);
+    fd = -1;
+  }
+#endif
+  position = 0;
+  size = 0;
+  bytesRead = 0;
+  readCalls = 0;
+  seeks = 0;
+}
+
+FileIOStats FileSource::stats() const
+{
+  FileIOStats result;
+  result.bytesRead = bytesRead;
+  result.readCalls = readCalls;
+  result.seeks = seeks;
+  return result;
+}
+
+int FileSource::readPacket(void *opaque, uint8_t *buf, int size)
+{
+  return static_cast<FileSource *>(opaque)->read(buf, size);
+}
+
+int64_t FileSource::seekPacket(void *opaque, int64_t offset, int whence)
+{
+  return static_cast<FileSource *>(opaque)->seek(offset, whence);
+}
+
+int64_t FileSource::refreshSize()
+{
+  if (mode == FileIOMode::Mapped)
+  {
+    uint64_t fileSize;
+    int64_t mtime;
+    if (getFileStamp(path, fileSize, mtime) && fileSize > mapped.size() &&
+        mapped.open(path))
+    {
+      size = (int64_t)mapped.size();
+    }
+    return size;
+  }
+#ifdef _WIN32
+  LARGE_INTEGER fileSize;
+  if (GetFileSizeEx(fileHandle, &fileSize))
+  {
+    size = fileSize.QuadPart;
+  }
+#else
+  struct stat st;
+  if (fstat(fd, &st) == 0)
+  {
+    size = st.st_size;
+  }
+#endif
+  return size;
+}
+
+int FileSource::read(uint8_t *buf, int want)
+{
+  if (position >= size)
+  {
+    refreshSize();
+  }
+  if (position >= size)
+  {
+    return AVERROR_EOF;
+  }
+
+  int got = 0;
+  if (mode == FileIOMode::Mapped)
+  {
+    got = (int)std::min<int64_t>(want, size - position);
+    memcpy(buf, mapped.data() + position, got);
+  }
+  else
+  {
+#ifdef _WIN32
+    OVERLAPPED at = {};
+    at.Offset = (DWORD)(position & 0xffffffff);
+    at.OffsetHigh = (DWORD)(position >> 32);
+    DWORD count = 0;
+    if (!ReadFile(fileHandle, buf, (DWORD)want, &count, &at) && GetLastError() != ERROR_HANDLE_EOF)
+    {
+      return AVERROR(EIO);
+    }
+    got = (int)count;
+#else
+    const ssize_t count = pread(fd, buf, want, position);
+    if (count < 0)
+    {
+      return AVERROR(errno);
+    }
+    got = (int)count;
+#endif
+    if (got == 0)
+    {
+      return AVERROR_EOF;
+    }
+  }
+  readCalls++;
+  bytesRead += got;
+  position += got;
+  return got;
+}
+
+int64_t FileSource::seek(int64_t offset, int whence)
+{
+  if (whence & AVSEEK_SIZE)
+  {
+    return refreshSize();
+  }
+  whence &= ~AVSEEK_FORCE;
+  int64_t target;
+  switch (whence)
+  {
+  case SEEK_SET:
+    target = offset;
+    break;
+  case SEEK_CUR:
+    target = position + offset;
+    break;
+  case SEEK_END:
+    target = refreshSize() + offset;
+    break;
+  default:
+    return AVERROR(EINVAL);
+  }
+  if (target < 0)
+  {
+    return AVERROR(EINVAL);
+  }
+  if (target != position)
+  {
+    seeks++;
+#if !defined(_WIN32) && defined(POSIX_FADV_WILLNEED)
+    // Start fetching the window the demuxer will read next.
+    if (mode == FileIOMode::ReadAhead && avio)
+    {
+      posix_fadvise(fd, target, avio->buffer_size, POSIX_FADV_WILLNEED);
+    }
+#endif
+  }
+  position = target;
+  return position;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.hpp"
+
+extern "C"
+{
+#include <libavformat/avio.h>
+}
+
+/** How FFVideoReader reads the video file. */
+enum class FileIOMode
+{
+  Default,   ///< FFmpeg's own file protocol.
+  ReadAhead, ///< Large aligned reads with access-pattern hints.
+  Mapped,    ///< Copies from a memory mapping of the file.
+};
+
+/** Cumulative I/O of a FileSource. */
+struct FileIOStats
+{
+  uint64_t bytesRead = 0; ///< Bytes handed to the demuxer.
+  uint64_t readCalls = 0; ///< read() calls made (ReadAhead) or reads served (Mapped).
+  uint64_t seeks = 0;     ///< Seeks that moved the read position.
+};
+
+/**
+ * @class FileSource
+ * @brief Custom AVIOContext over a local file.
+ *
+ * FFmpeg's file protocol reads in small buffered chunks, so every random
+ * seek of the demuxer costs many small reads. In ReadAhead mode each read
+ * fills a large aligned buffer in one call and the kernel is told the
+ * access is random, with the next window prefetched after a seek. In Mapped
+ * mode reads are copies out of a mapping of the file, so only page faults
+ * reach the disk.
+ *
+ * The file may keep growing while open (live tail); the size is looked up
+ * again whenever a read reaches the known end.
+ */
+class FileSource
+{
+public:
+  FileSource() = default;
+  ~FileSource();
+
+  FileSource(const FileSource &) = delete;
+  FileSource &operator=(const FileSource &) = delete;
+
+  /**
+   * @brief Opens @p path for reading through an AVIOContext.
+   *
+   * @param mode ReadAhead or Mapped.
+   * @param readAheadBytes Size of each read in ReadAhead mode.
+   * @return false if the file cannot be opened.
+   */
+  bool open(const std::string &path, FileIOMode mode, size_t readAheadBytes);
+
+  /** Releases the AVIOContext and the file. */
+  void close();
+
+  /** Context to set as AVFormatContext::pb, or nullptr when closed. */
+  AVIOContext *context() const { return avio; }
+
+  /** Counters since open. */
+  FileIOStats stats() const;
+
+private:
+  static int readPacket(void *opaque, uint8_t *buf, int size);
+  static int64_t seekPacket(void *opaque, int64_t offset, int whence);
+
+  int read(uint8_t *buf, int size);
+  int64_t seek(int64_t offset, int whence);
+
+  /** Current size of the file, remapping it in Mapped mode if it grew. */
+  int64_t refreshSize();
+
+  std::string path;
+  FileIOMode mode = FileIOMode::Default;
+  AVIOContext *avio = nullptr;
+  MappedFile mapped;
+  int64_t position = 0;
+  int64_t size = 0;
+#ifdef _WIN32
+  void *fileHandle = nullptr;
+#else
+  int fd = -1;
+#endif
+  std::atomic<uint64_t> bytesRead{0};
+  std::atomic<uint64_t> readCalls{0};
+  std::atomic<uint64_t> seeks{0};
+};
@@ -0,0 +1,311 @@
+#include "FrameConverter.hpp"
+#include "WorkerPool.hpp"
+#include "YuvToRgba.hpp"
+
+extern "C"
+{
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+/** Pixels below which a band is not worth handing to another thread. */
+static constexpr int min_band_pixels = 256 * 1024;
+
+std::shared_ptr<AVFrame> shareFrame(const AVFrame *frame)
+{
+  if (!frame)
+  {
+    return nullptr;
+  }
+  AVFrame *clone = av_frame_clone(frame);
+  if (!clone)
+  {
+    return nullptr;
+  }
+  return std::shared_ptr<AVFrame>(clone, [](AVFrame *f)
+                                  { av_frame_free(&f); });
+}
+
+FrameConverter::~FrameConverter()
+{
+  if (swsContext)
+  {
+    sws_freeContext(swsContext);
+  }
+  if (scaleContext)
+  {
+    sws_freeContext(scaleContext);
+  }
+  if (yuvContext)
+  {
+    sws_freeContext(yuvContext);
+  }
+}
+
+FrameConverter &FrameConverter::forThread()
+{
+  thread_local FrameConverter converter;
+  return converter;
+}
+
+bool FrameConverter::toRGBA(const AVFrame *src, int x, int y, int width,
+                            int height, uint8_t *dst, int dstStride)
+{
+  return toRGBA(src, x, y, width, height, -1, -1, dst, dstStride);
+}
+
+bool FrameConverter::toRGBA(const AVFrame *src, int x, int y, int width,
+                            int height, int outWidth, int outHeight,
+                            uint8_t *dst, int dstStride)
+{
+  x = std::max(0, std::min(x, src->width));
+  y = std::max(0, std::min(y, src->height));
+  width = std::min(width, src->width - x);
+  height = std::min(height, src->height - y);
+  if (width <= 0 || height <= 0)
+  {
+    return false;
+  }
+  if (outWidth <= 0 || outHeight <= 0)
+  {
+    outWidth = width;
+    outHeight = height;
+  }
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)src->format);
+  if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM |
+                               AV_PIX_FMT_FLAG_PAL)))
+  {
+    std::cerr << "Unsupported pixel format for RGBA conversion: " << src->format
+              << std::endl;
+    return false;
+  }
+
+  // Unscaled conversions are split into horizontal bands converted in
+  // parallel, each band by its thread's own converter. Scaled output is
+  // display-sized and converted here in one pass.
+  const bool scaled = outWidth != width || outHeight != height;
+  auto &pool = WorkerPool::shared();
+  const int bands = scaled ? 1
+                           : std::min((int)pool.concurrency(),
+                                      std::max(1, width * height / min_band_pixels));
+  if (bands <= 1)
+  {
+    return convertRegion(src, desc, x, y, width, height, outWidth, outHeight,
+                         dst, dstStride);
+  }
+
+  // Even band heights keep every band on the same chroma row parity.
+  const int bandRows = ((height + bands - 1) / bands + 1) & ~1;
+  std::atomic<bool> ok{true};
+  auto convertBand = [&](int band)
+  {
+    const int top = band * bandRows;
+    const int rows = std::min(bandRows, height - top);
+    if (rows > 0 &&
+        !forThread().convertRegion(src, desc, x, y + top, width, rows, width, rows,
+                                   dst + (ptrdiff_t)top * dstStride, dstStride))
+    {
+      ok = false;
+    }
+  };
+  pool.parallelFor(bands, convertBand);
+  return ok;
+}
+
+bool FrameConverter::convertRegion(const AVFrame *src, const AVPixFmtDescriptor *desc,
+                                   int x, int y, int width, int height,
+                                   int outWidth, int outHeight, uint8_t *dst,
+                                   int dstStride)
+{
+  const bool scaled = outWidth != width || outHeight != height;
+  if (!scaled && yuvToRGBASupported(src))
+  {
+    return yuvToRGBA(src, x, y, width, height, dst, dstStride);
+  }
+
+  const AVPixelFormat format = (AVPixelFormat)src->format;
+
+  // Subsampled chroma can only be cropped on its own grid. Start on the grid
+  // and drop the extra leading pixels after conversion.
+  const int gridX = x & ~((1 << desc->log2_chroma_w) - 1);
+  const int gridY = y & ~((1 << desc->log2_chroma_h) - 1);
+  const int padX = x - gridX;
+  const int padY = y - gridY;
+  const int srcW = width + padX;
+  const int srcH = height + padY;
+
+  const uint8_t *planes[4] = {nullptr, nullptr, nullptr, nullptr};
+  int strides[4] = {0, 0, 0, 0};
+  const bool rgb = (desc->flags & AV_PIX_FMT_FLAG_RGB) != 0;
+  for (int c = 0; c < desc->nb_components; c++)
+  {
+    const AVComponentDescriptor &comp = desc->comp[c];
+    if (planes[comp.plane])
+    {
+      continue;
+    }
+    const bool chroma = !rgb && (c == 1 || c == 2);
+    const int planeX = chroma ? gridX >> desc->log2_chroma_w : gridX;
+    const int planeY = chroma ? gridY >> desc->log2_chroma_h : gridY;
+    planes[comp.plane] = src->data[comp.plane] +
+                         (ptrdiff_t)planeY * src->linesize[comp.plane] +
+                         (ptrdiff_t)planeX * comp.step;
+    strides[comp.plane] = src->linesize[comp.plane];
+  }
+
+  const bool padded = padX != 0 || padY != 0;
+  // On the chroma grid, crop, convert and scale happen in one pass. Off the
+  // grid, the padded region is converted first and the RGBA is rescaled.
+  const int convertW = padded ? srcW : outWidth;
+  const int convertH = padded ? srcH : outHeight;
+  swsContext = sws_getCachedContext(swsContext, srcW, srcH, format, convertW,
+                                    convertH, AV_PIX_FMT_RGBA, SWS_BILINEAR,
+                                    nullptr, nullptr, nullptr);
+  if (!swsContext)
+  {
+    std::cerr << "Could not initialize the conversion context!" << std::endl;
+    return false;
+  }
+
+  uint8_t *out = dst;
+  int outStride = dstStride;
+  if (padded)
+  {
+    outStride = srcW * 4;
+    scratch.resize((size_t)outStride * srcH);
+    out = scratch.data();
+  }
+
+  uint8_t *outPlanes[4] = {out, nullptr, nullptr, nullptr};
+  int outStrides[4] = {outStride, 0, 0, 0};
+  sws_scale(swsContext, planes, strides, 0, srcH, outPlanes, outStrides);
+
+  if (padded && scaled)
+  {
+    scaleContext = sws_getCachedContext(scaleContext, width, height, AV_PIX_FMT_RGBA,
+                                        outWidth, outHeight, AV_PIX_FMT_RGBA,
+                                        SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!scaleContext)
+    {
+      std::cerr << "Could not initialize the scaling context!" << std::endl;
+      return false;
+    }
+    const uint8_t *cropPlanes[4] = {out + (size_t)padY * outStride + padX * 4,
+                                    nullptr, nullptr, nullptr};
+    const int cropStrides[4] = {outStride, 0, 0, 0};
+    uint8_t *dstPlanes[4] = {dst, nullptr, nullptr, nullptr};
+    const int dstStrides[4] = {dstStride, 0, 0, 0};
+    sws_scale(scaleContext, cropPlanes, cropStrides, 0, height, dstPlanes, dstStrides);
+  }
+  else if (padded)
+  {
+    for (int row = 0; row < height; row++)
+    {
+      memcpy(dst + (size_t)row * dstStride,
+             out + (size_t)(row + padY) * outStride + padX * 4, (size_t)width * 4);
+    }
+  }
+  return true;
+}
+
+/** True for the pixel formats that imply full-range samples. */
+static bool isJpegFormat(int format)
+{
+  return format == AV_PIX_FMT_YUVJ420P || format == AV_PIX_FMT_YUVJ422P ||
+         format == AV_PIX_FMT_YUVJ444P;
+}
+
+bool FrameConverter::toYUV420(const AVFrame *src, bool nv12, int y, int height,
+                              std::vector<uint8_t> &out, YUVPlanes &planes)
+{
+  y = std::max(0, std::min(y, src->height)) & ~1;
+  height = std::min(height, src->height - y);
+  const int width = src->width;
+  if (width <= 0 || height <= 0)
+  {
+    return false;
+  }
+
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)src->format);
+  if (!desc || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM |
+                               AV_PIX_FMT_FLAG_PAL)))
+  {
+    std::cerr << "Unsupported pixel format for YUV output: " << src->format
+              << std::endl;
+    return false;
+  }
+
+  const bool srcJpeg = isJpegFormat(src->format);
+  const bool srcFullRange = srcJpeg || src->color_range == AVCOL_RANGE_JPEG;
+  // yuvj420p and yuv420p share a layout; only the range differs.
+  const AVPixelFormat target = nv12     ? AV_PIX_FMT_NV12
+                               : srcJpeg ? AV_PIX_FMT_YUVJ420P
+                                         : AV_PIX_FMT_YUV420P;
+  const bool sameLayout =
+      src->format == target ||
+      (!nv12 && (src->format == AV_PIX_FMT_YUV420P || src->format == AV_PIX_FMT_YUVJ420P));
+
+  const int size = av_image_get_buffer_size(target, width, height, 1);
+  if (size <= 0)
+  {
+    return false;
+  }
+  out.resize(size);
+  uint8_t *dstData[4] = {nullptr, nullptr, nullptr, nullptr};
+  int dstLinesize[4] = {0, 0, 0, 0};
+  av_image_fill_arrays(dstData, dstLinesize, out.data(), target, width, height, 1);
+
+  const uint8_t *srcData[4] = {nullptr, nullptr, nullptr, nullptr};
+  int srcLinesize[4] = {0, 0, 0, 0};
+  for (int c = 0; c < desc->nb_components; c++)
+  {
+    const AVComponentDescriptor &comp = desc->comp[c];
+    if (srcData[comp.plane])
+    {
+      continue;
+    }
+    const bool chroma = !(desc->flags & AV_PIX_FMT_FLAG_RGB) && (c == 1 || c == 2);
+    const int planeY = chroma ? y >> desc->log2_chroma_h : y;
+    srcData[comp.plane] =
+        src->data[comp.plane] + (ptrdiff_t)planeY * src->linesize[comp.plane];
+    srcLinesize[comp.plane] = src->linesize[comp.plane];
+  }
+
+  if (sameLayout)
+  {
+    av_image_copy(dstData, dstLinesize, srcData, srcLinesize, target, width, height);
+    planes.fullRange = srcFullRange;
+  }
+  else
+  {
+    yuvContext = sws_getCachedContext(yuvContext, width, height,
+                                      (AVPixelFormat)src->format, width, height,
+                                      target, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!yuvContext)
+    {
+      std::cerr << "Could not initialize the YUV conversion context!" << std::endl;
+      return false;
+    }
+    sws_scale(yuvContext, srcData, srcLinesize, 0, height, dstData, dstLinesize);
+    // swscale compresses yuvj input into limited-range NV12; other input is
+    // passed through without range conversion.
+    planes.fullRange = srcJpeg ? target == AV_PIX_FMT_YUVJ420P : srcFullRange;
+  }
+
+  const int chromaWidth = (width + 1) / 2;
+  const int chromaHeight = (height + 1) / 2;
+  planes.count = nv12 ? 2 : 3;
+  for (int i = 0; i < planes.count; i++)
+  {
+    planes.offset[i] = (int)(dstData[i] - out.data());
+    planes.stride[i] = dstLinesize[i];
+    planes.width[i] = i == 0 ? width : chromaWidth;
+    planes.height[i] = i == 0 ? height : chromaHeight;
+  }
+  return true;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+extern "C"
+{
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+/**
+ * @brief Wraps a new reference to @p frame in a shared_ptr that frees it.
+ *
+ * The reference shares the decoder's buffers, so holding a decoded frame this
+ * way costs no copy and keeps it valid after the reader moves on.
+ *
+ * @return The shared frame, or nullptr if @p frame is null or cannot be referenced.
+ */
+std::shared_ptr<AVFrame> shareFrame(const AVFrame *frame);
+
+/** Layout of the tightly packed planes written by FrameConverter::toYUV420(). */
+struct YUVPlanes
+{
+  int count = 0; ///< 3 for I420, 2 for NV12.
+  int offset[3] = {0, 0, 0};
+  int stride[3] = {0, 0, 0};
+  int width[3] = {0, 0, 0}; ///< Plane width in samples; NV12's UV plane counts pairs.
+  int height[3] = {0, 0, 0};
+  bool fullRange = false;
+};
+
+/**
+ * @class FrameConverter
+ * @brief Converts regions of decoded frames to packed RGBA.
+ *
+ * The source region is addressed in place by offsetting the plane pointers,
+ * so only the requested pixels are converted, optionally scaled to an output
+ * size in the same pass. Unscaled conversions of common camera formats use
+ * the vectorised kernels in YuvToRgba.hpp; everything else goes through
+ * swscale, with cached SwsContexts reused while formats and sizes hold.
+ * Large unscaled regions are converted as horizontal bands on the shared
+ * WorkerPool, with the number of bands set by region size and core count.
+ */
+class FrameConverter
+{
+public:
+  FrameConverter() = default;
+  ~FrameConverter();
+
+  FrameConverter(const FrameConverter &) = delete;
+  FrameConverter &operator=(const FrameConverter &) = delete;
+
+  /**
+   * @brief Converts a region of @p src to RGBA.
+   *
+   * @param src Decoded frame in any CPU pixel format.
+   * @param x Left edge of the region in source pixels.
+   * @param y Top edge of the region in source pixels.
+   * @param width Region width; the region is clipped to the frame.
+   * @param height Region height; the region is clipped to the frame.
+   * @param dst Destination for width x height RGBA pixels.
+   * @param dstStride Bytes per destination row.
+   * @return false if the region is empty or the format cannot be converted.
+   */
+  bool toRGBA(const AVFrame *src, int x, int y, int width, int height,
+              uint8_t *dst, int dstStride);
+
+  /**
+   * @brief Converts a region of @p src to RGBA scaled to @p outWidth x @p outHeight.
+   *
+   * Same as above but the region is resampled to the output size, so a
+   * zoomed view is produced at display resolution without an intermediate
+   * full-size RGBA frame.
+   *
+   * @param dst Destination for outWidth x outHeight RGBA pixels.
+   */
+  bool toRGBA(const AVFrame *src, int x, int y, int width, int height,
+              int outWidth, int outHeight, uint8_t *dst, int dstStride);
+
+  /**
+   * @brief Copies rows of @p src into tightly packed 4:2:0 planes.
+   *
+   * Frames already in the requested layout are copied plane by plane.
+   * Other formats are converted with swscale, keeping full-range data
+   * full range where the output layout allows it.
+   *
+   * @param nv12 True for NV12 (Y plus interleaved UV), false for I420.
+   * @param y First row; rounded down to an even row.
+   * @param height Rows to copy; the range is clipped to the frame.
+   * @param out Receives the planes back to back.
+   * @param planes Receives the plane layout within @p out.
+   * @return false if the range is empty or the format cannot be converted.
+   */
+  bool toYUV420(const AVFrame *src, bool nv12, int y, int height,
+                std::vector<uint8_t> &out, YUVPlanes &planes);
+
+  /** Converter for the calling thread. */
+  static FrameConverter &forThread();
+
+private:
+  /** Converts a clipped region on the calling thread. */
+  bool convertRegion(const AVFrame *src, const AVPixFmtDescriptor *desc, int x,
+                     int y, int width, int height, int outWidth, int outHeight,
+                     uint8_t *dst, int dstStride);
+
+  SwsContext *swsContext = nullptr;
+  SwsContext *scaleContext = nullptr; ///< RGBA rescale after an off-grid crop.
+  SwsContext *yuvContext = nullptr;   ///< Format conversion for toYUV420().
+  std::vector<uint8_t> scratch;       ///< Used when the region is not on the chroma grid.
+};
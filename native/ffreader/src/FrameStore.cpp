@@ -0,0 +1,124 @@
+#include "FrameStore.hpp"
+
+extern "C"
+{
+#include <libavutil/imgutils.h>
+}
+
+#include <algorithm>
+
+FrameStore::~FrameStore() { clear(); }
+
+size_t FrameStore::frameBytes(const AVFrame *frame)
+{
+  size_t bytes = 0;
+  for (int i = 0; i < AV_NUM_DATA_POINTERS; i++)
+  {
+    if (frame->buf[i])
+    {
+      bytes += frame->buf[i]->size;
+    }
+  }
+  if (bytes == 0 && frame->width > 0 && frame->height > 0)
+  {
+    const int size = av_image_get_buffer_size((AVPixelFormat)frame->format,
+                                              frame->width, frame->height, 1);
+    bytes = size > 0 ? (size_t)size : 0;
+  }
+  return bytes;
+}
+
+void FrameStore::configure(size_t budgetBytes, size_t maxFrames, size_t minFrames)
+{
+  byteBudget = budgetBytes;
+  frameLimit = std::max<size_t>(maxFrames, 1);
+  frameFloor = std::min(minFrames, frameLimit);
+  trim();
+}
+
+void FrameStore::put(int64_t frameNumber, const AVFrame *frame)
+{
+  AVFrame *copy = av_frame_alloc();
+  if (!copy)
+  {
+    return;
+  }
+  if (av_frame_ref(copy, frame) < 0)
+  {
+    av_frame_free(&copy);
+    return;
+  }
+
+  auto it = entries.find(frameNumber);
+  if (it != entries.end())
+  {
+    totalBytes -= it->second.bytes;
+    av_frame_free(&it->second.frame);
+    recencyOrder.erase(it->second.recency);
+    entries.erase(it);
+  }
+
+  recencyOrder.push_front(frameNumber);
+  const size_t bytes = frameBytes(copy);
+  entries.emplace(frameNumber, Entry{copy, bytes, recencyOrder.begin()});
+  totalBytes += bytes;
+  trim();
+}
+
+AVFrame *FrameStore::get(int64_t frameNumber)
+{
+  auto it = entries.find(frameNumber);
+  if (it == entries.end())
+  {
+    missCount++;
+    return nullptr;
+  }
+  hitCount++;
+  recencyOrder.splice(recencyOrder.begin(), recencyOrder, it->second.recency);
+  return it->second.frame;
+}
+
+AVFrame *FrameStore::peek(int64_t frameNumber) const
+{
+  auto it = entries.find(frameNumber);
+  return it != entries.end() ? it->second.frame : nullptr;
+}
+
+void FrameStore::clear()
+{
+  for (auto &entry : entries)
+  {
+    av_frame_free(&entry.second.frame);
+  }
+  entries.clear();
+  recencyOrder.clear();
+  totalBytes = 0;
+}
+
+FrameStore::Stats FrameStore::stats() const
+{
+  Stats stats;
+  stats.frames = entries.size();
+  stats.bytes = totalBytes;
+  stats.budgetBytes = byteBudget;
+  stats.maxFrames = frameLimit;
+  stats.hits = hitCount;
+  stats.misses = missCount;
+  stats.evictions = evictionCount;
+  return stats;
+}
+
+void FrameStore::trim()
+{
+  while (!recencyOrder.empty() &&
+         (entries.size() > frameLimit ||
+          (totalBytes > byteBudget && entries.size() > frameFloor)))
+  {
+    auto it = entries.find(recencyOrder.back());
+    totalBytes -= it->second.bytes;
+    av_frame_free(&it->second.frame);
+    entries.erase(it);
+    recencyOrder.pop_back();
+    evictionCount++;
+  }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+/**
+ * @class FrameStore
+ * @brief Decoded frames keyed by frame number, bounded by bytes and count.
+ *
+ * Each entry holds its own reference to an AVFrame. Lookup, insertion and
+ * eviction are O(1): a hash map finds entries and a recency list orders them
+ * for least-recently-used eviction. Entry sizes come from the frame's buffer
+ * sizes, so the same byte budget holds fewer 4K frames than 1080p ones.
+ */
+class FrameStore
+{
+public:
+  /** Occupancy and effectiveness counters, see stats(). */
+  struct Stats
+  {
+    size_t frames = 0;
+    size_t bytes = 0;
+    size_t budgetBytes = 0;
+    size_t maxFrames = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  FrameStore() = default;
+  ~FrameStore();
+
+  FrameStore(const FrameStore &) = delete;
+  FrameStore &operator=(const FrameStore &) = delete;
+
+  /**
+   * @brief Sets the limits and evicts down to them.
+   *
+   * @param budgetBytes Total decoded bytes to hold.
+   * @param maxFrames Upper bound on entries regardless of size.
+   * @param minFrames Entries kept even when they exceed the byte budget, so
+   *                  short backward steps keep working at any resolution.
+   */
+  void configure(size_t budgetBytes, size_t maxFrames, size_t minFrames);
+
+  /**
+   * @brief Stores a new reference to @p frame under @p frameNumber,
+   * replacing any existing entry, and evicts least-recently-used frames.
+   */
+  void put(int64_t frameNumber, const AVFrame *frame);
+
+  /**
+   * @brief Returns the frame stored under @p frameNumber and marks it
+   * recently used, or nullptr. Counts a hit or miss.
+   */
+  AVFrame *get(int64_t frameNumber);
+
+  /** Returns the stored frame without touching recency or counters. */
+  AVFrame *peek(int64_t frameNumber) const;
+
+  /** True if @p frameNumber is stored. */
+  bool contains(int64_t frameNumber) const { return entries.count(frameNumber) != 0; }
+
+  /** Frees every entry. Counters are kept. */
+  void clear();
+
+  /** Current occupancy, limits and counters. */
+  Stats stats() const;
+
+  /** Upper bound on entries from configure(). */
+  size_t maxFrames() const { return frameLimit; }
+
+  /** Approximate bytes held by @p frame's data buffers. */
+  static size_t frameBytes(const AVFrame *frame);
+
+private:
+  struct Entry
+  {
+    AVFrame *frame;
+    size_t bytes;
+    std::list<int64_t>::iterator recency;
+  };
+
+  /** Evicts least-recently-used entries until within the limits. */
+  void trim();
+
+  std::unordered_map<int64_t, Entry> entries;
+  std::list<int64_t> recencyOrder; ///< Most recently used at the front.
+  size_t totalBytes = 0;
+  size_t byteBudget = 256 * 1024 * 1024;
+  size_t frameLimit = 32;
+  size_t frameFloor = 32;
+  uint64_t hitCount = 0;
+  uint64_t missCount = 0;
+  uint64_t evictionCount = 0;
+};
@@ -1,9 +1,12 @@
 // #define CV_THROW_IF_TYPE_MISMATCH(src_type_info, dst_type_info)
 
 #include "FrameUtils.hpp"
+#include "FrameConverter.hpp"
+#include "FrameStore.hpp"
 #include <algorithm>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
@@ -19,6 +22,44 @@ extern "C"
 using namespace cv;
 using namespace std;
 
+/**
+ * Guards data and source of every FrameInfo. Conversion runs outside it;
+ * only the swap from source to RGBA is published under the lock.
+ */
+static std::mutex frameDataLock;
+
+const std::shared_ptr<std::vector<uint8_t>> &FrameInfo::rgba()
+{
+  std::shared_ptr<AVFrame> decoded;
+  {
+    std::lock_guard<std::mutex> guard(frameDataLock);
+    if (data || !source)
+    {
+      return data;
+    }
+    decoded = source;
+  }
+  auto pixels = std::make_shared<std::vector<uint8_t>>((size_t)width * height * 4);
+  const bool converted = FrameConverter::forThread().toRGBA(
+      decoded.get(), 0, 0, width, height, pixels->data(), width * 4);
+  std::lock_guard<std::mutex> guard(frameDataLock);
+  if (converted && !data)
+  {
+    data = pixels;
+    totalBytes = static_cast<int>(pixels->size());
+    linesize = width * 4;
+    // The YUV is no longer needed once RGBA exists
+    source.reset();
+  }
+  return data;
+}
+
+size_t FrameInfo::cacheBytes() const
+{
+  std::lock_guard<std::mutex> guard(frameDataLock);
+  return (data ? data->size() : 0) + (source ? FrameStore::frameBytes(source.get()) : 0);
+}
+
 struct BowMatch
 {
   cv::Point2f matched_center_xy; // center of best match in B
@@ -314,9 +355,9 @@ generateInterpolatedFrame(const std::shared_ptr<FrameInfo> frameA,
                           double pctAtoB, FrameRect roi, bool blend)
 {
   Mat matA(frameA->height, frameA->width, CV_8UC4,
-           (void *)frameA->data->data());
+           (void *)frameA->rgba()->data());
   Mat matB(frameA->height, frameA->width, CV_8UC4,
-           (void *)frameB->data->data());
+           (void *)frameB->rgba()->data());
 
   ImageMotion motion = frameA->motion;
   if (!motion.valid || motion.x == 0 || frameA->roi != roi)
@@ -350,6 +391,7 @@ generateInterpolatedFrame(const std::shared_ptr<FrameInfo> frameA,
   }
 
   auto resultFrame = std::make_shared<FrameInfo>(*frameA);
+  resultFrame->source.reset();
   resultFrame->data = std::make_shared<vector<uint8_t>>(
       vector<uint8_t>(resultFrameMat.data,
                       resultFrameMat.data +
@@ -369,7 +411,7 @@ generateInterpolatedFrame(const std::shared_ptr<FrameInfo> frameA,
 void sharpenFrame(const std::shared_ptr<FrameInfo> frameA)
 {
   // Convert the std::vector<uint8_t> to a cv::Mat
-  cv::Mat img(frameA->height, frameA->width, CV_8UC4, frameA->data->data());
+  cv::Mat img(frameA->height, frameA->width, CV_8UC4, frameA->rgba()->data());
 
   // Create a kernel for sharpening
   cv::Mat kernel = (cv::Mat_<float>(3, 3) << 0, -1, 0, -1, 5, -1, 0, -1, 0);
@@ -397,7 +439,7 @@ void sharpenFrame(const std::shared_ptr<FrameInfo> frameA)
 void saveFrameAsPNG(const std::shared_ptr<FrameInfo> &frameInfo,
                     const std::string &outputFileName)
 {
-  if (!frameInfo || !frameInfo->data || frameInfo->data->empty() ||
+  if (!frameInfo || !frameInfo->rgba() || frameInfo->data->empty() ||
       frameInfo->width <= 0 || frameInfo->height <= 0)
   {
     std::cerr << "Invalid frame data or dimensions." << std::endl;
@@ -3,10 +3,13 @@
 #include <iostream>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
 
+struct AVFrame;
+
 struct ImageMotion
 {
   double x;
@@ -85,7 +88,9 @@ public:
   double fps;     ///< Frames per second.
   int totalBytes; ///< Total bytes of the frame data.
   std::shared_ptr<std::vector<uint8_t>>
-      data;           ///< Shared pointer to the frame data.
+      data; ///< RGBA frame data. Null until rgba() converts from source.
+  std::shared_ptr<AVFrame>
+      source;         ///< Decoded frame in its native format, if still held.
   int width;          ///< Width of the frame.
   int height;         ///< Height of the frame.
   int linesize;       ///< Line size of the frame.
@@ -108,27 +113,59 @@ public:
   {
     key = formatKey(file, frameNum, false, {0, 0, 0, 0}, closeTo);
   }
+
+  /**
+   * @brief Returns the RGBA frame data, converting the whole source frame on
+   * first use. Callers that only need timestamps never pay for conversion.
+   * Safe to call while other threads measure the entry with cacheBytes().
+   * @return The RGBA data, or nullptr if there is no source to convert.
+   */
+  const std::shared_ptr<std::vector<uint8_t>> &rgba();
+
+  /**
+   * @brief Approximate memory held by this entry: the RGBA data if converted
+   * plus the decoded source frame.
+   */
+  size_t cacheBytes() const;
 };
 
 /**
  * @class FrameInfoList
- * @brief A class to manage a list of FrameInfo objects with a maximum size.
+ * @brief A class to manage a list of FrameInfo objects within a memory budget.
+ *
+ * Entries that still hold their decoded YUV frame instead of RGBA cost about
+ * 1.5 bytes per pixel rather than 4, so the same budget holds ~2.6x as many.
+ * Shared by requests running on several threads, so access is locked.
  */
 class FrameInfoList
 {
 private:
   std::list<std::shared_ptr<FrameInfo>>
-      frameList;             ///< List of FrameInfo objects.
-  const size_t maxSize = 60; ///< Maximum size of the list.
+      frameList; ///< List of FrameInfo objects.
+  std::mutex lock;
+  const size_t maxBytes =
+      60 * 1920 * 1080 * 4; ///< Budget; 60 RGBA 1080p frames.
+  const size_t minSize = 8; ///< Entries kept regardless of the budget.
+
+  size_t totalBytes() const
+  {
+    size_t total = 0;
+    for (const auto &f : frameList)
+    {
+      total += f->cacheBytes();
+    }
+    return total;
+  }
 
 public:
   /**
    * @brief Adds a frame to the list. If the frame already exists, it is
-   * updated. If the list is full, the oldest frame is removed.
+   * updated. Oldest frames are removed while the list is over budget.
    * @param frame Shared pointer to the FrameInfo object to be added.
    */
   void addFrame(const std::shared_ptr<FrameInfo> &frame)
   {
+    std::lock_guard<std::mutex> guard(lock);
     // Check if frame is already in the list and remove it
     auto it = std::find_if(frameList.begin(), frameList.end(),
                            [&frame](const std::shared_ptr<FrameInfo> &f)
@@ -140,13 +177,17 @@ public:
       // frameList.erase(it);
       return;
     }
-    else if (frameList.size() >= maxSize)
-    {
-      frameList.pop_back();
-    }
 
     // std::cerr << "Adding to cache " << frame->frameNum << std::endl;
     frameList.push_front(frame);
+
+    // Sizes change as entries are converted to RGBA, so re-measure here
+    size_t total = totalBytes();
+    while (frameList.size() > minSize && total > maxBytes)
+    {
+      total -= frameList.back()->cacheBytes();
+      frameList.pop_back();
+    }
   }
 
   /**
@@ -156,6 +197,7 @@ public:
    */
   std::shared_ptr<FrameInfo> getFrame(const std::string &key)
   {
+    std::lock_guard<std::mutex> guard(lock);
     auto it = std::find_if(
         frameList.begin(), frameList.end(),
         [&key](const std::shared_ptr<FrameInfo> &f)
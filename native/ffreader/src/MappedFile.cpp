@@ -0,0 +1,189 @@
+#include "MappedFile.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::filesystem::path utf8Path(const std::string &path)
+{
+  return std::filesystem::path(
+      std::u8string(reinterpret_cast<const char8_t *>(path.data()), path.size()));
+}
+
+MappedFile::~MappedFile() { close(); }
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &path)
+{
+  close();
+  const std::wstring widePath = utf8Path(path).wstring();
+  HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ,
+                            FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return false;
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart <= 0)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping)
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (!view)
+  {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+
+  fileHandle = file;
+  mappingHandle = mapping;
+  mappedData = static_cast<const uint8_t *>(view);
+  mappedSize = static_cast<size_t>(fileSize.QuadPart);
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (mappedData)
+  {
+    UnmapViewOfFile(mappedData);
+  }
+  if (mappingHandle)
+  {
+    CloseHandle(mappingHandle);
+  }
+  if (fileHandle)
+  {
+    CloseHandle(fileHandle);
+  }
+  mappedData = nullptr;
+  mappedSize = 0;
+  mappingHandle = nullptr;
+  fileHandle = nullptr;
+}
+#else
+bool MappedFile::open(const std::string &path)
+{
+  close();
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+  {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0)
+  {
+    ::close(fd);
+    return false;
+  }
+
+  void *view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping keeps its own reference to the file.
+  ::close(fd);
+  if (view == MAP_FAILED)
+  {
+    return false;
+  }
+
+  mappedData = static_cast<const uint8_t *>(view);
+  mappedSize = static_cast<size_t>(st.st_size);
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (mappedData)
+  {
+    munmap(const_cast<uint8_t *>(mappedData), mappedSize);
+  }
+  mappedData = nullptr;
+  mappedSize = 0;
+}
+#endif
+
+bool getFileStamp(const std::string &path, uint64_t &size, int64_t &mtime)
+{
+  std::error_code ec;
+  const auto fsPath = utf8Path(path);
+  const auto fileSize = std::filesystem::file_size(fsPath, ec);
+  if (ec)
+  {
+    return false;
+  }
+  const auto writeTime = std::filesystem::last_write_time(fsPath, ec);
+  if (ec)
+  {
+    return false;
+  }
+  size = static_cast<uint64_t>(fileSize);
+  mtime = static_cast<int64_t>(writeTime.time_since_epoch().count());
+  return true;
+}
+
+std::string siblingPath(const std::string &path, const std::string &suffix)
+{
+  const auto slash = path.find_last_of("/\\");
+  const auto dot = path.find_last_of('.');
+  if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+  {
+    return path + suffix;
+  }
+  return path.substr(0, dot) + suffix;
+}
+
+bool writeFileAtomically(const std::string &path,
+                         const std::vector<std::pair<const void *, size_t>> &parts)
+{
+  const std::string tmpPath = path + ".tmp";
+  {
+    std::ofstream out(utf8Path(tmpPath), std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+      return false;
+    }
+    for (const auto &[data, size] : parts)
+    {
+      out.write(static_cast<const char *>(data), size);
+    }
+    if (!out)
+    {
+      out.close();
+      std::error_code ec;
+      std::filesystem::remove(utf8Path(tmpPath), ec);
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(utf8Path(tmpPath), utf8Path(path), ec);
+  if (ec)
+  {
+    std::cerr << "Unable to write " << path << ": " << ec.message() << std::endl;
+    std::filesystem::remove(utf8Path(tmpPath), ec);
+    return false;
+  }
+  return true;
+}
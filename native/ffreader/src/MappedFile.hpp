@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class MappedFile
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Thin wrapper over mmap() / MapViewOfFile(). Paths are UTF-8, matching what
+ * the rest of the reader hands to FFmpeg.
+ */
+class MappedFile
+{
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  /**
+   * @brief Maps @p path read-only, replacing any previous mapping.
+   * @return true on success. Empty files cannot be mapped and return false.
+   */
+  bool open(const std::string &path);
+
+  /** Unmaps the file. Safe to call when nothing is mapped. */
+  void close();
+
+  /** True while a mapping is held. */
+  bool isOpen() const { return mappedData != nullptr; }
+
+  /** Start of the mapped bytes, or nullptr. */
+  const uint8_t *data() const { return mappedData; }
+
+  /** Number of mapped bytes. */
+  size_t size() const { return mappedSize; }
+
+private:
+  const uint8_t *mappedData = nullptr;
+  size_t mappedSize = 0;
+#ifdef _WIN32
+  void *fileHandle = nullptr;
+  void *mappingHandle = nullptr;
+#endif
+};
+
+/**
+ * @brief Converts a UTF-8 path string to a std::filesystem::path.
+ */
+std::filesystem::path utf8Path(const std::string &path);
+
+/**
+ * @brief Reads the size and modification time of a file.
+ *
+ * @param path UTF-8 path of the file.
+ * @param size Receives the size in bytes.
+ * @param mtime Receives the modification time in filesystem clock ticks. Only
+ *              meaningful for comparing against another value from this call.
+ * @return false if the file cannot be stat'ed.
+ */
+bool getFileStamp(const std::string &path, uint64_t &size, int64_t &mtime);
+
+/**
+ * @brief Path of a file stored next to @p path: @p path with its suffix
+ * replaced by @p suffix (e.g. ".ctidx"), or with @p suffix appended when it
+ * has none.
+ */
+std::string siblingPath(const std::string &path, const std::string &suffix);
+
+/**
+ * @brief Writes @p parts, in order, to @p path.
+ *
+ * Written to a temporary file and renamed into place, so a concurrent
+ * MappedFile::open() never maps a partial file.
+ *
+ * @param parts (data, size) pairs.
+ * @return false if the file could not be written; nothing is left behind.
+ */
+bool writeFileAtomically(const std::string &path,
+                         const std::vector<std::pair<const void *, size_t>> &parts);
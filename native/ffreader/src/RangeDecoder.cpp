@@ -0,0 +1,268 @@
+#include "RangeDecoder.hpp"
+#include "FrameConverter.hpp"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+#include <algorithm>
+#include <iostream>
+
+/** Frames per piece, rounded up to the next keyframe, so seeks are amortized. */
+static constexpr int64_t min_piece_frames = 60;
+
+/** Demuxer and decoder owned by one worker thread. */
+class RangeDecoder::Worker
+{
+public:
+  ~Worker()
+  {
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&codecContext);
+    if (formatContext)
+    {
+      avformat_close_input(&formatContext);
+    }
+  }
+
+  bool open(const RangePlan &plan)
+  {
+    if (avformat_open_input(&formatContext, plan.videoFile.c_str(), nullptr, nullptr) != 0)
+    {
+      std::cerr << "Range decoder couldn't open " << plan.videoFile << std::endl;
+      return false;
+    }
+    if (avformat_find_stream_info(formatContext, nullptr) < 0 || plan.streamIndex < 0 ||
+        plan.streamIndex >= (int)formatContext->nb_streams)
+    {
+      return false;
+    }
+    const AVCodecParameters *par = formatContext->streams[plan.streamIndex]->codecpar;
+    const AVCodec *codec = avcodec_find_decoder(par->codec_id);
+    codecContext = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!codecContext || avcodec_parameters_to_context(codecContext, par) < 0)
+    {
+      return false;
+    }
+    // The pieces are the parallelism; extra frame threads would only add
+    // reorder delay to every seek.
+    codecContext->thread_count = 1;
+    if (plan.skipLoopFilter)
+    {
+      codecContext->skip_loop_filter = AVDISCARD_ALL;
+    }
+    if (avcodec_open2(codecContext, codec, nullptr) < 0)
+    {
+      std::cerr << "Range decoder couldn't open codec for " << plan.videoFile << std::endl;
+      return false;
+    }
+    packet = av_packet_alloc();
+    frame = av_frame_alloc();
+    return packet && frame;
+  }
+
+  AVFormatContext *formatContext = nullptr;
+  AVCodecContext *codecContext = nullptr;
+  AVPacket *packet = nullptr;
+  AVFrame *frame = nullptr;
+};
+
+RangeDecoder::~RangeDecoder() { stop(); }
+
+bool RangeDecoder::start(RangePlan rangePlan, int64_t firstFrame, int64_t lastFrame,
+                         int workers, size_t queueFrames)
+{
+  stop();
+  plan = std::move(rangePlan);
+  const auto &index = plan.index;
+  if (index.empty())
+  {
+    return false;
+  }
+  // 0 to N-1 based positions in the index
+  const int64_t from = std::max<int64_t>(firstFrame - 1, 0);
+  const int64_t to = std::min(lastFrame - 1, index.size() - 1);
+  for (int64_t first = from; first <= to;)
+  {
+    auto after = std::upper_bound(index.keyframes.begin(), index.keyframes.end(), first);
+    Piece piece;
+    piece.seekFrom = after == index.keyframes.begin() ? 0 : *(after - 1);
+    piece.first = first;
+    auto end = std::lower_bound(index.keyframes.begin(), index.keyframes.end(),
+                                first + min_piece_frames);
+    piece.last = std::min(end == index.keyframes.end() ? index.size() - 1 : *end - 1, to);
+    pieces.push_back(std::move(piece));
+    first = pieces.back().last + 1;
+  }
+  if (pieces.empty())
+  {
+    return false;
+  }
+
+  capacity = std::max<size_t>(queueFrames, 1);
+  const int count = std::clamp(workers, 1, (int)pieces.size());
+  for (int i = 0; i < count; i++)
+  {
+    threads.emplace_back(&RangeDecoder::workerLoop, this);
+  }
+  return true;
+}
+
+void RangeDecoder::stop()
+{
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  changed.notify_all();
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+  threads.clear();
+  pieces.clear();
+  nextPiece = 0;
+  deliverPiece = 0;
+  queued = 0;
+  stopping = false;
+  failure = false;
+}
+
+bool RangeDecoder::next(RangeFrame &frame)
+{
+  std::unique_lock<std::mutex> guard(lock);
+  for (;;)
+  {
+    changed.wait(guard, [&]()
+                 { return deliverPiece >= pieces.size() ||
+                          !pieces[deliverPiece].frames.empty() || pieces[deliverPiece].done; });
+    if (deliverPiece >= pieces.size())
+    {
+      return false;
+    }
+    auto &piece = pieces[deliverPiece];
+    if (!piece.frames.empty())
+    {
+      frame = std::move(piece.frames.front());
+      piece.frames.pop_front();
+      queued--;
+      changed.notify_all();
+      return true;
+    }
+    if (piece.failed)
+    {
+      // Frames of earlier pieces have all been returned by now.
+      return false;
+    }
+    // Done and drained; the worker of the following piece may now run freely.
+    deliverPiece++;
+    changed.notify_all();
+  }
+}
+
+bool RangeDecoder::push(size_t p, RangeFrame frame)
+{
+  std::unique_lock<std::mutex> guard(lock);
+  changed.wait(guard, [&]()
+               { return stopping || p == deliverPiece || queued < capacity; });
+  if (stopping)
+  {
+    return false;
+  }
+  pieces[p].frames.push_back(std::move(frame));
+  queued++;
+  changed.notify_all();
+  return true;
+}
+
+void RangeDecoder::workerLoop()
+{
+  Worker worker;
+  const bool opened = worker.open(plan);
+  for (;;)
+  {
+    size_t p;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      if (stopping || failure || nextPiece >= pieces.size())
+      {
+        return;
+      }
+      p = nextPiece++;
+    }
+    const bool ok = opened && decodePiece(worker, p);
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      pieces[p].done = true;
+      if (!ok && !stopping)
+      {
+        // Later pieces are left undecoded; next() stops at this one.
+        pieces[p].failed = true;
+        failure = true;
+      }
+    }
+    changed.notify_all();
+  }
+}
+
+bool RangeDecoder::decodePiece(Worker &worker, size_t p)
+{
+  const auto &index = plan.index;
+  const int64_t first = pieces[p].first;
+  const int64_t last = pieces[p].last;
+  if (av_seek_frame(worker.formatContext, plan.streamIndex, index.framePts[pieces[p].seekFrom],
+                    AVSEEK_FLAG_BACKWARD) < 0)
+  {
+    return false;
+  }
+  avcodec_flush_buffers(worker.codecContext);
+
+  // Frames come out in presentation order. Those before the piece are the
+  // lead-in from its keyframe (or the previous piece's open-GOP tail).
+  bool reached = false;
+  bool ok = true;
+  auto receiveFrames = [&]()
+  {
+    while (ok && !reached && avcodec_receive_frame(worker.codecContext, worker.frame) >= 0)
+    {
+      const int64_t pts = worker.frame->pts != AV_NOPTS_VALUE ? worker.frame->pts
+                                                              : worker.frame->pkt_dts;
+      const int64_t position = index.nearestFrame(pts - plan.ptsOffset);
+      if (position > last)
+      {
+        reached = true;
+      }
+      else if (position >= first)
+      {
+        RangeFrame decoded;
+        decoded.frameNumber = position + 1;
+        decoded.frame = shareFrame(worker.frame);
+        ok = push(p, std::move(decoded));
+        reached = position == last;
+      }
+      av_frame_unref(worker.frame);
+    }
+  };
+
+  int ret;
+  while (ok && !reached && !stopping &&
+         ((ret = av_read_frame(worker.formatContext, worker.packet)) >= 0 ||
+          ret == AVERROR(EAGAIN)))
+  {
+    if (ret >= 0 && worker.packet->stream_index == plan.streamIndex &&
+        avcodec_send_packet(worker.codecContext, worker.packet) >= 0)
+    {
+      receiveFrames();
+    }
+    av_packet_unref(worker.packet);
+  }
+  if (ok && !reached && !stopping)
+  {
+    // End of file: the decoder still holds the last reordered frames.
+    avcodec_send_packet(worker.codecContext, nullptr);
+    receiveFrames();
+  }
+  return ok || stopping;
+}
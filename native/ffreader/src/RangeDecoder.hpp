@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "VideoIndex.hpp"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief What a RangeDecoder reads, resolved on the caller's thread so the
+ * workers never touch the reader.
+ */
+struct RangePlan
+{
+  std::string videoFile;
+  int streamIndex = -1;
+  /** Frame index of the file; pieces start on its keyframes. */
+  VideoIndex index;
+  /** Decoded pts minus index timestamp, see FFVideoReader::getIndexOffset(). */
+  int64_t ptsOffset = 0;
+  /** Skips the loop filter, for passes that only read coarse features. */
+  bool skipLoopFilter = false;
+};
+
+/** A decoded frame and its 1 to N frame number. */
+struct RangeFrame
+{
+  int64_t frameNumber = 0;
+  std::shared_ptr<AVFrame> frame;
+};
+
+/**
+ * @class RangeDecoder
+ * @brief Decodes a span of frames on several threads and returns them in
+ * order.
+ *
+ * The span is split at keyframes into pieces of a few GOPs. Each worker owns
+ * a demuxer and a single-threaded decoder and takes the next piece, so a
+ * whole-file pass scales with cores rather than with one decoder's frame
+ * threads. Frames wait in a queue bounded by frame count; the worker on the
+ * piece the caller is reading is never held back, so the queue cannot stall.
+ *
+ * Frame numbers follow the frame index, as FFVideoReader numbers them.
+ */
+class RangeDecoder
+{
+public:
+  RangeDecoder() = default;
+  ~RangeDecoder();
+
+  RangeDecoder(const RangeDecoder &) = delete;
+  RangeDecoder &operator=(const RangeDecoder &) = delete;
+
+  /**
+   * @brief Starts decoding frames @p firstFrame to @p lastFrame.
+   *
+   * @param plan File, stream and frame index to decode from.
+   * @param firstFrame First frame - 1 to N.
+   * @param lastFrame Last frame, inclusive - 1 to N.
+   * @param workers Decoder threads, at least 1.
+   * @param queueFrames Decoded frames that may wait for next().
+   * @return false without a frame index or for an empty span.
+   */
+  bool start(RangePlan plan, int64_t firstFrame, int64_t lastFrame, int workers,
+             size_t queueFrames);
+
+  /**
+   * @brief Waits for the next frame in frame order.
+   *
+   * @return false once the span is done, or on reaching a piece that failed
+   *         to decode.
+   */
+  bool next(RangeFrame &frame);
+
+  /** Stops and joins the workers; frames not yet returned are dropped. */
+  void stop();
+
+  /** True if a piece could not be decoded. */
+  bool failed() const { return failure; }
+
+private:
+  /** Frames [first, last] of the index, decoded from keyframe seekFrom. */
+  struct Piece
+  {
+    int64_t seekFrom = 0;
+    int64_t first = 0;
+    int64_t last = 0;
+    std::deque<RangeFrame> frames;
+    bool done = false;
+    bool failed = false;
+  };
+
+  class Worker;
+
+  void workerLoop();
+
+  /** Decodes piece @p p on @p worker; false on a decode error. */
+  bool decodePiece(Worker &worker, size_t p);
+
+  /** Queues a frame of piece @p p, waiting for room; false when stopping. */
+  bool push(size_t p, RangeFrame frame);
+
+  RangePlan plan;
+  std::vector<Piece> pieces;
+  std::vector<std::thread> threads;
+  std::mutex lock;
+  std::condition_variable changed;
+  size_t nextPiece = 0;
+  size_t deliverPiece = 0;
+  size_t queued = 0;
+  size_t capacity = 0;
+  std::atomic<bool> stopping{false};
+  std::atomic<bool> failure{false};
+};
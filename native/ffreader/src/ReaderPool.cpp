@@ -0,0 +1,108 @@
+#include "ReaderPool.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+/**
+ * Opening a reader costs about as much as decoding this many frames. Seeks
+ * cheaper than that move a parked cursor instead.
+ */
+static constexpr int64_t open_cursor_cost_frames = 30;
+
+void ReaderPool::configure(size_t cursorCount, size_t frameStoreBytes)
+{
+  maxCursors = std::max<size_t>(cursorCount, 1);
+  cursorStoreBytes = frameStoreBytes;
+  if (cursors.size() + 1 > maxCursors)
+  {
+    cursors.resize(maxCursors - 1);
+  }
+  for (auto &cursor : cursors)
+  {
+    cursor.reader->setFrameStore(cursorStoreBytes, 1.0);
+  }
+}
+
+void ReaderPool::setPrefetch(bool enable, size_t budgetBytes, size_t reverseBudgetBytes)
+{
+  prefetchEnabled = enable;
+  prefetchBytes = budgetBytes;
+  reverseBytes = reverseBudgetBytes;
+  for (auto &cursor : cursors)
+  {
+    cursor.reader->setPrefetch(prefetchEnabled, prefetchBytes, reverseBytes);
+  }
+}
+
+std::unique_ptr<FFVideoReader> ReaderPool::openCursor(FFVideoReader &primary)
+{
+  const VideoIndex index = primary.copyFrameIndex();
+  std::unique_ptr<FFVideoReader> reader(new FFVideoReader());
+  reader->setFileIO(primary.getFileIOMode(), primary.getReadAheadBytes());
+  reader->setFrameStore(cursorStoreBytes, 1.0);
+  if (reader->openFile(primary.getFilename(), false, &index))
+  {
+    std::cerr << "Couldn't open another cursor on " << primary.getFilename() << std::endl;
+    return nullptr;
+  }
+  if (prefetchEnabled)
+  {
+    reader->setPrefetch(true, prefetchBytes, reverseBytes);
+  }
+  return reader;
+}
+
+const std::unique_ptr<FFVideoReader> &
+ReaderPool::select(const std::unique_ptr<FFVideoReader> &primary, int64_t frameNumber)
+{
+  useCount++;
+  bool seeks = false;
+  int64_t bestCost = primary->getDecodeCost(frameNumber, &seeks);
+  bool bestSeeks = seeks;
+  Cursor *best = nullptr;
+  for (auto &cursor : cursors)
+  {
+    const int64_t cost = cursor.reader->getDecodeCost(frameNumber, &seeks);
+    if (cost < bestCost || (cost == bestCost && bestSeeks && !seeks))
+    {
+      bestCost = cost;
+      bestSeeks = seeks;
+      best = &cursor;
+    }
+  }
+
+  if (bestSeeks && maxCursors > 1)
+  {
+    // Every cursor would leave its position. Use a new cursor while there is
+    // room and the seek outweighs opening it, else the least recently used
+    // one, so the rest stay parked.
+    std::unique_ptr<FFVideoReader> reader;
+    if (cursors.size() + 1 < maxCursors && bestCost >= open_cursor_cost_frames &&
+        (reader = openCursor(*primary)))
+    {
+      cursors.push_back({std::move(reader), 0});
+      best = &cursors.back();
+    }
+    else
+    {
+      best = nullptr;
+      uint64_t oldest = primaryLastUsed;
+      for (auto &cursor : cursors)
+      {
+        if (cursor.lastUsed < oldest)
+        {
+          oldest = cursor.lastUsed;
+          best = &cursor;
+        }
+      }
+    }
+  }
+
+  if (!best)
+  {
+    primaryLastUsed = useCount;
+    return primary;
+  }
+  best->lastUsed = useCount;
+  return best->reader;
+}
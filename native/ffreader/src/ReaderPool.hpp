@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "FFReader.hpp"
+
+/**
+ * @class ReaderPool
+ * @brief Extra decode cursors for one file, each parked where it last read.
+ *
+ * Flipping between two positions further apart than the frame store and
+ * forward window makes a single reader seek and decode a whole GOP on every
+ * flip. The pool keeps a few more readers of the same file and sends each
+ * request to the reader that can serve it most cheaply, so a return to a
+ * recent position is a frame store hit or a short forward decode.
+ *
+ * The file's primary reader is passed in by the caller and counts as one
+ * cursor; extra cursors are opened on the first request that would otherwise
+ * move every cursor by a whole seek, sharing the primary's frame index and
+ * prefetch settings. When all cursors are open, or the seek is cheaper than
+ * opening another reader, the least recently used one is moved. Off (one
+ * cursor) until configured. Not thread-safe; used from the thread that
+ * serves frame requests.
+ */
+class ReaderPool
+{
+public:
+  /**
+   * @brief Sets the number of cursors, including the primary reader.
+   *
+   * Extra cursors beyond the new limit are closed; 1 disables the pool.
+   *
+   * @param cursorCount Cursors per file, at least 1.
+   * @param frameStoreBytes Frame store budget of each extra cursor.
+   */
+  void configure(size_t cursorCount, size_t frameStoreBytes);
+
+  /** Cursors per file, including the primary reader, see configure(). */
+  size_t cursorLimit() const { return maxCursors; }
+
+  /**
+   * @brief Applies the primary reader's prefetch settings to every cursor,
+   * open now or later. See FFVideoReader::setPrefetch().
+   */
+  void setPrefetch(bool enable, size_t budgetBytes, size_t reverseBytes);
+
+  /**
+   * @brief Returns the reader that can decode @p frameNumber most cheaply.
+   *
+   * @param primary The file's own reader.
+   * @param frameNumber The frame to decode - 1 to N.
+   * @return @p primary or one of the extra cursors.
+   */
+  const std::unique_ptr<FFVideoReader> &select(const std::unique_ptr<FFVideoReader> &primary,
+                                               int64_t frameNumber);
+
+  /** Closes the extra cursors, e.g. once their frame index is out of date. */
+  void clear() { cursors.clear(); }
+
+  /** Open cursors, including the primary reader. */
+  size_t openCursors() const { return cursors.size() + 1; }
+
+private:
+  struct Cursor
+  {
+    std::unique_ptr<FFVideoReader> reader;
+    uint64_t lastUsed = 0;
+  };
+
+  /** Opens another reader of the primary's file, or returns nullptr. */
+  std::unique_ptr<FFVideoReader> openCursor(FFVideoReader &primary);
+
+  std::vector<Cursor> cursors;
+  uint64_t primaryLastUsed = 0;
+  uint64_t useCount = 0;
+  size_t maxCursors = 1;
+  size_t cursorStoreBytes = 64 * 1024 * 1024;
+  bool prefetchEnabled = false;
+  size_t prefetchBytes = 0;
+  size_t reverseBytes = 0;
+};
@@ -0,0 +1,138 @@
+#include "ScrubDecoder.hpp"
+#include "FrameConverter.hpp"
+
+#include <iostream>
+
+/** Packets to read past the seek point while looking for the keyframe. */
+static constexpr int max_scrub_packets = 256;
+
+ScrubDecoder::~ScrubDecoder() { close(); }
+
+void ScrubDecoder::close()
+{
+  if (codecContext)
+  {
+    avcodec_free_context(&codecContext);
+  }
+  if (formatContext)
+  {
+    avformat_close_input(&formatContext);
+  }
+  if (packet)
+  {
+    av_packet_free(&packet);
+  }
+  filename.clear();
+  streamIndex = -1;
+  lowres = -1;
+}
+
+bool ScrubDecoder::open(const std::string &file, int stream, int maxWidth)
+{
+  if (file != filename || stream != streamIndex)
+  {
+    close();
+    if (avformat_open_input(&formatContext, file.c_str(), nullptr, nullptr) != 0)
+    {
+      std::cerr << "Scrub decoder couldn't open " << file << std::endl;
+      return false;
+    }
+    if (avformat_find_stream_info(formatContext, nullptr) < 0 ||
+        stream < 0 || stream >= (int)formatContext->nb_streams)
+    {
+      close();
+      return false;
+    }
+    packet = av_packet_alloc();
+    filename = file;
+    streamIndex = stream;
+  }
+
+  const AVCodecParameters *par = formatContext->streams[streamIndex]->codecpar;
+  const AVCodec *codec = avcodec_find_decoder(par->codec_id);
+  if (!codec)
+  {
+    return false;
+  }
+  int level = 0;
+  while (maxWidth > 0 && level < codec->max_lowres &&
+         (par->width >> (level + 1)) >= maxWidth)
+  {
+    level++;
+  }
+  return level == lowres && codecContext ? true : openDecoder(level);
+}
+
+bool ScrubDecoder::openDecoder(int level)
+{
+  if (codecContext)
+  {
+    avcodec_free_context(&codecContext);
+  }
+  lowres = -1;
+  const AVCodecParameters *par = formatContext->streams[streamIndex]->codecpar;
+  const AVCodec *codec = avcodec_find_decoder(par->codec_id);
+  codecContext = avcodec_alloc_context3(codec);
+  if (!codecContext || avcodec_parameters_to_context(codecContext, par) < 0)
+  {
+    return false;
+  }
+  codecContext->skip_frame = AVDISCARD_NONKEY;
+  codecContext->skip_loop_filter = AVDISCARD_ALL;
+  // Slice threads split each keyframe without adding frame-thread delay.
+  // Four leave cores for the exact decoder that runs alongside.
+  codecContext->thread_type = FF_THREAD_SLICE;
+  codecContext->thread_count = 4;
+  codecContext->lowres = level;
+  if (avcodec_open2(codecContext, codec, nullptr) < 0)
+  {
+    std::cerr << "Scrub decoder couldn't open codec for " << filename << std::endl;
+    avcodec_free_context(&codecContext);
+    return false;
+  }
+  lowres = level;
+  return true;
+}
+
+std::shared_ptr<AVFrame> ScrubDecoder::decodeAt(int64_t keyframeTs)
+{
+  if (!codecContext)
+  {
+    return nullptr;
+  }
+  if (av_seek_frame(formatContext, streamIndex, keyframeTs, AVSEEK_FLAG_BACKWARD) < 0)
+  {
+    return nullptr;
+  }
+  avcodec_flush_buffers(codecContext);
+
+  AVFrame *decoded = av_frame_alloc();
+  if (!decoded)
+  {
+    return nullptr;
+  }
+  std::shared_ptr<AVFrame> result;
+  for (int read = 0; read < max_scrub_packets && !result; read++)
+  {
+    if (av_read_frame(formatContext, packet) < 0)
+    {
+      break;
+    }
+    const bool keyPacket = packet->stream_index == streamIndex &&
+                           (packet->flags & AV_PKT_FLAG_KEY);
+    // Non-keyframes would be discarded by the decoder anyway; don't send them.
+    if (keyPacket && avcodec_send_packet(codecContext, packet) >= 0)
+    {
+      // Drain so the frame comes out now rather than after the reorder delay.
+      avcodec_send_packet(codecContext, nullptr);
+      if (avcodec_receive_frame(codecContext, decoded) >= 0)
+      {
+        result = shareFrame(decoded);
+      }
+      avcodec_flush_buffers(codecContext);
+    }
+    av_packet_unref(packet);
+  }
+  av_frame_free(&decoded);
+  return result;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @class ScrubDecoder
+ * @brief Keyframe-only decoder for fast previews while dragging.
+ *
+ * Owns its own demuxer and software decoder, so seeking here never moves the
+ * exact-decode position of the FFVideoReader that owns it. The decoder skips
+ * every non-keyframe (AVDISCARD_NONKEY) and the loop filter, uses slice
+ * threading so a frame comes out for every packet sent, and decodes at
+ * reduced resolution (lowres) when the codec supports it.
+ */
+class ScrubDecoder
+{
+public:
+  ScrubDecoder() = default;
+  ~ScrubDecoder();
+
+  ScrubDecoder(const ScrubDecoder &) = delete;
+  ScrubDecoder &operator=(const ScrubDecoder &) = delete;
+
+  /**
+   * @brief Opens @p filename, or keeps the current file open.
+   *
+   * @param streamIndex The video stream to decode.
+   * @param maxWidth Preferred output width; picks the largest lowres level
+   *                 that still yields at least this width. 0 for full size.
+   * @return false if the file or decoder cannot be opened.
+   */
+  bool open(const std::string &filename, int streamIndex, int maxWidth);
+
+  /** Releases the demuxer and decoder. */
+  void close();
+
+  /**
+   * @brief Seeks to the keyframe at @p keyframeTs and decodes it.
+   *
+   * @param keyframeTs Keyframe timestamp in the seek domain of the stream,
+   *                   e.g. from VideoIndex::framePts.
+   * @return The decoded keyframe, or nullptr on failure.
+   */
+  std::shared_ptr<AVFrame> decodeAt(int64_t keyframeTs);
+
+private:
+  /** (Re)opens the decoder at @p lowres. */
+  bool openDecoder(int lowres);
+
+  std::string filename;
+  AVFormatContext *formatContext = nullptr;
+  AVCodecContext *codecContext = nullptr;
+  AVPacket *packet = nullptr;
+  int streamIndex = -1;
+  int lowres = -1;
+};
@@ -0,0 +1,184 @@
+#include "ThumbnailAtlas.hpp"
+#include "FrameConverter.hpp"
+#include "ScrubDecoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+// Atlases of another version are ignored and rebuilt, so change this along
+// with AtlasHeader or the payload layout.
+constexpr static uint32_t atlas_version = 1;
+constexpr static char atlas_magic[8] = {'C', 'T', 'T', 'H', 'U', 'M', 'B', 0};
+// Keeps the atlas within common GPU texture limits.
+constexpr static uint32_t max_atlas_width = 4096;
+
+/**
+ * On-disk layout: AtlasHeader, then count int64 frame numbers, then the RGBA
+ * atlas rows. Native (little) endian.
+ */
+struct AtlasHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  uint64_t videoSize;
+  int64_t videoMtime;
+  ThumbnailAtlasLayout layout;
+  uint32_t reserved;
+};
+static_assert(std::is_trivially_copyable<AtlasHeader>::value,
+              "AtlasHeader is written with a raw copy");
+static_assert(sizeof(AtlasHeader) % sizeof(int64_t) == 0,
+              "frame numbers must stay aligned in the mapping");
+
+std::string thumbnailAtlasPath(const std::string &videoFile)
+{
+  return siblingPath(videoFile, ".ctthumb");
+}
+
+bool ThumbnailAtlas::load(const std::string &videoFile, uint32_t count,
+                          uint32_t thumbWidth)
+{
+  frames = nullptr;
+  pixelData = nullptr;
+  atlasLayout = ThumbnailAtlasLayout();
+  builtFrames.clear();
+  builtPixels.clear();
+
+  uint64_t videoSize;
+  int64_t videoMtime;
+  if (!getFileStamp(videoFile, videoSize, videoMtime) ||
+      !file.open(thumbnailAtlasPath(videoFile)) ||
+      file.size() < sizeof(AtlasHeader))
+  {
+    file.close();
+    return false;
+  }
+
+  AtlasHeader header;
+  memcpy(&header, file.data(), sizeof(header));
+  const auto &layout = header.layout;
+  if (memcmp(header.magic, atlas_magic, sizeof(atlas_magic)) != 0 ||
+      header.version != atlas_version || header.headerSize != sizeof(AtlasHeader) ||
+      header.videoSize != videoSize || header.videoMtime != videoMtime ||
+      layout.count != count || layout.thumbWidth != thumbWidth ||
+      layout.thumbHeight == 0 || layout.columns == 0 ||
+      (uint64_t)layout.columns * layout.rows < layout.count ||
+      file.size() < sizeof(AtlasHeader) + layout.count * sizeof(int64_t) +
+                        layout.bytes())
+  {
+    file.close();
+    return false;
+  }
+
+  atlasLayout = layout;
+  frames = reinterpret_cast<const int64_t *>(file.data() + sizeof(AtlasHeader));
+  pixelData = file.data() + sizeof(AtlasHeader) + layout.count * sizeof(int64_t);
+  return true;
+}
+
+/** @brief Writes the atlas next to the video. */
+static bool saveThumbnailAtlas(const std::string &videoFile,
+                               const ThumbnailAtlasLayout &layout,
+                               const std::vector<int64_t> &frameNumbers,
+                               const std::vector<uint8_t> &pixels)
+{
+  AtlasHeader header{};
+  memcpy(header.magic, atlas_magic, sizeof(atlas_magic));
+  header.version = atlas_version;
+  header.headerSize = sizeof(AtlasHeader);
+  if (!getFileStamp(videoFile, header.videoSize, header.videoMtime))
+  {
+    return false;
+  }
+  header.layout = layout;
+
+  return writeFileAtomically(
+      thumbnailAtlasPath(videoFile),
+      {{&header, sizeof(header)},
+       {frameNumbers.data(), frameNumbers.size() * sizeof(int64_t)},
+       {pixels.data(), pixels.size()}});
+}
+
+bool ThumbnailAtlas::build(const ThumbnailPlan &plan, const std::atomic<bool> &cancel,
+                           std::atomic<int> &progress)
+{
+  const uint32_t count = (uint32_t)plan.frameNumbers.size();
+  if (count == 0 || plan.thumbWidth == 0 || plan.keyframeTs.size() != count)
+  {
+    return false;
+  }
+
+  ScrubDecoder decoder;
+  if (!decoder.open(plan.videoFile, plan.streamIndex, (int)plan.thumbWidth))
+  {
+    return false;
+  }
+
+  ThumbnailAtlasLayout layout;
+  layout.count = count;
+  layout.thumbWidth = plan.thumbWidth;
+  layout.columns = std::max(1u, std::min(count, max_atlas_width / plan.thumbWidth));
+  layout.rows = (count + layout.columns - 1) / layout.columns;
+
+  std::vector<int64_t> frameNumbers(count, 0);
+  std::vector<uint8_t> pixels;
+  std::shared_ptr<AVFrame> decoded;
+  int64_t decodedTs = 0;
+  auto &converter = FrameConverter::forThread();
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (cancel)
+    {
+      return false;
+    }
+    if (!decoded || plan.keyframeTs[i] != decodedTs)
+    {
+      decoded = decoder.decodeAt(plan.keyframeTs[i]);
+      decodedTs = plan.keyframeTs[i];
+    }
+    if (decoded && layout.thumbHeight == 0)
+    {
+      // Sized from the first decoded frame; lowres keeps the aspect ratio.
+      const double aspect = (double)decoded->height / decoded->width;
+      layout.thumbHeight =
+          std::max(2u, (uint32_t)std::lround(plan.thumbWidth * aspect) & ~1u);
+      pixels.assign(layout.bytes(), 0);
+    }
+    if (decoded)
+    {
+      uint8_t *tile = pixels.data() +
+                      (size_t)(i / layout.columns) * layout.thumbHeight * layout.stride() +
+                      (size_t)(i % layout.columns) * layout.thumbWidth * 4;
+      if (converter.toRGBA(decoded.get(), 0, 0, decoded->width, decoded->height,
+                           (int)layout.thumbWidth, (int)layout.thumbHeight, tile,
+                           (int)layout.stride()))
+      {
+        frameNumbers[i] = plan.frameNumbers[i];
+      }
+    }
+    progress++;
+  }
+
+  if (layout.thumbHeight == 0)
+  {
+    std::cerr << "No thumbnails could be decoded for " << plan.videoFile << std::endl;
+    return false;
+  }
+  if (!saveThumbnailAtlas(plan.videoFile, layout, frameNumbers, pixels))
+  {
+    std::cerr << "Thumbnail atlas for " << plan.videoFile
+              << " kept in memory only" << std::endl;
+  }
+
+  file.close();
+  atlasLayout = layout;
+  builtFrames = std::move(frameNumbers);
+  builtPixels = std::move(pixels);
+  frames = builtFrames.data();
+  pixelData = builtPixels.data();
+  return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+
+/**
+ * @brief Grid geometry of a thumbnail atlas.
+ *
+ * Thumbnails are packed left to right, top to bottom into one RGBA image of
+ * columns x rows tiles.
+ */
+struct ThumbnailAtlasLayout
+{
+  uint32_t count = 0;       ///< Number of thumbnails.
+  uint32_t thumbWidth = 0;  ///< Width of one tile in pixels.
+  uint32_t thumbHeight = 0; ///< Height of one tile in pixels.
+  uint32_t columns = 0;     ///< Tiles per atlas row.
+  uint32_t rows = 0;        ///< Tile rows in the atlas.
+
+  uint32_t width() const { return columns * thumbWidth; }
+  uint32_t height() const { return rows * thumbHeight; }
+  size_t stride() const { return (size_t)width() * 4; }
+  size_t bytes() const { return stride() * height(); }
+};
+
+/**
+ * @brief What to decode for each thumbnail, resolved against the frame index
+ * on the caller's thread so the build never touches the reader.
+ */
+struct ThumbnailPlan
+{
+  std::string videoFile;
+  int streamIndex = -1;
+  uint32_t thumbWidth = 0;
+  std::vector<int64_t> frameNumbers; ///< 1 to N keyframe shown by each tile.
+  std::vector<int64_t> keyframeTs;   ///< Seek timestamp of each keyframe.
+};
+
+/**
+ * @brief Path of the thumbnail atlas for a video: the video path with its
+ * suffix replaced by `.ctthumb`, alongside the `.ctidx` index cache.
+ */
+std::string thumbnailAtlasPath(const std::string &videoFile);
+
+/**
+ * @class ThumbnailAtlas
+ * @brief A filmstrip of evenly spaced thumbnails packed into one image.
+ *
+ * Either maps an existing `.ctthumb` file or builds the atlas and writes
+ * one. A file is only accepted when its format version and the video's size
+ * and mtime match, so a replaced or growing recording gets a fresh atlas.
+ */
+class ThumbnailAtlas
+{
+public:
+  /**
+   * @brief Maps the atlas of @p videoFile.
+   *
+   * @param count Required number of thumbnails.
+   * @param thumbWidth Required tile width.
+   * @return true if a valid atlas with this geometry was mapped.
+   */
+  bool load(const std::string &videoFile, uint32_t count, uint32_t thumbWidth);
+
+  /**
+   * @brief Decodes the keyframes of @p plan on a private ScrubDecoder and
+   * packs them into the atlas, then writes the `.ctthumb` file.
+   *
+   * Meant for a background thread. Consecutive tiles that share a keyframe
+   * are decoded once. The atlas stays usable from memory if the file cannot
+   * be written (e.g. read-only media).
+   *
+   * @param cancel Checked between thumbnails.
+   * @param progress Incremented as each thumbnail is done.
+   * @return true if the atlas was built.
+   */
+  bool build(const ThumbnailPlan &plan, const std::atomic<bool> &cancel,
+             std::atomic<int> &progress);
+
+  const ThumbnailAtlasLayout &layout() const { return atlasLayout; }
+
+  /** The 1 to N frame shown by each tile, 0 where decoding failed. */
+  const int64_t *frameNumbers() const { return frames; }
+
+  /** RGBA atlas pixels, layout().bytes() long. */
+  const uint8_t *pixels() const { return pixelData; }
+
+private:
+  MappedFile file;
+  std::vector<int64_t> builtFrames;
+  std::vector<uint8_t> builtPixels;
+  ThumbnailAtlasLayout atlasLayout;
+  const int64_t *frames = nullptr;
+  const uint8_t *pixelData = nullptr;
+};
@@ -0,0 +1,306 @@
+#include "TimestampTable.hpp"
+#include "FrameConverter.hpp"
+#include "RangeDecoder.hpp"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavutil/pixdesc.h>
+}
+
+#include <algorithm>
+#include <iostream>
+
+/** Width in pixels of the encoded time: 64 bits, two pixels per bit. */
+static constexpr int timestamp_strip_width = 128;
+
+/** Decoded frames each range worker may have waiting. */
+static constexpr size_t range_queue_frames_per_worker = 4;
+
+/**
+ * @brief Reads 64 bits, two pixels per bit, from one row.
+ *
+ * Same rule as extractTimestampFromFrame(): a bit is 1 when its two pixels
+ * sum above 220. Holds for the luma of white/black in either range as well
+ * as for the red channel of RGBA.
+ *
+ * @param row First pixel of the row.
+ * @param step Bytes between horizontally adjacent pixels.
+ */
+static uint64_t readTimestampBits(const uint8_t *row, int step)
+{
+  uint64_t number = 0;
+  for (int col = 0; col < 64; col++)
+  {
+    const bool isWhite = row[col * 2 * step] + row[(col * 2 + 1) * step] > 220;
+    number = (number << 1) | (isWhite ? 1 : 0);
+  }
+  return number;
+}
+
+/**
+ * @brief Reads the 100ns UTC time encoded in the first rows of @p frame.
+ *
+ * Row 0 must be black and row 1 holds the time, as in
+ * extractTimestampFromFrame(). 8-bit formats are read from the luma plane
+ * directly; anything else converts the two rows to RGBA first.
+ *
+ * @return The time in 100ns units, or 0 if none is encoded.
+ */
+static uint64_t readFrameTimestamp(const AVFrame *frame, std::vector<uint8_t> &strip)
+{
+  if (frame->width < timestamp_strip_width || frame->height < 2)
+  {
+    return 0;
+  }
+  const uint8_t *rows[2];
+  int step;
+  const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get((AVPixelFormat)frame->format);
+  if (desc && desc->comp[0].depth == 8 &&
+      !(desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_BITSTREAM |
+                       AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_RGB)))
+  {
+    const AVComponentDescriptor &luma = desc->comp[0];
+    rows[0] = frame->data[luma.plane] + luma.offset;
+    rows[1] = rows[0] + frame->linesize[luma.plane];
+    step = luma.step;
+  }
+  else
+  {
+    strip.resize((size_t)timestamp_strip_width * 2 * 4);
+    if (!FrameConverter::forThread().toRGBA(frame, 0, 0, timestamp_strip_width, 2,
+                                            strip.data(), timestamp_strip_width * 4))
+    {
+      return 0;
+    }
+    rows[0] = strip.data();
+    rows[1] = strip.data() + timestamp_strip_width * 4;
+    step = 4;
+  }
+  if (readTimestampBits(rows[0], step) != 0)
+  {
+    return 0;
+  }
+  return readTimestampBits(rows[1], step);
+}
+
+bool TimestampTable::buildFromPackets(const TimestampPlan &plan,
+                                      AVFormatContext *formatContext,
+                                      const std::atomic<bool> &cancel,
+                                      std::atomic<int64_t> &progress)
+{
+  const AVRational timeBase = formatContext->streams[plan.streamIndex]->time_base;
+  AVPacket *packet = av_packet_alloc();
+  if (!packet)
+  {
+    return false;
+  }
+  int ret;
+  while (!cancel &&
+         ((ret = av_read_frame(formatContext, packet)) >= 0 || ret == AVERROR(EAGAIN)))
+  {
+    if (ret >= 0 && packet->stream_index == plan.streamIndex)
+    {
+      const int64_t pts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+      if (pts != AV_NOPTS_VALUE)
+      {
+        // Same arithmetic as the reader uses for decoded frames.
+        framePts.push_back(pts);
+        frameTsMicro.push_back(plan.firstUtcUs +
+                               1000000 * pts * timeBase.num / timeBase.den);
+        progress++;
+      }
+    }
+    av_packet_unref(packet);
+  }
+  av_packet_free(&packet);
+  return !cancel;
+}
+
+bool TimestampTable::buildFromPixels(const TimestampPlan &plan,
+                                     AVFormatContext *formatContext,
+                                     const std::atomic<bool> &cancel,
+                                     std::atomic<int64_t> &progress)
+{
+  const AVCodecParameters *par = formatContext->streams[plan.streamIndex]->codecpar;
+  const AVCodec *codec = avcodec_find_decoder(par->codec_id);
+  AVCodecContext *codecContext = codec ? avcodec_alloc_context3(codec) : nullptr;
+  if (!codecContext || avcodec_parameters_to_context(codecContext, par) < 0)
+  {
+    avcodec_free_context(&codecContext);
+    return false;
+  }
+  // Only two rows of black and white blocks are read, which survive without
+  // the loop filter. Two threads keep the pass from competing with playback.
+  codecContext->skip_loop_filter = AVDISCARD_ALL;
+  codecContext->thread_count = 2;
+  if (avcodec_open2(codecContext, codec, nullptr) < 0)
+  {
+    std::cerr << "Timestamp pass couldn't open codec for " << plan.videoFile << std::endl;
+    avcodec_free_context(&codecContext);
+    return false;
+  }
+
+  AVPacket *packet = av_packet_alloc();
+  AVFrame *frame = av_frame_alloc();
+  std::vector<uint8_t> strip;
+  auto receiveFrames = [&]()
+  {
+    while (avcodec_receive_frame(codecContext, frame) >= 0)
+    {
+      addPixelFrame(frame, strip);
+      progress++;
+      av_frame_unref(frame);
+    }
+  };
+
+  int ret;
+  while (packet && frame && !cancel &&
+         ((ret = av_read_frame(formatContext, packet)) >= 0 || ret == AVERROR(EAGAIN)))
+  {
+    if (ret >= 0 && packet->stream_index == plan.streamIndex &&
+        avcodec_send_packet(codecContext, packet) >= 0)
+    {
+      receiveFrames();
+    }
+    av_packet_unref(packet);
+  }
+  if (!cancel)
+  {
+    avcodec_send_packet(codecContext, nullptr);
+    receiveFrames();
+  }
+  av_frame_free(&frame);
+  av_packet_free(&packet);
+  avcodec_free_context(&codecContext);
+  return !cancel;
+}
+
+void TimestampTable::addPixelFrame(const AVFrame *frame, std::vector<uint8_t> &strip)
+{
+  const int64_t pts = frame->pts != AV_NOPTS_VALUE ? frame->pts : frame->pkt_dts;
+  const uint64_t timestamp100ns = readFrameTimestamp(frame, strip);
+  if (pts != AV_NOPTS_VALUE && timestamp100ns != 0)
+  {
+    framePts.push_back(pts);
+    frameTsMicro.push_back((5 + timestamp100ns) / 10);
+  }
+}
+
+bool TimestampTable::buildFromRange(const TimestampPlan &plan,
+                                    const std::atomic<bool> &cancel,
+                                    std::atomic<int64_t> &progress)
+{
+  RangePlan range;
+  range.videoFile = plan.videoFile;
+  range.streamIndex = plan.streamIndex;
+  range.index = plan.index;
+  range.ptsOffset = plan.ptsOffset;
+  range.skipLoopFilter = true;
+  const int workers = std::max(plan.decodeWorkers, 1);
+  RangeDecoder decoder;
+  if (!decoder.start(std::move(range), 1, plan.index.size(), workers,
+                     workers * range_queue_frames_per_worker))
+  {
+    return false;
+  }
+  std::vector<uint8_t> strip;
+  RangeFrame decoded;
+  while (!cancel && decoder.next(decoded))
+  {
+    addPixelFrame(decoded.frame.get(), strip);
+    progress++;
+  }
+  const bool ok = !cancel && !decoder.failed();
+  decoder.stop();
+  return ok;
+}
+
+bool TimestampTable::build(const TimestampPlan &plan, const std::atomic<bool> &cancel,
+                           std::atomic<int64_t> &progress)
+{
+  framePts.clear();
+  frameTsMicro.clear();
+
+  bool ok = false;
+  if (plan.firstUtcUs == 0 && !plan.index.empty())
+  {
+    ok = buildFromRange(plan, cancel, progress);
+    if (!ok && !cancel)
+    {
+      std::cerr << "Parallel timestamp pass failed for " << plan.videoFile
+                << "; decoding sequentially" << std::endl;
+      framePts.clear();
+      frameTsMicro.clear();
+      progress = 0;
+    }
+  }
+
+  if (!ok && !cancel)
+  {
+    AVFormatContext *formatContext = nullptr;
+    if (avformat_open_input(&formatContext, plan.videoFile.c_str(), nullptr, nullptr) != 0)
+    {
+      std::cerr << "Timestamp pass couldn't open " << plan.videoFile << std::endl;
+      return false;
+    }
+    ok = avformat_find_stream_info(formatContext, nullptr) >= 0 &&
+         plan.streamIndex >= 0 && plan.streamIndex < (int)formatContext->nb_streams;
+    if (ok)
+    {
+      ok = plan.firstUtcUs != 0
+               ? buildFromPackets(plan, formatContext, cancel, progress)
+               : buildFromPixels(plan, formatContext, cancel, progress);
+    }
+    avformat_close_input(&formatContext);
+  }
+  if (!ok)
+  {
+    framePts.clear();
+    frameTsMicro.clear();
+    return false;
+  }
+
+  // Packets arrive in decode order; keep one entry per pts in pts order.
+  std::vector<size_t> order(framePts.size());
+  for (size_t i = 0; i < order.size(); i++)
+  {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t a, size_t b)
+                   { return framePts[a] < framePts[b]; });
+  std::vector<int64_t> sortedPts;
+  std::vector<uint64_t> sortedTsMicro;
+  sortedPts.reserve(order.size());
+  sortedTsMicro.reserve(order.size());
+  for (size_t i : order)
+  {
+    // Times must rise for the search; drop duplicates and glitched reads.
+    if (!sortedPts.empty() &&
+        (framePts[i] == sortedPts.back() || frameTsMicro[i] <= sortedTsMicro.back()))
+    {
+      continue;
+    }
+    sortedPts.push_back(framePts[i]);
+    sortedTsMicro.push_back(frameTsMicro[i]);
+  }
+  framePts = std::move(sortedPts);
+  frameTsMicro = std::move(sortedTsMicro);
+  return framePts.size() >= 2;
+}
+
+bool TimestampTable::findBounds(uint64_t tsMicro, TimestampBounds &bounds) const
+{
+  auto it = std::upper_bound(frameTsMicro.begin(), frameTsMicro.end(), tsMicro);
+  if (it == frameTsMicro.begin() || it == frameTsMicro.end())
+  {
+    return false;
+  }
+  const size_t b = it - frameTsMicro.begin();
+  bounds.ptsA = framePts[b - 1];
+  bounds.tsMicroA = frameTsMicro[b - 1];
+  bounds.ptsB = framePts[b];
+  bounds.tsMicroB = frameTsMicro[b];
+  return true;
+}
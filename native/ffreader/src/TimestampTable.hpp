@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "VideoIndex.hpp"
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief What the timestamp pass reads, resolved on the caller's thread so
+ * the pass never touches the reader.
+ */
+struct TimestampPlan
+{
+  std::string videoFile;
+  int streamIndex = -1;
+  /** Container UTC anchor; 0 when the times are encoded in the pixels. */
+  uint64_t firstUtcUs = 0;
+  /**
+   * Frame index for the pixel pass; when present the file is decoded by a
+   * RangeDecoder with decodeWorkers threads instead of one decoder.
+   */
+  VideoIndex index;
+  /** Decoded pts minus index timestamp, see FFVideoReader::getIndexOffset(). */
+  int64_t ptsOffset = 0;
+  int decodeWorkers = 1;
+};
+
+/** Two adjacent table entries around a requested time. */
+struct TimestampBounds
+{
+  int64_t ptsA = 0;
+  uint64_t tsMicroA = 0;
+  int64_t ptsB = 0;
+  uint64_t tsMicroB = 0;
+};
+
+/**
+ * @class TimestampTable
+ * @brief UTC time of every frame of a file, keyed by presentation timestamp.
+ *
+ * Built once in the background so that finding the frames around a UTC time
+ * is a binary search instead of a series of seeks and decodes. Entries are
+ * in pts order, the domain the reader numbers frames in, so the caller maps
+ * a found pts to its frame number.
+ *
+ * With a container UTC anchor the pass only demuxes packets. Otherwise it
+ * decodes every frame, split across threads by GOP when a frame index is
+ * available, and reads the bit pattern in the first rows straight from the
+ * luma plane; frames without a readable pattern are left out.
+ */
+class TimestampTable
+{
+public:
+  /**
+   * @brief Reads the time of every frame of @p plan.
+   *
+   * Meant for a background thread; opens its own demuxers and decoders.
+   *
+   * @param cancel Checked between packets.
+   * @param progress Incremented as each frame is done.
+   * @return true if at least two frames have a time.
+   */
+  bool build(const TimestampPlan &plan, const std::atomic<bool> &cancel,
+             std::atomic<int64_t> &progress);
+
+  /**
+   * @brief Finds the adjacent frames A and B with
+   * A.tsMicro <= @p tsMicro < B.tsMicro.
+   *
+   * @return false if @p tsMicro is outside the table.
+   */
+  bool findBounds(uint64_t tsMicro, TimestampBounds &bounds) const;
+
+  /** Number of frames with a time. */
+  size_t size() const { return framePts.size(); }
+
+private:
+  /** Container anchor pass: packet timestamps only, no decoding. */
+  bool buildFromPackets(const TimestampPlan &plan, AVFormatContext *formatContext,
+                        const std::atomic<bool> &cancel, std::atomic<int64_t> &progress);
+
+  /** Pixel pass: decodes each frame and reads its encoded time. */
+  bool buildFromPixels(const TimestampPlan &plan, AVFormatContext *formatContext,
+                       const std::atomic<bool> &cancel, std::atomic<int64_t> &progress);
+
+  /** Pixel pass over the frame index, decoding GOPs on several threads. */
+  bool buildFromRange(const TimestampPlan &plan, const std::atomic<bool> &cancel,
+                      std::atomic<int64_t> &progress);
+
+  /** Adds the encoded time of one decoded frame, if it has one. */
+  void addPixelFrame(const AVFrame *frame, std::vector<uint8_t> &strip);
+
+  std::vector<int64_t> framePts;
+  std::vector<uint64_t> frameTsMicro;
+};
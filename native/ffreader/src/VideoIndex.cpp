@@ -0,0 +1,265 @@
+#include "VideoIndex.hpp"
+
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#include <algorithm>
+#include <iostream>
+
+void VideoIndex::clear()
+{
+  framePts.clear();
+  framePts.shrink_to_fit();
+  keyframes.clear();
+  keyframes.shrink_to_fit();
+  fromContainer = false;
+}
+
+int64_t VideoIndex::frameAtOrBefore(int64_t ts) const
+{
+  auto it = std::upper_bound(framePts.begin(), framePts.end(), ts);
+  return (int64_t)(it - framePts.begin()) - 1;
+}
+
+int64_t VideoIndex::nearestFrame(int64_t ts) const
+{
+  if (framePts.empty())
+  {
+    return -1;
+  }
+  auto it = std::lower_bound(framePts.begin(), framePts.end(), ts);
+  if (it == framePts.end())
+  {
+    return size() - 1;
+  }
+  if (it != framePts.begin() && ts - *(it - 1) < *it - ts)
+  {
+    --it;
+  }
+  return (int64_t)(it - framePts.begin());
+}
+
+int64_t VideoIndex::keyframeAtOrBefore(int64_t ts) const
+{
+  const int64_t frame = frameAtOrBefore(ts);
+  return frame < 0 ? -1 : keyframeForFrame(frame);
+}
+
+int64_t VideoIndex::keyframeForFrame(int64_t frame) const
+{
+  if (framePts.empty() || frame < 0)
+  {
+    return -1;
+  }
+  frame = std::min(frame, size() - 1);
+  auto it = std::upper_bound(keyframes.begin(), keyframes.end(), (int32_t)frame);
+  if (it == keyframes.begin())
+  {
+    return -1;
+  }
+  return *(it - 1);
+}
+
+void VideoIndex::assign(std::vector<std::pair<int64_t, bool>> &entries)
+{
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const auto &a, const auto &b)
+                   { return a.first < b.first; });
+
+  framePts.clear();
+  keyframes.clear();
+  framePts.reserve(entries.size());
+  for (const auto &entry : entries)
+  {
+    if (!framePts.empty() && framePts.back() == entry.first)
+    {
+      // Duplicate timestamps cannot be told apart by a seek; keep the first.
+      continue;
+    }
+    if (entry.second)
+    {
+      keyframes.push_back((int32_t)framePts.size());
+    }
+    framePts.push_back(entry.first);
+  }
+}
+
+bool VideoIndex::buildFromContainer(AVStream *stream)
+{
+  const int count = avformat_index_get_entries_count(stream);
+  if (count <= 0)
+  {
+    return false;
+  }
+
+  std::vector<std::pair<int64_t, bool>> entries;
+  entries.reserve(count);
+  bool sawNonKey = false;
+  for (int i = 0; i < count; i++)
+  {
+    const AVIndexEntry *entry = avformat_index_get_entry(stream, i);
+    if (!entry || (entry->flags & AVINDEX_DISCARD_FRAME))
+    {
+      continue;
+    }
+    const bool key = (entry->flags & AVINDEX_KEYFRAME) != 0;
+    sawNonKey = sawNonKey || !key;
+    entries.emplace_back(entry->timestamp, key);
+  }
+
+  // Some demuxers (e.g. matroska cues) only index keyframes. That is enough
+  // to seek but not to number frames, so treat it as a partial index.
+  const bool complete =
+      sawNonKey || (stream->nb_frames > 0 && (int64_t)entries.size() >= stream->nb_frames);
+  if (!complete)
+  {
+    return false;
+  }
+
+  // Entries carry decode timestamps. With B-frames a frame is presented
+  // later than it is decoded, but at a constant frame rate the presented
+  // timestamps, in order, are the decode timestamps shifted by the
+  // composition offset, which the reader measures on the first decoded
+  // frame. Closed GOPs present each keyframe after every frame decoded
+  // before it, so keyframe positions carry over too. Streams that reorder
+  // at a variable rate are scanned for packet pts instead.
+  if (stream->codecpar->video_delay > 0)
+  {
+    for (size_t i = 2; i < entries.size(); i++)
+    {
+      if (entries[i].first - entries[i - 1].first != entries[1].first - entries[0].first)
+      {
+        return false;
+      }
+    }
+  }
+
+  assign(entries);
+  fromContainer = true;
+  return !empty();
+}
+
+bool VideoIndex::buildFromPackets(AVFormatContext *formatContext, int streamIndex)
+{
+  AVPacket *packet = av_packet_alloc();
+  if (!packet)
+  {
+    return false;
+  }
+
+  std::vector<std::pair<int64_t, bool>> entries;
+  if (formatContext->streams[streamIndex]->nb_frames > 0)
+  {
+    entries.reserve(formatContext->streams[streamIndex]->nb_frames);
+  }
+  int ret;
+  while ((ret = av_read_frame(formatContext, packet)) >= 0 || ret == AVERROR(EAGAIN))
+  {
+    if (ret >= 0 && packet->stream_index == streamIndex)
+    {
+      const int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+      if (ts != AV_NOPTS_VALUE)
+      {
+        entries.emplace_back(ts, (packet->flags & AV_PKT_FLAG_KEY) != 0);
+      }
+    }
+    av_packet_unref(packet);
+  }
+  av_packet_free(&packet);
+
+  // Rewind so the reader starts decoding from the first frame again.
+  AVStream *stream = formatContext->streams[streamIndex];
+  const int64_t start =
+      stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+  if (avformat_seek_file(formatContext, streamIndex, INT64_MIN, start, start, 0) < 0 &&
+      av_seek_frame(formatContext, streamIndex, 0, AVSEEK_FLAG_BYTE) < 0)
+  {
+    std::cerr << "Unable to rewind after frame index scan" << std::endl;
+    return false;
+  }
+
+  assign(entries);
+  fromContainer = false;
+  return !empty();
+}
+
+int64_t VideoIndex::extend(AVFormatContext *formatContext, int streamIndex)
+{
+  if (empty() || !formatContext || streamIndex < 0)
+  {
+    return 0;
+  }
+  // Seeking also clears the EOF state left by earlier reads.
+  if (av_seek_frame(formatContext, streamIndex, framePts[keyframes.back()],
+                    AVSEEK_FLAG_BACKWARD) < 0)
+  {
+    return 0;
+  }
+  AVPacket *packet = av_packet_alloc();
+  if (!packet)
+  {
+    return 0;
+  }
+
+  const int64_t last = framePts.back();
+  std::vector<std::pair<int64_t, bool>> entries;
+  int ret;
+  while ((ret = av_read_frame(formatContext, packet)) >= 0 || ret == AVERROR(EAGAIN))
+  {
+    if (ret >= 0 && packet->stream_index == streamIndex)
+    {
+      // Match the domain of the existing entries: container index entries
+      // are decode timestamps (only used where they follow presentation
+      // order up to a constant offset), scanned ones presentation
+      // timestamps.
+      const int64_t preferred = fromContainer ? packet->dts : packet->pts;
+      const int64_t ts = preferred != AV_NOPTS_VALUE ? preferred
+                         : fromContainer             ? packet->pts
+                                                     : packet->dts;
+      if (ts != AV_NOPTS_VALUE && ts > last)
+      {
+        entries.emplace_back(ts, (packet->flags & AV_PKT_FLAG_KEY) != 0);
+      }
+    }
+    av_packet_unref(packet);
+  }
+  av_packet_free(&packet);
+
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const auto &a, const auto &b)
+                   { return a.first < b.first; });
+  const int64_t before = size();
+  for (const auto &entry : entries)
+  {
+    if (entry.first == framePts.back())
+    {
+      continue;
+    }
+    if (entry.second)
+    {
+      keyframes.push_back((int32_t)framePts.size());
+    }
+    framePts.push_back(entry.first);
+  }
+  return size() - before;
+}
+
+bool VideoIndex::build(AVFormatContext *formatContext, int streamIndex)
+{
+  clear();
+  if (!formatContext || streamIndex < 0)
+  {
+    return false;
+  }
+
+  if (buildFromContainer(formatContext->streams[streamIndex]))
+  {
+    return true;
+  }
+
+  clear();
+  return buildFromPackets(formatContext, streamIndex);
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+extern "C"
+{
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @class VideoIndex
+ * @brief Per-file table of frame timestamps and keyframe positions.
+ *
+ * Entries are kept in ascending presentation order so position n is the
+ * n-th presented frame, and keyframe positions are in the same order.
+ * Timestamps are in the stream time_base; a backward av_seek_frame() to a
+ * keyframe's timestamp lands on that keyframe, or for reordered streams at
+ * worst on an earlier one.
+ *
+ * The table is built from the demuxer's own index entries when the container
+ * provides a complete sample table (mp4/mov). Those are decode timestamps,
+ * which are in presentation order up to a constant composition offset when
+ * the stream has no frame reordering or has it at a constant frame rate;
+ * FFVideoReader measures the offset on the first decoded frame. Otherwise
+ * the table comes from a packet-only scan of the file (no decoding) using
+ * each packet's presentation timestamp.
+ */
+class VideoIndex
+{
+public:
+  /** Timestamp of every frame, ascending. */
+  std::vector<int64_t> framePts;
+
+  /** Positions into framePts of every keyframe, ascending. */
+  std::vector<int32_t> keyframes;
+
+  /** True when the table came from the container index rather than a scan. */
+  bool fromContainer = false;
+
+  /** Releases the table. */
+  void clear();
+
+  /** True when no table is available. */
+  bool empty() const { return framePts.empty() || keyframes.empty(); }
+
+  /** Number of frames in the table. */
+  int64_t size() const { return (int64_t)framePts.size(); }
+
+  /**
+   * @brief Finds the last frame whose timestamp is at or before @p ts.
+   * @return The frame position, or -1 if @p ts precedes the first frame.
+   */
+  int64_t frameAtOrBefore(int64_t ts) const;
+
+  /**
+   * @brief Finds the frame whose timestamp is closest to @p ts.
+   * @return The frame position, or -1 for an empty table.
+   */
+  int64_t nearestFrame(int64_t ts) const;
+
+  /**
+   * @brief Finds the last keyframe whose timestamp is at or before @p ts.
+   * @return The frame position of the keyframe, or -1 if none precedes @p ts.
+   */
+  int64_t keyframeAtOrBefore(int64_t ts) const;
+
+  /**
+   * @brief Finds the keyframe that starts the GOP of frame position @p frame,
+   * clamped to the table.
+   * @return The frame position of the keyframe, or -1 if none precedes it.
+   */
+  int64_t keyframeForFrame(int64_t frame) const;
+
+  /**
+   * @brief Builds the table for a video stream.
+   *
+   * Uses the container index when it describes every frame, otherwise scans
+   * packets from the start of the file and rewinds the demuxer afterwards.
+   *
+   * @param formatContext An opened format context.
+   * @param streamIndex The video stream to index.
+   * @return true if a usable table was built.
+   */
+  bool build(AVFormatContext *formatContext, int streamIndex);
+
+  /**
+   * @brief Appends frames demuxed after the end of the table.
+   *
+   * For files that are still being written. Reads packets from the last
+   * keyframe to the current end of the file, without decoding, and keeps
+   * those later than the last indexed frame. The demuxer is left at EOF.
+   *
+   * @return The number of frames added.
+   */
+  int64_t extend(AVFormatContext *formatContext, int streamIndex);
+
+private:
+  /** Sorts (timestamp, keyframe) pairs into framePts/keyframes. */
+  void assign(std::vector<std::pair<int64_t, bool>> &entries);
+
+  /**
+   * Builds from avformat_index_get_entry(); false if the index is partial,
+   * or if the stream reorders frames and its decode timestamps are not
+   * evenly spaced, as the entries are decode timestamps.
+   */
+  bool buildFromContainer(AVStream *stream);
+
+  /** Builds by reading every packet of the stream without decoding. */
+  bool buildFromPackets(AVFormatContext *formatContext, int streamIndex);
+};
@@ -0,0 +1,142 @@
+#include "VideoIndexCache.hpp"
+#include "MappedFile.hpp"
+
+#include <climits>
+#include <cstring>
+#include <type_traits>
+
+// Bump whenever CacheHeader or the payload layout changes; older caches are
+// then ignored and rebuilt.
+constexpr static uint32_t cache_version = 2;
+constexpr static char cache_magic[8] = {'C', 'T', 'V', 'I', 'D', 'X', 0, 0};
+
+/**
+ * On-disk layout: CacheHeader, then frameCount int64 timestamps, then
+ * keyframeCount int32 frame positions. Native (little) endian.
+ */
+struct CacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t headerSize;
+  uint64_t videoSize;
+  int64_t videoMtime;
+  int32_t timeBaseNum;
+  int32_t timeBaseDen;
+  uint32_t fromContainer;
+  uint32_t reserved;
+  uint64_t frameCount;
+  uint64_t keyframeCount;
+  VideoIndexSummary summary;
+};
+static_assert(std::is_trivially_copyable<CacheHeader>::value,
+              "CacheHeader is written with a raw copy");
+
+std::string videoIndexCachePath(const std::string &videoFile)
+{
+  return siblingPath(videoFile, ".ctidx");
+}
+
+bool loadVideoIndexCache(const std::string &videoFile, AVRational timeBase,
+                         VideoIndex &index, VideoIndexSummary &summary)
+{
+  uint64_t videoSize;
+  int64_t videoMtime;
+  if (!getFileStamp(videoFile, videoSize, videoMtime))
+  {
+    return false;
+  }
+
+  MappedFile mapped;
+  if (!mapped.open(videoIndexCachePath(videoFile)) ||
+      mapped.size() < sizeof(CacheHeader))
+  {
+    return false;
+  }
+
+  CacheHeader header;
+  memcpy(&header, mapped.data(), sizeof(header));
+  if (memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 ||
+      header.version != cache_version || header.headerSize != sizeof(CacheHeader) ||
+      header.videoSize != videoSize || header.videoMtime != videoMtime ||
+      header.timeBaseNum != timeBase.num || header.timeBaseDen != timeBase.den ||
+      header.frameCount == 0 || header.keyframeCount == 0 ||
+      header.keyframeCount > header.frameCount)
+  {
+    return false;
+  }
+
+  // Bound the counts by the payload before multiplying, so a corrupt header
+  // cannot overflow past the size check. Positions are int32 on disk.
+  const uint64_t payloadBytes = mapped.size() - sizeof(CacheHeader);
+  if (header.frameCount > payloadBytes / sizeof(int64_t) ||
+      header.frameCount > (uint64_t)INT32_MAX)
+  {
+    return false;
+  }
+  const uint64_t ptsBytes = header.frameCount * sizeof(int64_t);
+  if (header.keyframeCount > (payloadBytes - ptsBytes) / sizeof(int32_t))
+  {
+    return false;
+  }
+  const uint64_t keyframeBytes = header.keyframeCount * sizeof(int32_t);
+
+  const uint8_t *payload = mapped.data() + sizeof(CacheHeader);
+  VideoIndex loaded;
+  loaded.framePts.resize(header.frameCount);
+  memcpy(loaded.framePts.data(), payload, ptsBytes);
+  loaded.keyframes.resize(header.keyframeCount);
+  memcpy(loaded.keyframes.data(), payload + ptsBytes, keyframeBytes);
+
+  // The readers index framePts with these without further checks.
+  for (size_t i = 1; i < loaded.framePts.size(); i++)
+  {
+    if (loaded.framePts[i] <= loaded.framePts[i - 1])
+    {
+      return false;
+    }
+  }
+  for (size_t i = 0; i < loaded.keyframes.size(); i++)
+  {
+    if (loaded.keyframes[i] < 0 || (uint64_t)loaded.keyframes[i] >= header.frameCount ||
+        (i > 0 && loaded.keyframes[i] <= loaded.keyframes[i - 1]))
+    {
+      return false;
+    }
+  }
+
+  loaded.fromContainer = header.fromContainer != 0;
+  index = std::move(loaded);
+  summary = header.summary;
+  return true;
+}
+
+bool saveVideoIndexCache(const std::string &videoFile, AVRational timeBase,
+                         const VideoIndex &index, const VideoIndexSummary &summary)
+{
+  if (index.empty())
+  {
+    return false;
+  }
+
+  CacheHeader header{};
+  memcpy(header.magic, cache_magic, sizeof(cache_magic));
+  header.version = cache_version;
+  header.headerSize = sizeof(CacheHeader);
+  if (!getFileStamp(videoFile, header.videoSize, header.videoMtime))
+  {
+    return false;
+  }
+  header.timeBaseNum = timeBase.num;
+  header.timeBaseDen = timeBase.den;
+  header.fromContainer = index.fromContainer ? 1 : 0;
+  header.frameCount = index.framePts.size();
+  header.keyframeCount = index.keyframes.size();
+  header.summary = summary;
+
+  return writeFileAtomically(
+      videoIndexCachePath(videoFile),
+      {{&header, sizeof(header)},
+       {index.framePts.data(), index.framePts.size() * sizeof(int64_t)},
+       {index.keyframes.data(), index.keyframes.size() * sizeof(int32_t)}});
+}
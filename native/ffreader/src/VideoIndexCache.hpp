@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "VideoIndex.hpp"
+
+/**
+ * @brief File-level facts stored next to the frame index in the cache.
+ *
+ * These are what the openFile op otherwise has to recover by decoding the
+ * first frame and probing backward for the last readable one.
+ */
+struct VideoIndexSummary
+{
+  int64_t numFrames = 0;                 ///< Last readable frame number (1-based).
+  uint64_t firstFrameTimestampMilli = 0; ///< UTC ms of the first frame.
+  uint64_t lastFrameTimestampMilli = 0;  ///< UTC ms of the last readable frame.
+  uint64_t firstTsMicro = 0;             ///< UTC us of the first frame.
+  uint64_t lastTsMicro = 0;              ///< UTC us of the last readable frame.
+  uint64_t firstUtcUs = 0;               ///< Container UTC anchor (0 when the anchor comes from pixels).
+};
+
+/**
+ * @brief Path of the index cache for a video: the video path with its suffix
+ * replaced by `.ctidx`, alongside the `.json` sidecar.
+ */
+std::string videoIndexCachePath(const std::string &videoFile);
+
+/**
+ * @brief Loads a cached index for @p videoFile.
+ *
+ * The cache file is memory-mapped and only accepted when its format version,
+ * the video's size and mtime, and the stream time base all match.
+ *
+ * @param videoFile The video the cache belongs to.
+ * @param timeBase The time base of the video stream the index must be in.
+ * @param index Receives the frame index.
+ * @param summary Receives the stored file summary.
+ * @return true if a valid cache was loaded.
+ */
+bool loadVideoIndexCache(const std::string &videoFile, AVRational timeBase,
+                         VideoIndex &index, VideoIndexSummary &summary);
+
+/**
+ * @brief Writes the index cache for @p videoFile.
+ *
+ * Written to a temporary file and renamed into place so a concurrent reader
+ * never maps a partial file. Failure (e.g. read-only media) is not an error
+ * for callers; the index is simply rebuilt next time.
+ *
+ * @return true if the cache was written.
+ */
+bool saveVideoIndexCache(const std::string &videoFile, AVRational timeBase,
+                         const VideoIndex &index, const VideoIndexSummary &summary);
@@ -0,0 +1,78 @@
+#include "VideoTimeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void VideoTimeline::setSegments(std::vector<TimelineSegment> segments)
+{
+  parts = std::move(segments);
+  renumber();
+}
+
+void VideoTimeline::setSegmentFrames(size_t segment, int64_t numFrames)
+{
+  if (segment < parts.size() && parts[segment].numFrames != numFrames)
+  {
+    parts[segment].numFrames = numFrames;
+    renumber();
+  }
+}
+
+void VideoTimeline::renumber()
+{
+  int64_t next = 1;
+  for (auto &part : parts)
+  {
+    part.firstFrame = next;
+    next += std::max<int64_t>(0, part.numFrames);
+  }
+}
+
+int64_t VideoTimeline::numFrames() const
+{
+  return parts.empty() ? 0 : parts.back().firstFrame + parts.back().numFrames - 1;
+}
+
+bool VideoTimeline::locateFrame(double frameNum, size_t &segment, double &localFrame) const
+{
+  const int64_t total = numFrames();
+  if (total < 1)
+  {
+    return false;
+  }
+  frameNum = std::min(std::max(frameNum, 1.0), (double)total);
+  const int64_t whole = (int64_t)std::floor(frameNum);
+  auto it = std::upper_bound(parts.begin(), parts.end(), whole,
+                             [](int64_t frame, const TimelineSegment &part)
+                             { return frame < part.firstFrame; });
+  segment = (size_t)(it - parts.begin()) - 1;
+  const auto &part = parts[segment];
+  localFrame = frameNum - (double)(part.firstFrame - 1);
+  if (whole - part.firstFrame + 1 >= part.numFrames)
+  {
+    localFrame = (double)part.numFrames;
+  }
+  return true;
+}
+
+bool VideoTimeline::locateTime(uint64_t tsMilli, size_t &segment, double &localFrame) const
+{
+  if (parts.empty() || tsMilli < parts.front().firstTimestampMilli ||
+      tsMilli > parts.back().lastTimestampMilli)
+  {
+    return false;
+  }
+  auto it = std::upper_bound(parts.begin(), parts.end(), tsMilli,
+                             [](uint64_t ts, const TimelineSegment &part)
+                             { return ts < part.firstTimestampMilli; });
+  segment = (size_t)(it - parts.begin()) - 1;
+  const auto &part = parts[segment];
+  localFrame = 1;
+  if (part.numFrames > 1 && part.lastTimestampMilli > part.firstTimestampMilli)
+  {
+    const double at = std::min(1.0, (double)(tsMilli - part.firstTimestampMilli) /
+                                        (part.lastTimestampMilli - part.firstTimestampMilli));
+    localFrame = 1 + std::round(at * (part.numFrames - 1));
+  }
+  return true;
+}
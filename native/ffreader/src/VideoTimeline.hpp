@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** One segment file of a VideoTimeline. */
+struct TimelineSegment
+{
+  std::string file;
+  int64_t firstFrame = 1; ///< Timeline frame number of the segment's frame 1.
+  int64_t numFrames = 0;
+  uint64_t firstTsMicro = 0;
+  uint64_t lastTsMicro = 0;
+  uint64_t firstTimestampMilli = 0;
+  uint64_t lastTimestampMilli = 0;
+};
+
+/**
+ * @class VideoTimeline
+ * @brief Joins consecutive segment files into one frame and UTC space.
+ *
+ * Timeline frame numbers are 1 to N across all segments in order: frame 1
+ * of segment k is timeline frame 1 + the frames of segments 0..k-1. Only
+ * the mapping lives here; opening the segments' readers is up to the caller.
+ */
+class VideoTimeline
+{
+public:
+  /** Replaces the segments, in playback order, and numbers their frames. */
+  void setSegments(std::vector<TimelineSegment> segments);
+
+  /**
+   * @brief Corrects the frame count of one segment, e.g. once its reader
+   * reports the exact extent, and renumbers the segments after it.
+   */
+  void setSegmentFrames(size_t segment, int64_t numFrames);
+
+  /**
+   * @brief Maps a timeline frame number to a segment.
+   *
+   * Fractions are kept, except that a fraction past a segment's last frame is
+   * dropped: interpolating across two files is not supported.
+   *
+   * @param frameNum Timeline frame, clamped to 1 to N.
+   * @param segment Receives the segment index.
+   * @param localFrame Receives the 1 to N frame within the segment.
+   * @return false for an empty timeline.
+   */
+  bool locateFrame(double frameNum, size_t &segment, double &localFrame) const;
+
+  /**
+   * @brief Finds the segment that covers @p tsMilli, or the last one that
+   * starts before it when @p tsMilli falls in a gap between recordings.
+   *
+   * @param segment Receives the segment index.
+   * @param localFrame Receives an estimate of the 1 to N frame within the
+   *                   segment, taking its frames as evenly spaced; a time in
+   *                   a gap maps to the segment's last frame.
+   * @return false if @p tsMilli is outside the timeline.
+   */
+  bool locateTime(uint64_t tsMilli, size_t &segment, double &localFrame) const;
+
+  const std::vector<TimelineSegment> &segments() const { return parts; }
+
+  /** Frames across all segments. */
+  int64_t numFrames() const;
+
+private:
+  /** Recomputes firstFrame from the segment frame counts. */
+  void renumber();
+
+  std::vector<TimelineSegment> parts;
+};
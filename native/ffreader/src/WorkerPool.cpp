@@ -0,0 +1,136 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace
+{
+/** The pool whose worker runs on this thread, if any. */
+thread_local const WorkerPool *workerOf = nullptr;
+
+/** Shared progress of one parallelFor() call. */
+struct Batch
+{
+  std::function<void(int)> task;
+  int count = 0;
+  std::atomic<int> next{0};
+  std::mutex doneMutex;
+  std::condition_variable doneSignal;
+  int done = 0;
+
+  /** Claims and runs indices until none are left. */
+  void drain()
+  {
+    int finished = 0;
+    for (int i = next++; i < count; i = next++)
+    {
+      task(i);
+      finished++;
+    }
+    if (finished > 0)
+    {
+      std::lock_guard<std::mutex> lock(doneMutex);
+      done += finished;
+      if (done == count)
+      {
+        doneSignal.notify_all();
+      }
+    }
+  }
+};
+} // namespace
+
+WorkerPool::WorkerPool(size_t threads)
+{
+  for (size_t i = 0; i < threads; i++)
+  {
+    workers.emplace_back(&WorkerPool::workerLoop, this);
+  }
+}
+
+WorkerPool::~WorkerPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    stopping = true;
+  }
+  queueSignal.notify_all();
+  for (auto &worker : workers)
+  {
+    worker.join();
+  }
+}
+
+WorkerPool &WorkerPool::shared()
+{
+  // Never destroyed: joining threads from static destructors can hang when
+  // the addon is unloaded at process exit.
+  static WorkerPool *pool =
+      new WorkerPool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return *pool;
+}
+
+WorkerPool &WorkerPool::files()
+{
+  static WorkerPool *pool =
+      new WorkerPool(std::max(4u, std::thread::hardware_concurrency()) - 1);
+  return *pool;
+}
+
+void WorkerPool::workerLoop()
+{
+  workerOf = this;
+  for (;;)
+  {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(queueMutex);
+      queueSignal.wait(lock, [this]()
+                       { return stopping || !queue.empty(); });
+      if (stopping && queue.empty())
+      {
+        return;
+      }
+      job = std::move(queue.front());
+      queue.pop_front();
+    }
+    job();
+  }
+}
+
+void WorkerPool::parallelFor(int count, const std::function<void(int)> &task)
+{
+  if (count <= 0)
+  {
+    return;
+  }
+  if (count == 1 || workers.empty() || workerOf == this)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      task(i);
+    }
+    return;
+  }
+
+  auto batch = std::make_shared<Batch>();
+  batch->task = task;
+  batch->count = count;
+
+  const size_t helpers = std::min(workers.size(), (size_t)count - 1);
+  {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    for (size_t i = 0; i < helpers; i++)
+    {
+      queue.emplace_back([batch]()
+                         { batch->drain(); });
+    }
+  }
+  queueSignal.notify_all();
+
+  batch->drain();
+  std::unique_lock<std::mutex> lock(batch->doneMutex);
+  batch->doneSignal.wait(lock, [&batch]()
+                         { return batch->done == batch->count; });
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class WorkerPool
+ * @brief Fixed set of worker threads for splitting work across cores.
+ *
+ * parallelFor() hands out indices to the workers and the calling thread
+ * alike and returns once every index has run, so callers see an ordinary
+ * blocking call. Nested parallelFor() calls from a worker on the same pool
+ * run serially on that worker rather than waiting on the pool; a worker of
+ * one pool may still split work across another.
+ */
+class WorkerPool
+{
+public:
+  /** @param threads Worker threads to start, not counting callers. */
+  explicit WorkerPool(size_t threads);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  /**
+   * @brief Runs @p task(i) for every i in [0, count) and waits for all of them.
+   *
+   * @p task must be safe to call concurrently for different indices.
+   */
+  void parallelFor(int count, const std::function<void(int)> &task);
+
+  /** Threads that can run a parallelFor() at once, including the caller. */
+  size_t concurrency() const { return workers.size() + 1; }
+
+  /**
+   * Pool shared by the frame conversion code, with one worker per
+   * additional core.
+   */
+  static WorkerPool &shared();
+
+  /**
+   * Pool for work split by file, such as probing a batch of files, that
+   * mostly waits on I/O. Kept apart from shared() so it never holds the
+   * conversion workers. Callers bound their lanes through parallelFor()'s
+   * count.
+   */
+  static WorkerPool &files();
+
+private:
+  void workerLoop();
+
+  std::vector<std::thread> workers;
+  std::mutex queueMutex;
+  std::condition_variable queueSignal;
+  std::deque<std::function<void()>> queue;
+  bool stopping = false;
+};
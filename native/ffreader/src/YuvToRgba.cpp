@@ -0,0 +1,438 @@
+#include "YuvToRgba.hpp"
+
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define YUV_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define YUV_TARGET(isa)
+#else
+#define YUV_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define YUV_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+/**
+ * BT.601 coefficients in 6 fractional bits. The luma multiplier has 7 bits
+ * and is halved after multiplying so (Y - 16) * 1.164 stays within 16 bits.
+ */
+struct Coeffs
+{
+  int16_t yOffset;
+  int16_t yMul;
+  int16_t vr;
+  int16_t ug;
+  int16_t vg;
+  int16_t ub;
+};
+
+constexpr Coeffs limitedRange = {16, 149, 102, 25, 52, 129};
+constexpr Coeffs fullRange = {0, 128, 90, 22, 46, 113};
+
+/**
+ * Converts one row. Chroma is subsampled 2:1 horizontally; @p chromaStep is
+ * 1 for planar U and V and 2 for interleaved UV, where vRow == uRow + 1.
+ */
+using RowKernel = void (*)(const uint8_t *yRow, const uint8_t *uRow,
+                           const uint8_t *vRow, int chromaStep, uint8_t *dst,
+                           int width, const Coeffs &c);
+
+inline uint8_t clampPixel(int value)
+{
+  return (uint8_t)std::min(255, std::max(0, value));
+}
+
+/**
+ * Scalar conversion of pixels [begin, end). @p phase is 1 when the row
+ * starts on an odd pixel, so pixel i uses chroma sample (i + phase) / 2.
+ */
+void convertRange(const uint8_t *yRow, const uint8_t *uRow, const uint8_t *vRow,
+                  int chromaStep, uint8_t *dst, int begin, int end, int phase,
+                  const Coeffs &c)
+{
+  for (int i = begin; i < end; i++)
+  {
+    const int chroma = ((i + phase) >> 1) * chromaStep;
+    const int u = uRow[chroma] - 128;
+    const int v = vRow[chroma] - 128;
+    const int yTerm = (std::max(yRow[i] - c.yOffset, 0) * c.yMul) >> 1;
+    uint8_t *out = dst + i * 4;
+    out[0] = clampPixel((yTerm + c.vr * v + 32) >> 6);
+    out[1] = clampPixel((yTerm - (c.ug * u + c.vg * v) + 32) >> 6);
+    out[2] = clampPixel((yTerm + c.ub * u + 32) >> 6);
+    out[3] = 255;
+  }
+}
+
+[[maybe_unused]] void convertRowScalar(const uint8_t *yRow, const uint8_t *uRow,
+                                       const uint8_t *vRow, int chromaStep,
+                                       uint8_t *dst, int width, const Coeffs &c)
+{
+  convertRange(yRow, uRow, vRow, chromaStep, dst, 0, width, 0, c);
+}
+
+#ifdef YUV_X86
+YUV_TARGET("sse4.1")
+void convertRowSSE41(const uint8_t *yRow, const uint8_t *uRow,
+                     const uint8_t *vRow, int chromaStep, uint8_t *dst,
+                     int width, const Coeffs &c)
+{
+  const __m128i yOffset = _mm_set1_epi16(c.yOffset);
+  const __m128i yMul = _mm_set1_epi16(c.yMul);
+  const __m128i vr = _mm_set1_epi16(c.vr);
+  const __m128i ug = _mm_set1_epi16(c.ug);
+  const __m128i vg = _mm_set1_epi16(c.vg);
+  const __m128i ub = _mm_set1_epi16(c.ub);
+  const __m128i bias = _mm_set1_epi16(128);
+  const __m128i round = _mm_set1_epi16(32);
+  const __m128i lowBytes = _mm_set1_epi16(0x00ff);
+  const __m128i alpha = _mm_set1_epi8((char)0xff);
+
+  int i = 0;
+  for (; i + 16 <= width; i += 16)
+  {
+    const __m128i yv = _mm_loadu_si128((const __m128i *)(yRow + i));
+    __m128i yLo = _mm_cvtepu8_epi16(yv);
+    __m128i yHi = _mm_cvtepu8_epi16(_mm_srli_si128(yv, 8));
+    yLo = _mm_srli_epi16(_mm_mullo_epi16(_mm_subs_epu16(yLo, yOffset), yMul), 1);
+    yHi = _mm_srli_epi16(_mm_mullo_epi16(_mm_subs_epu16(yHi, yOffset), yMul), 1);
+
+    __m128i u, v;
+    if (chromaStep == 2)
+    {
+      const __m128i uv = _mm_loadu_si128((const __m128i *)(uRow + i));
+      u = _mm_and_si128(uv, lowBytes);
+      v = _mm_srli_epi16(uv, 8);
+    }
+    else
+    {
+      u = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(uRow + i / 2)));
+      v = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)(vRow + i / 2)));
+    }
+    u = _mm_sub_epi16(u, bias);
+    v = _mm_sub_epi16(v, bias);
+
+    const __m128i rc = _mm_mullo_epi16(v, vr);
+    const __m128i gc = _mm_add_epi16(_mm_mullo_epi16(u, ug), _mm_mullo_epi16(v, vg));
+    const __m128i bc = _mm_mullo_epi16(u, ub);
+
+    // Each chroma term covers two neighbouring pixels.
+    const __m128i rLo = _mm_unpacklo_epi16(rc, rc);
+    const __m128i rHi = _mm_unpackhi_epi16(rc, rc);
+    const __m128i gLo = _mm_unpacklo_epi16(gc, gc);
+    const __m128i gHi = _mm_unpackhi_epi16(gc, gc);
+    const __m128i bLo = _mm_unpacklo_epi16(bc, bc);
+    const __m128i bHi = _mm_unpackhi_epi16(bc, bc);
+
+    const __m128i r = _mm_packus_epi16(
+        _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(yLo, rLo), round), 6),
+        _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(yHi, rHi), round), 6));
+    const __m128i g = _mm_packus_epi16(
+        _mm_srai_epi16(_mm_adds_epi16(_mm_subs_epi16(yLo, gLo), round), 6),
+        _mm_srai_epi16(_mm_adds_epi16(_mm_subs_epi16(yHi, gHi), round), 6));
+    const __m128i b = _mm_packus_epi16(
+        _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(yLo, bLo), round), 6),
+        _mm_srai_epi16(_mm_adds_epi16(_mm_adds_epi16(yHi, bHi), round), 6));
+
+    const __m128i rg0 = _mm_unpacklo_epi8(r, g);
+    const __m128i rg1 = _mm_unpackhi_epi8(r, g);
+    const __m128i ba0 = _mm_unpacklo_epi8(b, alpha);
+    const __m128i ba1 = _mm_unpackhi_epi8(b, alpha);
+    __m128i *out = (__m128i *)(dst + i * 4);
+    _mm_storeu_si128(out, _mm_unpacklo_epi16(rg0, ba0));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(rg0, ba0));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(rg1, ba1));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(rg1, ba1));
+  }
+  convertRange(yRow, uRow, vRow, chromaStep, dst, i, width, 0, c);
+}
+
+YUV_TARGET("avx2")
+void convertRowAVX2(const uint8_t *yRow, const uint8_t *uRow,
+                    const uint8_t *vRow, int chromaStep, uint8_t *dst,
+                    int width, const Coeffs &c)
+{
+  const __m256i yOffset = _mm256_set1_epi16(c.yOffset);
+  const __m256i yMul = _mm256_set1_epi16(c.yMul);
+  const __m256i vr = _mm256_set1_epi16(c.vr);
+  const __m256i ug = _mm256_set1_epi16(c.ug);
+  const __m256i vg = _mm256_set1_epi16(c.vg);
+  const __m256i ub = _mm256_set1_epi16(c.ub);
+  const __m256i bias = _mm256_set1_epi16(128);
+  const __m256i round = _mm256_set1_epi16(32);
+  const __m256i lowBytes = _mm256_set1_epi16(0x00ff);
+  const __m256i alpha = _mm256_set1_epi8((char)0xff);
+
+  int i = 0;
+  for (; i + 32 <= width; i += 32)
+  {
+    const __m256i yv = _mm256_loadu_si256((const __m256i *)(yRow + i));
+    __m256i yLo = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(yv));
+    __m256i yHi = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(yv, 1));
+    yLo = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_subs_epu16(yLo, yOffset), yMul), 1);
+    yHi = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_subs_epu16(yHi, yOffset), yMul), 1);
+
+    __m256i u, v;
+    if (chromaStep == 2)
+    {
+      const __m256i uv = _mm256_loadu_si256((const __m256i *)(uRow + i));
+      u = _mm256_and_si256(uv, lowBytes);
+      v = _mm256_srli_epi16(uv, 8);
+    }
+    else
+    {
+      u = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(uRow + i / 2)));
+      v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(vRow + i / 2)));
+    }
+    u = _mm256_sub_epi16(u, bias);
+    v = _mm256_sub_epi16(v, bias);
+
+    // Reorder the 64-bit quarters so the in-lane unpacks below duplicate
+    // chroma terms 0-7 into yLo's pixels and 8-15 into yHi's.
+    const __m256i rc = _mm256_permute4x64_epi64(_mm256_mullo_epi16(v, vr), 0xD8);
+    const __m256i gc = _mm256_permute4x64_epi64(
+        _mm256_add_epi16(_mm256_mullo_epi16(u, ug), _mm256_mullo_epi16(v, vg)), 0xD8);
+    const __m256i bc = _mm256_permute4x64_epi64(_mm256_mullo_epi16(u, ub), 0xD8);
+
+    const __m256i rLo = _mm256_unpacklo_epi16(rc, rc);
+    const __m256i rHi = _mm256_unpackhi_epi16(rc, rc);
+    const __m256i gLo = _mm256_unpacklo_epi16(gc, gc);
+    const __m256i gHi = _mm256_unpackhi_epi16(gc, gc);
+    const __m256i bLo = _mm256_unpacklo_epi16(bc, bc);
+    const __m256i bHi = _mm256_unpackhi_epi16(bc, bc);
+
+    // packus leaves pixels as [0-7, 16-23 | 8-15, 24-31]; the byte unpacks
+    // below restore order within each lane.
+    const __m256i r = _mm256_packus_epi16(
+        _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(yLo, rLo), round), 6),
+        _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(yHi, rHi), round), 6));
+    const __m256i g = _mm256_packus_epi16(
+        _mm256_srai_epi16(_mm256_adds_epi16(_mm256_subs_epi16(yLo, gLo), round), 6),
+        _mm256_srai_epi16(_mm256_adds_epi16(_mm256_subs_epi16(yHi, gHi), round), 6));
+    const __m256i b = _mm256_packus_epi16(
+        _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(yLo, bLo), round), 6),
+        _mm256_srai_epi16(_mm256_adds_epi16(_mm256_adds_epi16(yHi, bHi), round), 6));
+
+    const __m256i rg0 = _mm256_unpacklo_epi8(r, g); // [0-7 | 8-15]
+    const __m256i rg1 = _mm256_unpackhi_epi8(r, g); // [16-23 | 24-31]
+    const __m256i ba0 = _mm256_unpacklo_epi8(b, alpha);
+    const __m256i ba1 = _mm256_unpackhi_epi8(b, alpha);
+    const __m256i p0 = _mm256_unpacklo_epi16(rg0, ba0); // [0-3 | 8-11]
+    const __m256i p1 = _mm256_unpackhi_epi16(rg0, ba0); // [4-7 | 12-15]
+    const __m256i p2 = _mm256_unpacklo_epi16(rg1, ba1); // [16-19 | 24-27]
+    const __m256i p3 = _mm256_unpackhi_epi16(rg1, ba1); // [20-23 | 28-31]
+    __m256i *out = (__m256i *)(dst + i * 4);
+    _mm256_storeu_si256(out, _mm256_permute2x128_si256(p0, p1, 0x20));
+    _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(p0, p1, 0x31));
+    _mm256_storeu_si256(out + 2, _mm256_permute2x128_si256(p2, p3, 0x20));
+    _mm256_storeu_si256(out + 3, _mm256_permute2x128_si256(p2, p3, 0x31));
+  }
+  convertRange(yRow, uRow, vRow, chromaStep, dst, i, width, 0, c);
+}
+
+bool cpuHasSSE41()
+{
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 1);
+  return (info[2] & (1 << 19)) != 0;
+#else
+  return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+bool cpuHasAVX2()
+{
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+  {
+    return false;
+  }
+  __cpuid(info, 1);
+  const bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) &&
+                          (_xgetbv(0) & 0x6) == 0x6;
+  __cpuidex(info, 7, 0);
+  return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // YUV_X86
+
+#ifdef YUV_NEON
+void convertRowNEON(const uint8_t *yRow, const uint8_t *uRow,
+                    const uint8_t *vRow, int chromaStep, uint8_t *dst,
+                    int width, const Coeffs &c)
+{
+  const uint16x8_t yOffset = vdupq_n_u16(c.yOffset);
+  const uint16x8_t yMul = vdupq_n_u16(c.yMul);
+  const int16x8_t bias = vdupq_n_s16(128);
+
+  int i = 0;
+  for (; i + 16 <= width; i += 16)
+  {
+    const uint8x16_t yv = vld1q_u8(yRow + i);
+    const int16x8_t yLo = vreinterpretq_s16_u16(vshrq_n_u16(
+        vmulq_u16(vqsubq_u16(vmovl_u8(vget_low_u8(yv)), yOffset), yMul), 1));
+    const int16x8_t yHi = vreinterpretq_s16_u16(vshrq_n_u16(
+        vmulq_u16(vqsubq_u16(vmovl_high_u8(yv), yOffset), yMul), 1));
+
+    uint8x8_t u8, v8;
+    if (chromaStep == 2)
+    {
+      const uint8x8x2_t uv = vld2_u8(uRow + i);
+      u8 = uv.val[0];
+      v8 = uv.val[1];
+    }
+    else
+    {
+      u8 = vld1_u8(uRow + i / 2);
+      v8 = vld1_u8(vRow + i / 2);
+    }
+    const int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), bias);
+    const int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), bias);
+
+    const int16x8_t rc = vmulq_n_s16(v, c.vr);
+    const int16x8_t gc = vmlaq_n_s16(vmulq_n_s16(u, c.ug), v, c.vg);
+    const int16x8_t bc = vmulq_n_s16(u, c.ub);
+
+    uint8x16x4_t rgba;
+    rgba.val[0] = vcombine_u8(
+        vqrshrun_n_s16(vqaddq_s16(yLo, vzip1q_s16(rc, rc)), 6),
+        vqrshrun_n_s16(vqaddq_s16(yHi, vzip2q_s16(rc, rc)), 6));
+    rgba.val[1] = vcombine_u8(
+        vqrshrun_n_s16(vqsubq_s16(yLo, vzip1q_s16(gc, gc)), 6),
+        vqrshrun_n_s16(vqsubq_s16(yHi, vzip2q_s16(gc, gc)), 6));
+    rgba.val[2] = vcombine_u8(
+        vqrshrun_n_s16(vqaddq_s16(yLo, vzip1q_s16(bc, bc)), 6),
+        vqrshrun_n_s16(vqaddq_s16(yHi, vzip2q_s16(bc, bc)), 6));
+    rgba.val[3] = vdupq_n_u8(255);
+    vst4q_u8(dst + i * 4, rgba);
+  }
+  convertRange(yRow, uRow, vRow, chromaStep, dst, i, width, 0, c);
+}
+#endif // YUV_NEON
+
+struct Kernel
+{
+  RowKernel row;
+  const char *name;
+};
+
+Kernel selectKernel()
+{
+#ifdef YUV_X86
+  if (cpuHasAVX2())
+  {
+    return {convertRowAVX2, "avx2"};
+  }
+  if (cpuHasSSE41())
+  {
+    return {convertRowSSE41, "sse4.1"};
+  }
+#endif
+#ifdef YUV_NEON
+  return {convertRowNEON, "neon"};
+#else
+  return {convertRowScalar, "scalar"};
+#endif
+}
+
+const Kernel &kernel()
+{
+  static const Kernel selected = selectKernel();
+  return selected;
+}
+
+/** Plane layout of a supported format. */
+struct Layout
+{
+  int chromaStep;   ///< 1 for planar U and V, 2 for interleaved UV.
+  int chromaShiftY; ///< log2 vertical chroma subsampling.
+  bool fullRange;
+};
+
+bool layoutFor(const AVFrame *frame, Layout &layout)
+{
+  switch (frame->format)
+  {
+  case AV_PIX_FMT_YUV420P:
+    layout = {1, 1, false};
+    break;
+  case AV_PIX_FMT_YUVJ420P:
+    layout = {1, 1, true};
+    break;
+  case AV_PIX_FMT_YUV422P:
+    layout = {1, 0, false};
+    break;
+  case AV_PIX_FMT_YUVJ422P:
+    layout = {1, 0, true};
+    break;
+  case AV_PIX_FMT_NV12:
+    layout = {2, 1, false};
+    break;
+  default:
+    return false;
+  }
+  layout.fullRange = layout.fullRange || frame->color_range == AVCOL_RANGE_JPEG;
+  return true;
+}
+} // namespace
+
+bool yuvToRGBASupported(const AVFrame *frame)
+{
+  Layout layout;
+  return frame && layoutFor(frame, layout);
+}
+
+bool yuvToRGBA(const AVFrame *frame, int x, int y, int width, int height,
+               uint8_t *dst, int dstStride)
+{
+  Layout layout;
+  if (!frame || !layoutFor(frame, layout))
+  {
+    return false;
+  }
+  const Coeffs &c = layout.fullRange ? fullRange : limitedRange;
+  const RowKernel row = kernel().row;
+  const int phase = x & 1;
+  for (int r = 0; r < height; r++)
+  {
+    const int srcY = y + r;
+    const int chromaY = srcY >> layout.chromaShiftY;
+    const uint8_t *yRow = frame->data[0] + (ptrdiff_t)srcY * frame->linesize[0] + x;
+    const uint8_t *uRow;
+    const uint8_t *vRow;
+    if (layout.chromaStep == 2)
+    {
+      uRow = frame->data[1] + (ptrdiff_t)chromaY * frame->linesize[1] + (x >> 1) * 2;
+      vRow = uRow + 1;
+    }
+    else
+    {
+      uRow = frame->data[1] + (ptrdiff_t)chromaY * frame->linesize[1] + (x >> 1);
+      vRow = frame->data[2] + (ptrdiff_t)chromaY * frame->linesize[2] + (x >> 1);
+    }
+    uint8_t *out = dst + (ptrdiff_t)r * dstStride;
+    if (phase)
+    {
+      // Odd start: the vector kernels assume pixel pairs share chroma.
+      convertRange(yRow, uRow, vRow, layout.chromaStep, out, 0, width, phase, c);
+    }
+    else
+    {
+      row(yRow, uRow, vRow, layout.chromaStep, out, width, c);
+    }
+  }
+  return true;
+}
+
+const char *yuvToRGBAKernelName() { return kernel().name; }
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+
+extern "C"
+{
+#include <libavutil/frame.h>
+}
+
+/**
+ * @brief True if yuvToRGBA() has a direct kernel for @p frame's pixel format.
+ *
+ * Covered are the 8-bit formats our cameras produce: yuv420p, yuvj420p,
+ * nv12, yuv422p and yuvj422p.
+ */
+bool yuvToRGBASupported(const AVFrame *frame);
+
+/**
+ * @brief Converts a region of @p frame to packed RGBA without scaling.
+ *
+ * Uses BT.601 coefficients, limited or full range according to the frame,
+ * matching what swscale produces by default. The row kernel is picked once
+ * at startup from the CPU: AVX2 or SSE4.1 on x86, NEON on arm64, otherwise
+ * a scalar fallback.
+ *
+ * @param frame Decoded frame; see yuvToRGBASupported().
+ * @param x Left edge of the region. Must lie within the frame.
+ * @param y Top edge of the region. Must lie within the frame.
+ * @param width Region width; x + width must not exceed the frame width.
+ * @param height Region height; y + height must not exceed the frame height.
+ * @param dst Destination for width x height RGBA pixels.
+ * @param dstStride Bytes per destination row.
+ * @return false if the format is not supported.
+ */
+bool yuvToRGBA(const AVFrame *frame, int x, int y, int width, int height,
+               uint8_t *dst, int dstStride);
+
+/** Name of the row kernel selected for this CPU, for logs and benchmarks. */
+const char *yuvToRGBAKernelName();
@@ -2,6 +2,7 @@ import {
   DetectBowMessage,
   GrabFrameMessage,
   nativeVideoExecutor,
+  nativeVideoExecutorAsync,
 } from 'crewtimer_video_reader';
 import { app, ipcMain } from 'electron';
 import path from 'path';
@@ -43,16 +44,75 @@ ipcMain.handle('video:setDebugLevel', (_event, debugLevel: number) => {
   }
 });
 
-ipcMain.handle('video:openFile', (_event, filePath) => {
+ipcMain.handle('video:openFile', async (_event, filePath) => {
   // Invoke native c++ handler
   try {
-    const ret = nativeVideoExecutor({ op: 'openFile', file: filePath });
+    const ret = await nativeVideoExecutorAsync({
+      op: 'openFile',
+      file: filePath,
+      fast: true,
+    });
+    if (ret.status === 'OK') {
+      // Decode ahead while the user steps or plays through the file, and
+      // park extra decoders so flipping between distant frames skips the
+      // seek back to a keyframe.
+      await nativeVideoExecutorAsync({
+        op: 'configureReader',
+        file: filePath,
+        prefetch: true,
+        prefetchMB: 128,
+        cursors: 3,
+      });
+    }
     return ret;
   } catch (err) {
     return { status: `${err instanceof Error ? err.message : err}` };
   }
 });
 
+ipcMain.handle('video:refreshFile', async (_event, filePath: string) => {
+  try {
+    return await nativeVideoExecutorAsync({
+      op: 'refreshFile',
+      file: filePath,
+    });
+  } catch (err) {
+    return { status: `${err instanceof Error ? err.message : err}` };
+  }
+});
+
+ipcMain.handle('video:probeFiles', async (_event, files: string[]) => {
+  try {
+    return await nativeVideoExecutorAsync({ op: 'probeFiles', files });
+  } catch (err) {
+    return { status: `${err instanceof Error ? err.message : err}` };
+  }
+});
+
+ipcMain.handle(
+  'video:openTimeline',
+  async (_event, timeline: string, files: string[]) => {
+    try {
+      return await nativeVideoExecutorAsync({
+        op: 'openTimeline',
+        timeline,
+        files,
+        prefetchMB: 128,
+      });
+    } catch (err) {
+      return { status: `${err instanceof Error ? err.message : err}` };
+    }
+  },
+);
+
+ipcMain.handle('video:closeTimeline', (_event, timeline: string) => {
+  try {
+    return nativeVideoExecutor({ op: 'closeTimeline', timeline });
+  } catch (err) {
+    return { status: `${err instanceof Error ? err.message : err}` };
+  }
+});
+
 ipcMain.handle('video:closeFile', (_event, filePath) => {
   // Invoke native c++ handler
   try {
@@ -73,38 +133,66 @@ const bowdetectModelFile = (fileName: string) =>
     ? path.join(process.resourcesPath, fileName)
     : path.join(__dirname, '../../native/bowdetect', fileName);
 
-ipcMain.handle('video:getFrame', (_event, request: VideoFrameRequest) => {
-  try {
-    // console.log('Grabbing frame', JSON.stringify(request, null, 2));
-    const nativeRequest =
-      request.interpMethod === 'rife'
-        ? { ...request, modelFile: rifeModelFile() }
-        : request;
-    const ret = nativeVideoExecutor({
-      op: 'grabFrameAt',
-      // clean request of undefined keys
-      request: Object.fromEntries(
-        Object.entries(nativeRequest).filter(([_, v]) => v !== undefined),
-      ),
-    } as unknown as GrabFrameMessage);
-    return ret;
-  } catch (err) {
-    return { status: `${err instanceof Error ? err.message : err}` };
-  }
-});
+ipcMain.handle(
+  'video:getFrame',
+  async (_event, request: VideoFrameRequest) => {
+    try {
+      // console.log('Grabbing frame', JSON.stringify(request, null, 2));
+      const nativeRequest =
+        request.interpMethod === 'rife'
+          ? { ...request, modelFile: rifeModelFile() }
+          : request;
+      // Decoded on a worker thread so a slow seek doesn't stall other IPC.
+      const ret = await nativeVideoExecutorAsync({
+        op: 'grabFrameAt',
+        // clean request of undefined keys
+        request: Object.fromEntries(
+          Object.entries(nativeRequest).filter(([_, v]) => v !== undefined),
+        ),
+      } as unknown as GrabFrameMessage);
+      return ret;
+    } catch (err) {
+      return { status: `${err instanceof Error ? err.message : err}` };
+    }
+  },
+);
 
-ipcMain.handle('video:detectBow', (_event, request: BowDetectionRequest) => {
-  try {
-    return nativeVideoExecutor({
-      op: 'detectBowAtFrame',
-      request: {
-        ...request,
-        boatModelFile: bowdetectModelFile('crewtimer-boat-train.onnx'),
-        cardModelFile: bowdetectModelFile('bow_card_detect.onnx'),
-        numberModelFile: bowdetectModelFile('bow_crnn.onnx'),
-      },
-    } as unknown as DetectBowMessage);
-  } catch (err) {
-    return { status: `${err instanceof Error ? err.message : err}` };
-  }
-});
+ipcMain.handle(
+  'video:getFramesAtTime',
+  async (
+    _event,
+    files: string[],
+    tsMilli: number,
+    mode?: 'nearest' | 'bracket',
+  ) => {
+    try {
+      return await nativeVideoExecutorAsync({
+        op: 'grabFramesAtTime',
+        files,
+        tsMilli,
+        mode,
+      });
+    } catch (err) {
+      return { status: `${err instanceof Error ? err.message : err}` };
+    }
+  },
+);
+
+ipcMain.handle(
+  'video:detectBow',
+  async (_event, request: BowDetectionRequest) => {
+    try {
+      return await nativeVideoExecutorAsync({
+        op: 'detectBowAtFrame',
+        request: {
+          ...request,
+          boatModelFile: bowdetectModelFile('crewtimer-boat-train.onnx'),
+          cardModelFile: bowdetectModelFile('bow_card_detect.onnx'),
+          numberModelFile: bowdetectModelFile('bow_crnn.onnx'),
+        },
+      } as unknown as DetectBowMessage);
+    } catch (err) {
+      return { status: `${err instanceof Error ? err.message : err}` };
+    }
+  },
+);
@@ -9,6 +9,10 @@ import {
   BowDetectionRequest,
   BowDetectionResult,
   VideoFrameRequest,
+  VideoProbeResult,
+  VideoRefreshResult,
+  VideoTimeFrame,
+  VideoTimelineResult,
 } from 'renderer/shared/AppTypes';
 
 contextBridge.exposeInMainWorld('VideoUtils', {
@@ -26,6 +30,38 @@ contextBridge.exposeInMainWorld('VideoUtils', {
       throw err;
     }
   },
+  refreshFile: async (filePath: string) => {
+    const result = await ipcRenderer.invoke('video:refreshFile', filePath);
+    if (result.status !== 'OK') {
+      throw new Error(result.status);
+    }
+    return result as VideoRefreshResult;
+  },
+  probeFiles: async (files: string[]) => {
+    const result = await ipcRenderer.invoke('video:probeFiles', files);
+    if (result.status !== 'OK') {
+      throw new Error(result.status);
+    }
+    return result.files as VideoProbeResult[];
+  },
+  openTimeline: async (timeline: string, files: string[]) => {
+    const result = await ipcRenderer.invoke(
+      'video:openTimeline',
+      timeline,
+      files,
+    );
+    if (result.status !== 'OK') {
+      throw new Error(result.status);
+    }
+    return result as VideoTimelineResult;
+  },
+  closeTimeline: async (timeline: string) => {
+    const result = await ipcRenderer.invoke('video:closeTimeline', timeline);
+    if (result.status !== 'OK') {
+      throw new Error(result.status);
+    }
+    return result;
+  },
   closeFile: async (filePath: string) => {
     try {
       const result = await ipcRenderer.invoke('video:closeFile', filePath);
@@ -51,6 +87,22 @@ contextBridge.exposeInMainWorld('VideoUtils', {
       throw err;
     }
   },
+  getFramesAtTime: async (
+    files: string[],
+    tsMilli: number,
+    mode?: 'nearest' | 'bracket',
+  ) => {
+    const result = await ipcRenderer.invoke(
+      'video:getFramesAtTime',
+      files,
+      tsMilli,
+      mode,
+    );
+    if (result.status !== 'OK') {
+      throw new Error(result.status);
+    }
+    return result.frames as VideoTimeFrame[];
+  },
   detectBow: async (request: BowDetectionRequest) => {
     const result = (await ipcRenderer.invoke(
       'video:detectBow',
@@ -16,6 +16,25 @@ export interface AppImage {
   fileEndTime: number;
   motion: { x: number; y: number; dt: number; valid: boolean };
   sidecar?: KeyMap;
+  sourceRect?: Rect; // Region returned when the request had a sourceRect.
+  frameWidth?: number; // Full frame width when sourceRect was requested.
+  frameHeight?: number; // Full frame height when sourceRect was requested.
+  format?: 'rgba' | 'i420' | 'nv12'; // Layout of data; absent means rgba.
+  planes?: { offset: number; stride: number; width: number; height: number }[]; // Planar formats only.
+  colorMatrix?: 'bt601' | 'bt709'; // Planar formats only.
+  colorRange?: 'limited' | 'full'; // Planar formats only.
+  timelineFirstFrame?: number; // Timeline requests: timeline frame of the segment's frame 1.
+  timelineNumFrames?: number; // Timeline requests: frames across all segments.
+}
+
+/**
+ * One file's frame from a synchronized fetch of several files at a UTC time.
+ */
+export interface VideoTimeFrame extends Partial<AppImage> {
+  status: string; // 'OK' or why this file has no frame.
+  file: string;
+  next?: Partial<AppImage>; // Bracket mode: the following frame.
+  fraction?: number; // Bracket mode: position of the time between this frame and next.
 }
 
 export interface Rect {
@@ -51,6 +70,54 @@ export interface BowDetectionResult {
   timestamp: number;
 }
 
+/**
+ * Result of opening a video. The extent is read from the frame index when
+ * available, so callers need not probe for the last frame.
+ */
+export interface VideoOpenResult {
+  status: string;
+  numFrames?: number; // Last readable frame number (1-based).
+  firstTimestamp?: number; // UTC ms of the first frame.
+  lastTimestamp?: number; // UTC ms of the last frame.
+  firstTsMicro?: number; // UTC us of the first frame, 0 if unknown.
+  lastTsMicro?: number; // UTC us of the last frame, 0 if unknown.
+}
+
+/**
+ * Result of re-reading the end of an open file that is still being written.
+ */
+export interface VideoRefreshResult extends VideoOpenResult {
+  grown?: boolean; // True when new frames were found.
+}
+
+/**
+ * Consecutive segment files joined into one frame and UTC space.
+ */
+export interface VideoTimelineResult extends VideoOpenResult {
+  segments?: {
+    file: string;
+    firstFrame: number; // Timeline frame number of the segment's frame 1.
+    numFrames: number;
+    firstTimestamp: number;
+    lastTimestamp: number;
+  }[];
+}
+
+/**
+ * Probe result for one file of a batch probe.
+ */
+export interface VideoProbeResult {
+  file: string;
+  status: string; // 'OK' or the reason the file could not be probed.
+  fps?: number;
+  width?: number;
+  height?: number;
+  exact?: boolean; // False when the extent is estimated.
+  numFrames?: number;
+  firstTsMicro?: number; // UTC us of the first frame, 0 if unknown.
+  lastTsMicro?: number; // UTC us of the last frame, 0 if unknown.
+}
+
 /**
  * Represents a request for a specific video frame.
  * Only one of frameNum, seekPercent, or toTimestamp should be specified.
@@ -68,6 +135,13 @@ export type VideoFrameRequest = {
   interpMethod?: 'blend' | 'rife'; // Fractional-frame interpolation technique (optional, defaults to 'blend').
   crop?: Rect; // Region to interpolate when interpMethod is 'rife' (optional, falls back to zoom).
   prune?: { side: 'top' | 'bottom'; percentage: number }; // Crop before returning/saving.
+  sourceRect?: Rect; // Only return this region of the frame (optional, overrides prune).
+  outputSize?: { width: number; height: number }; // Scale sourceRect to this size (optional).
+  outputFormat?: 'rgba' | 'i420' | 'nv12'; // Planar output for full frames (optional, defaults to rgba).
+  scrub?: boolean; // Optional: return the nearest keyframe from the keyframe-only decoder.
+  maxWidth?: number; // Scale scrub previews down to at most this width (optional).
+  timeline?: string; // Open timeline id; frameNum/tsMilli then span all its segments and videoFile is ignored.
+  view?: string; // A newer request for the same view cancels this one, which then fails with 'Superseded' (optional).
   /** Renderer-only guard checked before committing a completed frame. */
   commitGuard?: () => boolean;
 };
@@ -3,6 +3,11 @@ import {
   BowDetectionRequest,
   BowDetectionResult,
   VideoFrameRequest,
+  VideoOpenResult,
+  VideoProbeResult,
+  VideoRefreshResult,
+  VideoTimeFrame,
+  VideoTimelineResult,
 } from 'renderer/shared/AppTypes';
 
 declare global {
@@ -10,9 +15,21 @@ declare global {
     VideoUtils: {
       // See ../../src/main/video/video-preload.ts for implementation
       setDebugLevel(debugLevel: number): Promise<{ status: string }>;
-      openFile(filePath: string): Promise<{ status: string }>;
+      openFile(filePath: string): Promise<VideoOpenResult>;
+      refreshFile(filePath: string): Promise<VideoRefreshResult>;
+      probeFiles(files: string[]): Promise<VideoProbeResult[]>;
+      openTimeline(
+        timeline: string,
+        files: string[],
+      ): Promise<VideoTimelineResult>;
+      closeTimeline(timeline: string): Promise<{ status: string }>;
       closeFile(filePath: string): Promise<{ status: string }>;
       getFrame(request: VideoFrameRequest): Promise<AppImage>;
+      getFramesAtTime(
+        files: string[],
+        tsMilli: number,
+        mode?: 'nearest' | 'bracket',
+      ): Promise<VideoTimeFrame[]>;
       detectBow(request: BowDetectionRequest): Promise<BowDetectionResult>;
       sendMulticast(
         msg: string,
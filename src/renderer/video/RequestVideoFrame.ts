@@ -45,6 +45,57 @@ export const setOpenFilename = (filename: string) => {
 
 // --- Helpers ---
 
+/**
+ * Records the extent of a newly opened file in its status and sidecar.
+ *
+ * @param videoFile - The filename of the opened video.
+ * @param videoFileStatus - The status entry for the file.
+ * @param firstImage - Frame 1 of the file.
+ * @param numFrames - The last readable frame number.
+ * @param lastImageTime - UTC microseconds of the last readable frame.
+ * @returns A promise resolving to the updated file status.
+ */
+async function updateOpenedFileStatus(
+  videoFile: string,
+  videoFileStatus: NonNullable<ReturnType<typeof getFileStatusByName>>,
+  firstImage: AppImage,
+  numFrames: number,
+  lastImageTime: number,
+) {
+  const tzOffset = videoFileStatus.tzOffset || -new Date().getTimezoneOffset();
+  const missingSidecarFile = !videoFileStatus.sidecar?.file;
+  const newVideoFileStatus = {
+    filename: videoFile,
+    open: true,
+    numFrames,
+    startTime: firstImage.tsMicro,
+    endTime: lastImageTime,
+    duration: lastImageTime - firstImage.tsMicro,
+    fps: firstImage.fps,
+    tzOffset,
+    sidecar: {
+      ...videoFileStatus.sidecar,
+      file: {
+        startTs: `${firstImage.tsMicro / 1000000}`,
+        stopTs: `${lastImageTime / 1000000}`,
+        numFrames,
+        fps: firstImage.fps,
+        tzOffset,
+      },
+    } as KeyMap,
+  };
+  console.log(JSON.stringify(newVideoFileStatus, null, 2));
+  updateFileStatus(newVideoFileStatus);
+
+  // Since we're opening the video file for viewing, ensure the sidecar has guides defined.
+  if (missingSidecarFile || !newVideoFileStatus.sidecar?.guides) {
+    // No guides, save current guide config. Saving will update the cached sidecar.
+    await saveVideoSidecar(videoFile);
+  }
+
+  return newVideoFileStatus;
+}
+
 /**
  * Ensures the specified video file is open and its status is up to date.
  *
@@ -96,6 +147,17 @@ async function ensureFileOpen(
   }
   openFilename = videoFile;
 
+  // The native open reports the extent when the file has a frame index.
+  if (openStatus.numFrames && openStatus.lastTsMicro) {
+    return updateOpenedFileStatus(
+      videoFile,
+      videoFileStatus,
+      firstImage,
+      openStatus.numFrames,
+      openStatus.lastTsMicro,
+    );
+  }
+
   let lastImage: AppImage | undefined;
   // On VFR files, r_frame_rate may undercount the last decodable frame by
   // up to ~1% of the total. Walk back up to 2% with a floor of 200.
@@ -152,38 +214,13 @@ async function ensureFileOpen(
         firstImage.tsMicro + (1000000 * firstImage.numFrames) / firstImage.fps,
       );
 
-  const tzOffset = videoFileStatus.tzOffset || -new Date().getTimezoneOffset();
-  const missingSidecarFile = !videoFileStatus.sidecar?.file;
-  const newVideoFileStatus = {
-    filename: videoFile,
-    open: true,
-    numFrames: firstImage.numFrames,
-    startTime: firstImage.tsMicro,
-    endTime: lastImageTime,
-    duration: lastImageTime - firstImage.tsMicro,
-    fps: firstImage.fps,
-    tzOffset,
-    sidecar: {
-      ...videoFileStatus.sidecar,
-      file: {
-        startTs: `${firstImage.tsMicro / 1000000}`,
-        stopTs: `${lastImageTime / 1000000}`,
-        numFrames: firstImage.numFrames,
-        fps: firstImage.fps,
-        tzOffset,
-      },
-    } as KeyMap,
-  };
-  console.log(JSON.stringify(newVideoFileStatus, null, 2));
-  updateFileStatus(newVideoFileStatus);
-
-  // Since we're opening the video file for viewing, ensure the sidecar has guides defined.
-  if (missingSidecarFile || !newVideoFileStatus.sidecar?.guides) {
-    // No guides, save current guide config. Saving will update the cached sidecar.
-    await saveVideoSidecar(videoFile);
-  }
-
-  return newVideoFileStatus;
+  return updateOpenedFileStatus(
+    videoFile,
+    videoFileStatus,
+    firstImage,
+    firstImage.numFrames,
+    lastImageTime,
+  );
 }
 
 /**
@@ -241,6 +278,12 @@ function calculateSeekFrame(
   return { seekPos: 1, utcMilli: 0 };
 }
 
+/** The view of the frames requestVideoFrame shows; see VideoFrameRequest.view. */
+const mainView = 'main';
+
+/** Error of a request replaced by a newer one for the same view. */
+const supersededError = 'Superseded';
+
 /**
  * Handles errors: logs, sets error state, and shows a test pattern.
  */
@@ -284,11 +327,17 @@ const doRequestVideoFrame = async (
     try {
       const { commitGuard: _commitGuard, ...nativeRequest } = request;
       image = await VideoUtils.getFrame({
+        // Saved frames are never dropped for a newer frame.
+        view: request.saveAs ? undefined : mainView,
         ...nativeRequest,
         frameNum: clampedSeekPos,
         tsMilli: utcMilli,
       });
     } catch (e) {
+      if (e instanceof Error && e.message === supersededError) {
+        // A newer request replaced this one and will show its frame.
+        return undefined;
+      }
       handleFrameError(request.videoFile, clampedSeekPos, e);
       return undefined;
     }
@@ -328,6 +377,10 @@ const doRequestVideoFrame = async (
 };
 
 let running = false;
+/** File of the request runQueue is processing. */
+let runningFile = '';
+/** Requests sent without waiting for the queue, see requestVideoFrame. */
+let overtaking = 0;
 let nextRequest: {
   params: VideoFrameRequest;
   resolve: (frame: AppImage | undefined) => void;
@@ -340,7 +393,7 @@ let nextRequest: {
  * @returns {boolean} True if the video request queue is running, otherwise false.
  */
 export const videoRequestQueueRunning = () => {
-  return running;
+  return running || overtaking > 0;
 };
 
 /**
@@ -354,6 +407,7 @@ async function runQueue() {
   while (nextRequest) {
     const { params, resolve, reject } = nextRequest;
     nextRequest = null;
+    runningFile = params.videoFile;
     try {
       // eslint-disable-next-line no-await-in-loop
       const frame = await doRequestVideoFrame(params);
@@ -381,6 +435,24 @@ export function requestVideoFrame(
     // If a request is already queued, resolve its promise
     if (nextRequest) {
       nextRequest.resolve(undefined);
+      nextRequest = null;
+    }
+    // While a frame of the open file decodes, a newer one is sent at once:
+    // the native side cancels the decode it replaces, whose request then
+    // resolves undefined.
+    if (
+      running &&
+      !params.saveAs &&
+      params.videoFile === runningFile &&
+      params.videoFile === openFilename
+    ) {
+      overtaking += 1;
+      doRequestVideoFrame(params)
+        .then(resolve, reject)
+        .finally(() => {
+          overtaking -= 1;
+        });
+      return;
     }
     nextRequest = { params, resolve, reject };
     runQueue();
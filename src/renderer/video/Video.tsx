@@ -365,7 +365,7 @@ interface MouseState {
 }
 
 let playIntervalTimer: NodeJS.Timeout | undefined;
-const playVideo = (dumpWhenFinished: boolean) => {
+const playVideo = (dumpWhenFinished: boolean, reverse = false) => {
   const history: [number, number][] = [];
   const dumpResults = () => {
     if (!dumpWhenFinished) {
@@ -389,14 +389,18 @@ const playVideo = (dumpWhenFinished: boolean) => {
       history.push([image.frameNum, delta]);
       lastImage = image;
     }
-    if (image.frameNum >= image.numFrames) {
+    if (reverse ? image.frameNum <= 1 : image.frameNum >= image.numFrames) {
       clearInterval(playIntervalTimer);
       playIntervalTimer = undefined;
       dumpResults();
     }
 
     if (!videoRequestQueueRunning()) {
-      moveRight();
+      if (reverse) {
+        moveLeft();
+      } else {
+        moveRight();
+      }
     }
   }, 10);
 };
@@ -416,6 +420,12 @@ window.addEventListener('keydown', (event: KeyboardEvent) => {
     case 'p':
       playVideo(false);
       break;
+    case 'R':
+      playVideo(true, true);
+      break;
+    case 'r':
+      playVideo(false, true);
+      break;
     case 'ArrowRight':
     case '>':
     case '.':
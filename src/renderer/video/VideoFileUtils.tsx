@@ -237,6 +237,7 @@ export const refreshDirList = async (videoDir: string) => {
       return; // no change
     }
     const fileStatusList: FileStatus[] = [];
+    const unprobed: FileStatus[] = [];
     for (const file of dirList) {
       let fileStatus = getFileStatusByName(file);
       if (fileStatus) {
@@ -256,11 +257,34 @@ export const refreshDirList = async (videoDir: string) => {
         };
 
         applyFileSidecar(fileStatus, videoSidecar);
+        if (!videoSidecar?.file) {
+          unprobed.push(fileStatus);
+        }
         updateFileStatus(fileStatus);
         fileStatusList.push(fileStatus);
       }
     }
 
+    // Files without a sidecar get their extent from one batch probe
+    // instead of being opened one at a time.
+    if (unprobed.length > 0) {
+      const probes = await VideoUtils.probeFiles(
+        unprobed.map((status) => status.filename),
+      ).catch(() => []);
+      probes.forEach((probe, i) => {
+        const fileStatus = unprobed[i];
+        if (probe.status !== 'OK' || !probe.numFrames || !probe.lastTsMicro) {
+          return;
+        }
+        fileStatus.numFrames = probe.numFrames;
+        fileStatus.startTime = probe.firstTsMicro || 0;
+        fileStatus.endTime = probe.lastTsMicro;
+        fileStatus.duration = fileStatus.endTime - fileStatus.startTime;
+        fileStatus.fps = probe.fps || fileStatus.fps;
+        updateFileStatus(fileStatus);
+      });
+    }
+
     setDirList(dirList);
     setFileStatusList(fileStatusList);
 
@@ -280,6 +304,28 @@ export const refreshDirList = async (videoDir: string) => {
   }
 };
 
+/**
+ * Extends the open file's status when it is still being recorded.
+ */
+export const refreshOpenFile = async () => {
+  const fileStatus = getFileStatusByName(getOpenFilename());
+  if (!fileStatus?.open) {
+    return;
+  }
+  const result = await VideoUtils.refreshFile(fileStatus.filename).catch(
+    () => undefined,
+  );
+  if (!result?.grown || !result.numFrames || !result.lastTsMicro) {
+    return;
+  }
+  updateFileStatus({
+    ...fileStatus,
+    numFrames: result.numFrames,
+    endTime: result.lastTsMicro,
+    duration: result.lastTsMicro - fileStatus.startTime,
+  });
+};
+
 /**
  * The component that monitors the video directory for changes.
  */
@@ -302,6 +348,7 @@ const FileMonitor: React.FC = () => {
     const timer = setInterval(() => {
       if (videoDir) {
         refreshDirList(videoDir);
+        refreshOpenFile();
       }
     }, delay);
     return () => clearInterval(timer);